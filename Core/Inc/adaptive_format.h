@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ * @file    adaptive_format.h
+ * @brief   Adaptive frame encoding driven by USB backlog (ADAPT)
+ ******************************************************************************
+ * @attention
+ *
+ * With ADAPT:ON the streamed frames step to a more compact encoding when
+ * USB falls behind and back when it recovers:
+ *
+ *     12 bits (FRME, 7402 B)  ->  10 bits (FRMX, 4638 B)  ->  8 bits (FRMX, 3712 B)
+ *
+ * A 12-bit readout is sent with the low bits dropped; at ADC_BITS 10/8 the
+ * ADC resolution is the upper limit. Every frame carries its format (FRME,
+ * or FRMX with its bits field), so host decoding needs no extra state.
+ *
+ * The metrics are the ones the stream already has: whether the frame made
+ * it into the transfer queue (a miss is a dropped frame) and the queue
+ * space left by earlier readouts, sampled before this readout's MARK and
+ * band packets are queued (those are small and drain within the readout,
+ * so counting them would step down on a healthy link). A drop steps down
+ * at once; a window of ADAPT_WINDOW frames that mostly found earlier data
+ * still waiting steps down too.
+ * ADAPT_RECOVER_WINDOWS windows in a row without drops or backlog step back
+ * up one level. If the link falls behind again within that many windows of
+ * a step up, the recovery wait doubles (up to ADAPT_RECOVER_MAX_WINDOWS), so
+ * a link that only just fails at the fuller encoding does not oscillate.
+ *
+ ******************************************************************************
+ */
+
+#ifndef ADAPTIVE_FORMAT_H
+#define ADAPTIVE_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Controller tuning */
+#define ADAPT_WINDOW            16      // Streamed frames per evaluation
+#define ADAPT_BUSY_SPACE        2       // Queue space at or below this before a readout is backlog
+#define ADAPT_RECOVER_WINDOWS   8       // Clean windows before stepping back up
+#define ADAPT_RECOVER_MAX_WINDOWS 128   // Backoff limit for the recovery wait
+
+/**
+ * @brief Enable / disable adaptive encoding
+ * @note Enabling starts at the full resolution
+ */
+void adaptive_format_set_enabled(bool enabled);
+
+/**
+ * @brief Check whether adaptive encoding is on
+ */
+bool adaptive_format_is_enabled(void);
+
+/**
+ * @brief Resolution limit for the next streamed frame
+ * @return 12, 10 or 8 (12 when adaptive encoding is off)
+ */
+uint8_t adaptive_format_get_bits(void);
+
+/**
+ * @brief Account for a streamed frame (ADC callback, after queueing it)
+ * @param sent Frame was queued (false: dropped)
+ * @param queue_space Free transfer queue entries before the readout queued anything
+ */
+void adaptive_format_on_submit(bool sent, uint8_t queue_space);
+
+/**
+ * @brief Steps to a more compact / back to a fuller encoding since startup
+ */
+uint32_t adaptive_format_get_steps_down(void);
+uint32_t adaptive_format_get_steps_up(void);
+
+#endif /* ADAPTIVE_FORMAT_H */
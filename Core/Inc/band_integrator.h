@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file    band_integrator.h
+ * @brief   Spectral band integrator: per-readout band sums and centroids as
+ *          compact telemetry packets
+ ******************************************************************************
+ * @attention
+ *
+ * Up to CCD_MAX_BANDS pixel bands are summed by the data layer while the
+ * readout is copied. While acquiring, every readout then produces one packet
+ * (little-endian):
+ *
+ *     "BAND" | seq u16 | band_count u8 | bits u8 |
+ *     band_count x { sum u32 | centroid u32 } | crc16
+ *
+ * seq is the readout's frame counter, bits the ADC resolution of a reduced
+ * resolution readout (0 = 12 bits). Light is low counts on this board, so a
+ * sum is over (full_scale - value) with full_scale = 2^bits - 1, and the
+ * centroid is the light-weighted pixel position in 1/256 pixel (0xFFFFFFFF
+ * if the band sum is zero). crc16
+ * is CRC16-CCITT over the preceding bytes. Full FRME frames are sent every
+ * Nth readout only (N = 0: never).
+ *
+ ******************************************************************************
+ */
+
+#ifndef BAND_INTEGRATOR_H
+#define BAND_INTEGRATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ccd_data_layer.h"
+
+/* Packet layout */
+#define BAND_HEADER_SIZE       8       // marker(4) + seq(2) + band_count(1) + bits(1)
+#define BAND_ENTRY_SIZE        8       // sum(4) + centroid(4)
+#define BAND_CRC_SIZE          2
+#define BAND_PACKET_SIZE(n)    (BAND_HEADER_SIZE + (n) * BAND_ENTRY_SIZE + BAND_CRC_SIZE)
+#define BAND_CENTROID_NONE     0xFFFFFFFFUL
+
+/* Status codes */
+typedef enum {
+    BAND_OK = 0,
+    BAND_ERROR_RANGE,           // Band empty or past the last pixel
+    BAND_ERROR_ORDER,           // Bands overlap or are not ascending
+    BAND_ERROR_COUNT            // More than CCD_MAX_BANDS bands
+} Band_Status_t;
+
+/**
+ * @brief Enable band telemetry with a new band set
+ * @param bands Bands in ascending, non-overlapping order
+ * @param count Number of bands (1..CCD_MAX_BANDS)
+ * @return BAND_OK, or why the set was rejected
+ */
+Band_Status_t band_integrator_configure(const CCD_Band_t* bands, uint8_t count);
+
+/**
+ * @brief Disable band telemetry; full frames are sent for every readout again
+ */
+void band_integrator_disable(void);
+
+/**
+ * @brief Number of active bands (0 when disabled)
+ */
+uint8_t band_integrator_get_count(void);
+
+/**
+ * @brief Send a full frame only every Nth readout while bands are active
+ * @param divider 0 = bands only, 1 = every readout, N = every Nth readout
+ */
+void band_integrator_set_frame_divider(uint16_t divider);
+
+/**
+ * @brief Current full-frame divider
+ */
+uint16_t band_integrator_get_frame_divider(void);
+
+/**
+ * @brief Transfers the readout's data will take in the queue (ADC callback,
+ *        before band_integrator_on_readout)
+ * @return 1 without bands (the frame), else band packet + full frame if due
+ */
+uint8_t band_integrator_entries_due(void);
+
+/**
+ * @brief Queue the band packet for a processed readout (ADC callback)
+ * @param frame Frame that was just processed
+ * @return true if the full frame should be sent as well
+ */
+bool band_integrator_on_readout(const CCD_Frame_t* frame);
+
+/**
+ * @brief Band packets that could not be queued since startup
+ */
+uint32_t band_integrator_get_dropped_count(void);
+
+#endif /* BAND_INTEGRATOR_H */
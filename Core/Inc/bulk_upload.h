@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ * @file    bulk_upload.h
+ * @brief   Chunked binary upload channel (calibration tables, defect maps,
+ *          acquisition programs)
+ ******************************************************************************
+ * @attention
+ *
+ * An upload is opened with the ASCII command
+ *
+ *     UPLOAD:<type>,<size>,<RAM|FLASH>      type = CAL, DEFECT or SEQ
+ *
+ * after which the RX stream is binary until the closing chunk. Each chunk is
+ *
+ *     "UPCK" | offset u32 | length u16 | crc16 u16 | payload[length]
+ *
+ * (little-endian, crc16 = CRC16-CCITT of the payload, same as the frames).
+ * Chunks must arrive in order; every chunk is answered with
+ *
+ *     UPLOAD_ACK:<offset>,<received>,<size>
+ *     UPLOAD_NAK:<offset>,<CRC|ORDER|RANGE|LENGTH>,<expected_offset>
+ *
+ * so the host can keep several chunks in flight and go back to
+ * expected_offset on a NAK. A flash programming failure cannot be retried
+ * (the area is partly written): it ends the session with
+ * ERROR:UPLOAD_FLASH:<offset> and the host starts a new upload. A chunk with length 0 closes the upload; its
+ * crc16 field carries the CRC of the whole image, which is verified against
+ * the stored copy before the image is committed.
+ *
+ * RAM images live in a small static buffer (lost on reset). FLASH images are
+ * programmed chunk-by-chunk into an append-only log in the last flash sector
+ * and survive resets; UPLOAD_ERASE wipes the log.
+ *
+ ******************************************************************************
+ */
+
+#ifndef BULK_UPLOAD_H
+#define BULK_UPLOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Upload configuration */
+#define UPLOAD_MAX_CHUNK          512     // Largest chunk payload
+#define UPLOAD_RAM_SIZE           2048    // RAM target capacity (SEQ programs, defect maps)
+#define UPLOAD_TIMEOUT_MS         2000    // Idle time before a binary upload is abandoned
+#define UPLOAD_CHUNK_HEADER_SIZE  12
+
+/* Flash store: sector 5 of the STM32F401CC (last 128 KB of flash) */
+#define UPLOAD_FLASH_SECTOR       FLASH_SECTOR_5
+#define UPLOAD_FLASH_BASE         0x08020000U
+#define UPLOAD_FLASH_SIZE         (128U * 1024U)
+
+/* Image types */
+typedef enum {
+    UPLOAD_TYPE_CAL = 1,        // Per-pixel calibration table
+    UPLOAD_TYPE_DEFECT = 2,     // Defect pixel map
+    UPLOAD_TYPE_SEQ = 3         // Acquisition sequence program
+} Upload_Type_t;
+
+/* Image destinations */
+typedef enum {
+    UPLOAD_TARGET_RAM = 0,
+    UPLOAD_TARGET_FLASH = 1
+} Upload_Target_t;
+
+/* Status codes */
+typedef enum {
+    UPLOAD_OK = 0,
+    UPLOAD_ERROR_BUSY = 1,
+    UPLOAD_ERROR_INVALID_PARAM = 2,
+    UPLOAD_ERROR_NO_SPACE = 3,
+    UPLOAD_ERROR_FLASH = 4
+} Upload_Status_t;
+
+/* A committed image */
+typedef struct {
+    Upload_Type_t   type;
+    Upload_Target_t target;
+    uint32_t        size;
+    uint16_t        crc;
+    const uint8_t  *data;       // Points into the RAM buffer or memory-mapped flash
+} bulk_upload_image_t;
+
+/**
+ * @brief Initialize the upload channel
+ */
+void bulk_upload_init(void);
+
+/**
+ * @brief Open an upload session; the RX stream becomes binary
+ * @param type Image type
+ * @param size Image size in bytes
+ * @param target RAM or FLASH
+ * @return UPLOAD_OK if the session is open
+ */
+Upload_Status_t bulk_upload_begin(Upload_Type_t type, uint32_t size, Upload_Target_t target);
+
+/**
+ * @brief Check whether a binary upload owns the RX stream
+ */
+bool bulk_upload_is_active(void);
+
+/**
+ * @brief Consume upload chunks from the USB RX buffer (call from main loop)
+ */
+void bulk_upload_process(void);
+
+/**
+ * @brief Find the newest committed image of a type (RAM first, then flash)
+ * @param type Image type
+ * @param image Filled in when found
+ * @return true if an image was found
+ */
+bool bulk_upload_find(Upload_Type_t type, bulk_upload_image_t *image);
+
+/**
+ * @brief Erase the flash image store
+ * @return UPLOAD_OK on success
+ * @note Blocks for the sector erase time (~1-2 s)
+ */
+Upload_Status_t bulk_upload_erase_flash(void);
+
+/**
+ * @brief Check whether the flash store is clear of the firmware image
+ * @return false if the firmware reaches UPLOAD_FLASH_BASE: FLASH uploads,
+ *         UPLOAD_ERASE and flash lookups are then refused
+ */
+bool bulk_upload_flash_usable(void);
+
+/**
+ * @brief Bytes still free in the flash image store
+ */
+uint32_t bulk_upload_flash_free(void);
+
+/**
+ * @brief Image type as used in the UPLOAD command ("CAL", "DEFECT", "SEQ")
+ */
+const char* bulk_upload_type_name(Upload_Type_t type);
+
+#endif /* BULK_UPLOAD_H */
@@ -62,6 +62,56 @@ typedef struct __attribute__((packed)) {
 #define FRAME_FOOTER_SIZE    6      // end_marker(4) + checksum(2)
 #define FRAME_TOTAL_SIZE     (FRAME_HEADER_SIZE + FRAME_PIXEL_SIZE + FRAME_FOOTER_SIZE)  // 7402 bytes
 
+/* 12-bit packed pixels: two pixels in three bytes (odd counts padded) */
+#define CCD_PACKED12_SIZE(n) ((((n) + 1U) / 2U) * 3U)
+
+/* 10-bit packed pixels: four pixels in five bytes (padded to a multiple of 4) */
+#define CCD_PACKED10_SIZE(n) ((((n) + 3U) / 4U) * 5U)
+
+/**
+ * Reduced-resolution frame (ADC at 10 or 8 bits), sent instead of FRME:
+ * - 4 bytes: "FRMX"
+ * - 2 bytes: frame_counter   (same offset as in FRME)
+ * - 2 bytes: pixel_count     (same offset as in FRME)
+ * - 1 byte:  bits            (10 or 8)
+ * - 1 byte:  flags           (bit 0: settling readout, see settle.h)
+ * - 2 bytes: payload_size    (bytes of pixel data that follow)
+ * - pixel data: 8-bit = one byte per pixel,
+ *               10-bit = CCD_PACKED10_SIZE (LSB-first bit stream, p0 in
+ *               byte0 and the low two bits of byte1, ...)
+ * - 4 bytes: "ENDF"
+ * - 2 bytes: CRC16-CCITT over all preceding bytes
+ *
+ * 8-bit frames are 3712 bytes, 10-bit frames 4638 (FRME: 7402).
+ * The frame is built in place in the CCD_Frame_t buffer.
+ */
+#define FRAMEX_HEADER_SIZE   12
+#define FRAMEX_TOTAL_SIZE(payload) (FRAMEX_HEADER_SIZE + (payload) + FRAME_FOOTER_SIZE)
+#define CCD_FRAME_FLAG_SETTLING    0x01
+
+/* Pixel bands integrated while the readout is copied */
+#define CCD_MAX_BANDS        8
+
+typedef struct {
+    uint16_t start;                      // First pixel
+    uint16_t length;                     // Pixels in the band
+} CCD_Band_t;
+
+typedef struct {
+    uint16_t start;                      // First pixel of the band
+    uint32_t sum;                        // Sum of (full_scale - value): light, not counts
+    uint64_t moment;                     // Sum of (pixel - start) * (full_scale - value)
+} CCD_Band_Sum_t;
+
+/* Readout timing in CPU cycles */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t last;
+    uint64_t sum;
+} CCD_Cycle_Stats_t;
+
 /* Function Prototypes */
 
 /**
@@ -94,6 +144,121 @@ CCD_Frame_Status_t ccd_data_layer_validate_frame(const CCD_Frame_t* frame);
  */
 uint16_t ccd_data_layer_calculate_crc16(const uint8_t* data, uint32_t length);
 
+/**
+ * @brief Select the pixel resolution the frames are encoded for
+ * @param bits 12 (FRME, default), 10 or 8 (FRMX)
+ * @return false if bits is not supported
+ * @note Only the encoding; the ADC resolution is set by the caller. Picked up
+ *       at the start of the next readout.
+ */
+bool ccd_data_layer_set_resolution(uint8_t bits);
+
+/**
+ * @brief Resolution frames are encoded for
+ */
+uint8_t ccd_data_layer_get_resolution(void);
+
+/**
+ * @brief Resolution of the most recently processed readout
+ * @note For packets built from that readout (bands, pre-trigger)
+ */
+uint8_t ccd_data_layer_get_frame_bits(void);
+
+/**
+ * @brief Limit the resolution the next readout is encoded at (ADC callback,
+ *        before ccd_data_layer_process_readout)
+ * @param bits 12 (no limit), 10 or 8; a 12-bit readout limited to 10/8 bits
+ *        is sent as an FRMX frame with the low bits dropped
+ */
+void ccd_data_layer_set_encode_limit(uint8_t bits);
+
+/**
+ * @brief Resolution the most recent readout was encoded at
+ * @note The BITS of the frame as sent; packets built from the 16-bit pixels
+ *       use ccd_data_layer_get_frame_bits()
+ */
+uint8_t ccd_data_layer_get_encoded_bits(void);
+
+/**
+ * @brief Set the flags of the readout being processed (ADC callback)
+ * @param flags CCD_FRAME_FLAG_* bits, carried by FRMX frames and packets
+ *        built from the readout
+ */
+void ccd_data_layer_set_frame_flags(uint8_t flags);
+
+/**
+ * @brief Flags of the most recently processed readout
+ */
+uint8_t ccd_data_layer_get_frame_flags(void);
+
+/**
+ * @brief Finish a processed frame for transmission
+ * @param frame Frame from ccd_data_layer_process_readout()
+ * @return Bytes to send from the start of the frame
+ *
+ * At 12 bits the frame already is a complete FRME frame. At 10/8 bits the
+ * pixels are compacted in place into an FRMX frame, so anything that needs
+ * the 16-bit pixels (pre-trigger capture) must run before this.
+ */
+uint16_t ccd_data_layer_encode_frame(CCD_Frame_t* frame);
+
+/**
+ * @brief Encode a processed frame at a given resolution
+ * @param frame Frame with 16-bit pixels (FRME layout)
+ * @param bits 12, 10 or 8
+ * @param shift Low bits dropped from each pixel (0 if the pixels already fit)
+ * @param flags FRMX flags byte (ignored for FRME)
+ * @return Bytes to send from the start of the frame
+ * @note ccd_data_layer_encode_frame() with the readout's encoding and
+ *       flags; used directly by the kernel benchmark
+ */
+uint16_t ccd_data_layer_encode_frame_bits(CCD_Frame_t* frame, uint8_t bits, uint8_t shift,
+                                          uint8_t flags);
+
+/**
+ * @brief Copy one readout's pixels and integrate bands (the readout copy loop)
+ * @param adc_buffer Raw ADC samples
+ * @param pixels Destination, CCD_PIXEL_COUNT pixels
+ * @param bands Bands in ascending, non-overlapping order
+ * @param count Number of bands (0: plain copy)
+ * @param full_scale Largest ADC count at the current resolution; light is low
+ *        counts on this board, so bands integrate full_scale - value
+ * @param sums Receives one sum per band
+ */
+void ccd_data_layer_copy_pixels(const volatile uint16_t* adc_buffer, uint16_t* pixels,
+                                const CCD_Band_t* bands, uint8_t count,
+                                uint16_t full_scale, CCD_Band_Sum_t* sums);
+
+/**
+ * @brief Pack 12-bit pixels two-per-three-bytes
+ * @param pixels Source pixels (12-bit values in 16-bit containers)
+ * @param count Number of pixels
+ * @param packed Destination, CCD_PACKED12_SIZE(count) bytes
+ *
+ * Layout per pixel pair (p0, p1):
+ *   byte0 = p0[7:0], byte1 = p0[11:8] | p1[3:0] << 4, byte2 = p1[11:4]
+ */
+void ccd_data_layer_pack12(const uint16_t* pixels, uint32_t count, uint8_t* packed);
+
+/**
+ * @brief Set the bands integrated during the copy loop
+ * @param bands Bands in ascending, non-overlapping order (validated by caller)
+ * @param count Number of bands (0 disables integration)
+ * @return Generation of the new set, reported with the sums once applied
+ *
+ * Safe to call while readouts are running: the new set is picked up at the
+ * start of the next readout.
+ */
+uint32_t ccd_data_layer_set_bands(const CCD_Band_t* bands, uint8_t count);
+
+/**
+ * @brief Band sums of the most recent readout
+ * @param count Receives the number of bands integrated
+ * @param generation Receives the generation of the band set they belong to
+ * @return Per-band sums, valid until the next readout
+ */
+const CCD_Band_Sum_t* ccd_data_layer_get_band_sums(uint8_t* count, uint32_t* generation);
+
 /**
  * @brief Get the current frame counter value
  * @return Current frame counter
@@ -105,4 +270,33 @@ uint16_t ccd_data_layer_get_frame_count(void);
  */
 void ccd_data_layer_reset_counter(void);
 
+/**
+ * @brief Count a readout that could not be delivered (no free frame buffer
+ *        or USB queue full)
+ */
+void ccd_data_layer_count_dropped(void);
+
+/**
+ * @brief Get the number of dropped readouts since startup
+ */
+uint32_t ccd_data_layer_get_dropped_count(void);
+
+/**
+ * @brief Record the cycles one readout took in the ADC callback
+ * @param cycles DWT cycles from callback entry to the DMA restart
+ * @note Called from the ADC callback only
+ */
+void ccd_data_layer_record_cycles(uint32_t cycles);
+
+/**
+ * @brief Get the readout timing statistics
+ * @param stats Receives a consistent copy
+ */
+void ccd_data_layer_get_cycle_stats(CCD_Cycle_Stats_t* stats);
+
+/**
+ * @brief Clear the readout timing statistics
+ */
+void ccd_data_layer_reset_cycle_stats(void);
+
 #endif /* CCD_DATA_LAYER_H */
@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ * @file    clock_profile.h
+ * @brief   Selectable CCD master clock (fM) profiles
+ ******************************************************************************
+ * @attention
+ *
+ * One pixel is shifted out every 4 fM periods, so fM sets the readout time.
+ * A profile sets everything that depends on it together:
+ *
+ *   Profile   fM      ADC trigger  ICG period (min)  Readout (3694 px)
+ *   2MHZ      2 MHz   500 kHz      7.5 ms            7.39 ms   (default, as before)
+ *   4MHZ      4 MHz   1 MHz        3.75 ms           3.69 ms
+ *
+ * TIM3 (fM) and TIM4 (ADC trigger) are scaled by the same factor so the
+ * sample point keeps its place in the pixel period. The ICG period (TIM2)
+ * must be a whole number of SH periods (TIM5, set by SET_INT_TIME), so it is
+ * derived from both: the shortest multiple of the SH period that is at
+ * least the profile minimum (4MHZ at 20 us: 188 x 1680 = 315840 counts).
+ * Every change of either goes through the same stop / program / restart
+ * sequence so ICG and SH keep the boot phase. The ICG pulse width, the
+ * ICG-SH delay and the SH pulse width are in absolute time and stay.
+ *
+ * The ADC runs at PCLK2/4 = 21 MHz (the F401 limit is 36 MHz, so /2 is not
+ * possible). A 12-bit conversion takes sampling time + 12 ADC clocks, so at
+ * 1 MHz (21 clocks per pixel) the 3-cycle sampling time is the longest that
+ * fits; the 2 MHz profile keeps the same setting as before.
+ *
+ ******************************************************************************
+ */
+
+#ifndef CLOCK_PROFILE_H
+#define CLOCK_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Master clock profiles */
+typedef enum {
+    CLOCK_PROFILE_2MHZ = 0,     // fM = 2 MHz (CubeMX configuration)
+    CLOCK_PROFILE_4MHZ = 1,     // fM = 4 MHz
+    CLOCK_PROFILE_COUNT
+} Clock_Profile_t;
+
+/* Timer and ADC settings of one profile (timer counts at 84 MHz) */
+typedef struct {
+    const char* name;
+    uint32_t fm_hz;
+    uint32_t fm_period;         // TIM3 ARR + 1
+    uint32_t adc_period;        // TIM4 ARR + 1 (= 4 fM periods)
+    uint32_t adc_pulse;         // TIM4 CCR4 + 1 (sample point in the pixel)
+    uint32_t icg_min_period;    // Lower bound for TIM2 ARR + 1 (readout + margin)
+    uint32_t adc_sampling_time; // ADC_SAMPLETIME_xCYCLES
+    uint32_t readout_us;        // Time to shift out CCD_PIXEL_COUNT pixels
+} Clock_Profile_Config_t;
+
+/**
+ * @brief Switch to another master clock profile
+ * @param profile CLOCK_PROFILE_xxx
+ * @return false if the profile is unknown
+ * @note The readout in progress during the switch is mixed-clock and should
+ *       be discarded; the timers restart in the same order as at boot
+ */
+bool clock_profile_set(Clock_Profile_t profile);
+
+/**
+ * @brief Set the integration time (SH period) and re-derive the ICG period
+ * @param microseconds SH period; range checked by the caller
+ * @return false if the period does not exceed the SH pulse
+ * @note Same restart as clock_profile_set(); the readout in progress is mixed
+ */
+bool clock_profile_set_integration_us(uint32_t microseconds);
+
+/**
+ * @brief ICG period in use (whole SH periods), in microseconds
+ */
+uint32_t clock_profile_get_icg_us(void);
+
+/**
+ * @brief Profile in use
+ */
+Clock_Profile_t clock_profile_get(void);
+
+/**
+ * @brief Settings of the profile in use
+ */
+const Clock_Profile_Config_t* clock_profile_get_config(void);
+
+/**
+ * @brief Look up a profile by name ("2MHZ", "4MHZ")
+ * @return true if found
+ */
+bool clock_profile_from_name(const char* name, Clock_Profile_t* profile);
+
+#endif /* CLOCK_PROFILE_H */
@@ -21,7 +21,8 @@
 #include <stdbool.h>
 
 /* Command buffer size */
-#define CMD_BUFFER_SIZE  64
+#define CMD_BUFFER_SIZE  128
+#define FMT_BENCH_RUNS   32      // Iterations per formatter timing
 
 /* Command status codes */
 typedef enum {
@@ -91,9 +92,173 @@ void command_handle_stop(void);
  */
 Command_Status_t command_handle_set_integration_time(uint32_t microseconds);
 
+/**
+ * @brief Select the CCD master clock profile (fM, ADC trigger, ICG period)
+ * @param name Profile name: "2MHZ" or "4MHZ"
+ * @return CMD_OK, CMD_ERROR_BUSY while acquiring, CMD_ERROR_INVALID_PARAM
+ * @note Replies OK:CLOCK:<name>,FM_HZ:n,READOUT_US:n
+ */
+Command_Status_t command_handle_clock(const char* name);
+
+/**
+ * @brief Select the ADC resolution and frame encoding
+ * @param bits 12 (FRME frames), 10 or 8 (compact FRMX frames)
+ * @return CMD_OK, CMD_ERROR_BUSY while acquiring, CMD_ERROR_INVALID_PARAM
+ * @note Replies OK:ADC_BITS:n,FRAME_BYTES:n
+ */
+Command_Status_t command_handle_adc_bits(uint32_t bits);
+
+/**
+ * @brief Configure settling readout handling (SETTLE:<n>[,DROP|FLAG])
+ * @param params "<n>[,DROP|FLAG]", n = 0..SETTLE_MAX_FRAMES readouts per
+ *        configuration change; the mode is kept if omitted
+ * @return CMD_OK, or CMD_ERROR_INVALID_PARAM (reply left to the caller)
+ */
+Command_Status_t command_handle_settle(const char* params);
+
+/**
+ * @brief Tag the stream at the next frame boundary (MARK:<id> / MARK:CANCEL)
+ * @param params Decimal id (u32), or "CANCEL"
+ * @return CMD_OK, CMD_ERROR_INVALID_PARAM, or CMD_ERROR_BUSY while the
+ *         previous mark has not been sent
+ */
+Command_Status_t command_handle_mark(const char* params);
+
+/**
+ * @brief Replace the readout data with a test pattern
+ * @param params "<name>[,<value>]": OFF, RAMP, CONST, PRBS or COUNTER
+ *        (case-insensitive); value is the CONST pixel value
+ * @return CMD_OK or CMD_ERROR_INVALID_PARAM
+ * @note Replies OK:PATTERN:<NAME>[,VALUE:n]
+ */
+Command_Status_t command_handle_pattern(const char* params);
+
 /**
  * @brief Send status information back to host
  */
 void command_handle_get_status(void);
 
+/**
+ * @brief Send transport statistics (byte counts, overflows, RX pauses)
+ */
+void command_handle_get_stats(void);
+
+/**
+ * @brief Start a device-side USB bulk IN throughput test
+ * @param total_bytes Number of test bytes to stream
+ * @param chunk Bytes per CDC transfer
+ * @return CMD_OK if started, error code otherwise
+ * @note Result is reported as a "USB_TPUT:..." line when the test finishes
+ */
+Command_Status_t command_handle_usb_throughput(uint32_t total_bytes, uint32_t chunk);
+
+/**
+ * @brief Start a bulk OUT loopback or sink test (see link_test.h)
+ * @param mode LINK_TEST_LOOPBACK or LINK_TEST_SINK
+ * @param bytes Number of bytes the host will send
+ * @return CMD_OK if started, error code otherwise
+ * @note The RX stream belongs to the test until the result line is sent
+ */
+Command_Status_t command_handle_link_test(uint8_t mode, uint32_t bytes);
+
+/**
+ * @brief Select an OTG FIFO profile and re-enumerate the device
+ * @param profile USBD_FIFO_PROFILE_xxx (0=DEFAULT, 1=BULK_IN, 2=BALANCED)
+ * @return CMD_OK if accepted, error code otherwise
+ */
+Command_Status_t command_handle_usb_profile(uint32_t profile);
+
+/**
+ * @brief Open a chunked binary upload (see bulk_upload.h for the chunk format)
+ * @param params "<type>,<size>[,RAM|FLASH]" - type is CAL, DEFECT or SEQ
+ * @return CMD_OK if the RX stream switched to binary upload mode
+ */
+Command_Status_t command_handle_upload(const char* params);
+
+/**
+ * @brief Report the newest committed image of a type
+ * @param type_name CAL, DEFECT or SEQ
+ */
+void command_handle_upload_info(const char* type_name);
+
+/**
+ * @brief Erase the flash image store
+ * @return CMD_OK on success
+ */
+Command_Status_t command_handle_upload_erase(void);
+
+/**
+ * @brief Arm the pre-trigger ring
+ * @param pre Readouts to keep from before the trigger
+ * @param post Readouts to capture from the trigger on (at least 1)
+ * @param roi_start First pixel stored per readout
+ * @param roi_length Pixels stored per readout
+ * @return CMD_OK if armed, error code if acquiring or the ring is too small
+ */
+Command_Status_t command_handle_pretrig(uint32_t pre, uint32_t post,
+                                        uint32_t roi_start, uint32_t roi_length);
+
+/**
+ * @brief Software trigger for the pre-trigger ring
+ * @return CMD_OK if the ring was armed
+ */
+Command_Status_t command_handle_trigger(void);
+
+/**
+ * @brief Request a single-shot frame (SNAP info line + frame)
+ * @param wait_for_edge false: trigger now; true: trigger on the next
+ *        trigger input edge (replies OK:SNAP_ARMED)
+ * @return CMD_OK if accepted, CMD_ERROR_BUSY if a SNAP is outstanding
+ */
+Command_Status_t command_handle_snap(bool wait_for_edge);
+
+/**
+ * @brief Send the most recent complete frame now (GETFRAME info line + frame)
+ * @return CMD_OK if queued, CMD_ERROR_BUSY while streaming, before the first
+ *         readout or while the previous reply is still queued
+ */
+Command_Status_t command_handle_getframe(void);
+
+/**
+ * @brief Configure the band integrator
+ * @param params "s0,n0[,s1,n1...]" - start and length of each band, ascending
+ * @return CMD_OK if the bands were accepted, CMD_ERROR_INVALID_PARAM otherwise
+ */
+Command_Status_t command_handle_bands(const char* params);
+
+/**
+ * @brief Set how often full frames are sent while bands are active
+ * @param divider 0 = band packets only, N = every Nth readout
+ * @return CMD_OK
+ */
+Command_Status_t command_handle_band_frames(uint32_t divider);
+
+/**
+ * @brief Time the response formatter on a worst-case line
+ *
+ * Replies FMT_BENCH:LEN:n,RESP_MIN:c,RESP_MAX:c,RUNS:n (CPU cycles). Built
+ * with RESP_FORMAT_BENCH_SNPRINTF defined, the same line is also timed with
+ * snprintf (SNPRINTF_MIN/SNPRINTF_MAX).
+ */
+void command_handle_fmt_bench(void);
+
+/**
+ * @brief Benchmark the readout kernels on full-size buffers
+ *
+ * Replies BENCH:RUNS:n,MHZ:m,ART:ON|OFF,HOTPATH:RAM|FLASH, then for each of
+ * COPY, BANDS, CRC16, PACK12, PACK10, PACK8 the minimum and maximum CPU
+ * cycles per call (<NAME>:c,<NAME>_MAX:c). Streaming must be stopped.
+ * @return CMD_OK, or CMD_ERROR_BUSY while streaming / with the ring armed
+ */
+Command_Status_t command_handle_bench(void);
+
+/**
+ * @brief Report the cycles spent per readout in the ADC callback
+ *
+ * Replies PERF:FRAMES:n,CYC_MIN:c,CYC_MAX:c,CYC_AVG:c,CYC_LAST:c,US_AVG:u,
+ * US_MAX:u,ART:ON|OFF,HOTPATH:RAM|FLASH. Only readouts that were copied and
+ * checksummed are timed. ART:ON/OFF and PERF_RESET clear the figures.
+ */
+void command_handle_perf(void);
+
 #endif /* COMMAND_LAYER_H */
@@ -0,0 +1,43 @@
+/**
+ ******************************************************************************
+ * @file    cycle_counter.h
+ * @brief   DWT cycle counter helpers for on-target timing measurements
+ ******************************************************************************
+ * @attention
+ *
+ * The Cortex-M4 DWT unit provides a free-running 32-bit counter clocked at
+ * HCLK (84 MHz here). It wraps every ~51 s, so it is only used to measure
+ * short intervals (unsigned subtraction handles a single wrap correctly).
+ *
+ ******************************************************************************
+ */
+
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+#include "main.h"
+
+/**
+ * @brief Enable the DWT cycle counter
+ * @note Call once during startup, after HAL_Init()
+ */
+void cycle_counter_init(void);
+
+/**
+ * @brief Convert a cycle count to microseconds at the current HCLK
+ * @param cycles Number of CPU cycles
+ * @return Duration in microseconds
+ */
+uint32_t cycle_counter_to_us(uint32_t cycles);
+
+/**
+ * @brief Read the current cycle count
+ * @return Raw DWT->CYCCNT value
+ */
+static inline uint32_t cycle_counter_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif /* CYCLE_COUNTER_H */
@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @file    hotpath.h
+ * @brief   Placement of the acquisition hot path and ART accelerator control
+ ******************************************************************************
+ * @attention
+ *
+ * HOTPATH_FUNC puts a function in the .RamFunc section, which the CubeIDE
+ * linker script copies to SRAM with .data at startup. HOTPATH_CONST drops
+ * the const of lookup tables used by those functions so they land in .data
+ * as well, away from flash wait states.
+ *
+ * Build with -DCCD_HOTPATH_IN_FLASH to keep everything in flash, e.g. to
+ * compare cycles per readout (PERF) against the RAM build.
+ *
+ * Code in SRAM is fetched over the S-bus, which it shares with data
+ * accesses and the ADC DMA; flash code with ART cache hits runs at zero
+ * wait states over the I-bus. What RAM placement buys is a readout time
+ * that no longer depends on cache hits - measure both with PERF.
+ *
+ ******************************************************************************
+ */
+
+#ifndef HOTPATH_H
+#define HOTPATH_H
+
+#include <stdbool.h>
+#include "main.h"
+
+#ifndef CCD_HOTPATH_IN_FLASH
+#define HOTPATH_FUNC        __attribute__((section(".RamFunc"), noinline))
+#define HOTPATH_CONST
+#define HOTPATH_LOCATION    "RAM"
+#else
+#define HOTPATH_FUNC
+#define HOTPATH_CONST       const
+#define HOTPATH_LOCATION    "FLASH"
+#endif
+
+/**
+ * @brief Enable or disable the ART accelerator (I-cache, D-cache, prefetch)
+ * @param enable true: reset and enable all three; false: disable all three
+ * @note The caches must be disabled while they are reset (RM0368 3.5.2)
+ */
+static inline void hotpath_art_config(bool enable)
+{
+    __HAL_FLASH_INSTRUCTION_CACHE_DISABLE();
+    __HAL_FLASH_DATA_CACHE_DISABLE();
+    __HAL_FLASH_PREFETCH_BUFFER_DISABLE();
+
+    if (enable) {
+        __HAL_FLASH_INSTRUCTION_CACHE_RESET();
+        __HAL_FLASH_DATA_CACHE_RESET();
+        __HAL_FLASH_INSTRUCTION_CACHE_ENABLE();
+        __HAL_FLASH_DATA_CACHE_ENABLE();
+        __HAL_FLASH_PREFETCH_BUFFER_ENABLE();
+    }
+}
+
+/**
+ * @brief Check whether the ART instruction cache is enabled
+ */
+static inline bool hotpath_art_enabled(void)
+{
+    return (FLASH->ACR & FLASH_ACR_ICEN) != 0;
+}
+
+#endif /* HOTPATH_H */
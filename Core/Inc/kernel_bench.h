@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @file    kernel_bench.h
+ * @brief   On-device benchmark of the readout kernels (BENCH)
+ ******************************************************************************
+ * @attention
+ *
+ * Runs the data layer's own kernels on full-size buffers and reports CPU
+ * cycles per call, so builds (compiler flags, HOTPATH placement, ART) can be
+ * compared on the real MCU:
+ *
+ *     COPY     readout copy loop without bands (3694 pixels)
+ *     BANDS    same loop integrating 8 bands of 400 pixels
+ *     CRC16    CRC16-CCITT over an FRME frame (7400 bytes)
+ *     PACK12   12-bit packing of a readout (pre-trigger ring)
+ *     PACK10   FRMX 10-bit encoding, in place, including its CRC
+ *     PACK8    FRMX 8-bit encoding, in place, including its CRC
+ *
+ * Every call runs with interrupts masked, so min is the kernel alone; the
+ * source is the live ADC DMA buffer, the working buffers are borrowed from
+ * the idle pre-trigger pool. The timer read overhead is subtracted.
+ *
+ ******************************************************************************
+ */
+
+#ifndef KERNEL_BENCH_H
+#define KERNEL_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Benchmark configuration */
+#define KERNEL_BENCH_RUNS       16      // Calls per kernel
+
+/* Kernels */
+typedef enum {
+    KERNEL_COPY = 0,
+    KERNEL_BANDS,
+    KERNEL_CRC16,
+    KERNEL_PACK12,
+    KERNEL_PACK10,
+    KERNEL_PACK8,
+    KERNEL_COUNT
+} Kernel_Id_t;
+
+/* Cycles per call */
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+} Kernel_Bench_Result_t;
+
+/**
+ * @brief Run every kernel KERNEL_BENCH_RUNS times
+ * @param results Receives KERNEL_COUNT results
+ * @return false if the working memory is in use (pre-trigger ring armed)
+ * @note Call from the main loop with streaming stopped
+ */
+bool kernel_bench_run(Kernel_Bench_Result_t* results);
+
+/**
+ * @brief Name of a kernel as reported by BENCH
+ */
+const char* kernel_bench_name(Kernel_Id_t kernel);
+
+#endif /* KERNEL_BENCH_H */
@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ * @file    latest_frame.h
+ * @brief   Latest-frame slot for pull-mode readout (GETFRAME)
+ ******************************************************************************
+ * @attention
+ *
+ * While a host is connected every readout is processed into a frame buffer,
+ * whether or not acquisition (streaming) is on. The slot remembers the most
+ * recently completed frame; GETFRAME sends it at once instead of waiting for
+ * the next readout (that is SNAP):
+ *
+ *     GETFRAME:SEQ:<seq>,AGE_US:<us>,BITS:<bits>[,SETTLING:1]
+ *
+ * followed directly by the frame (FRME, or FRMX at reduced resolution).
+ * AGE_US is readout complete (DMA done) to the request, so a control loop
+ * sees at most one readout period plus one round trip of staleness. Ages
+ * of a second or more have millisecond resolution.
+ *
+ * The frame is queued zero-copy; the ADC callback already steers around
+ * buffers still queued for USB, so the sent frame cannot be overwritten.
+ *
+ ******************************************************************************
+ */
+
+#ifndef LATEST_FRAME_H
+#define LATEST_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ccd_data_layer.h"
+
+/* Request results */
+typedef enum {
+    LATEST_FRAME_SENT = 0,
+    LATEST_FRAME_NONE,          // No readout completed since power-up
+    LATEST_FRAME_BUSY           // Previous reply still queued / queue full
+} Latest_Frame_Status_t;
+
+/**
+ * @brief Record a completed frame (call from the ADC complete callback)
+ * @param frame Encoded frame, ready to send
+ * @param frame_size Bytes on the wire
+ * @param readout_cycles Cycle count at readout complete
+ */
+void latest_frame_on_readout(const CCD_Frame_t* frame, uint16_t frame_size,
+                             uint32_t readout_cycles);
+
+/**
+ * @brief Queue the info line and the latest frame for USB
+ */
+Latest_Frame_Status_t latest_frame_request(void);
+
+#endif /* LATEST_FRAME_H */
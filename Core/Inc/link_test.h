@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ * @file    link_test.h
+ * @brief   Raw USB link tests: bulk OUT loopback and sink
+ ******************************************************************************
+ * @attention
+ *
+ * Like an upload, a test owns the RX stream once started:
+ *
+ *     LOOPBACK:<n>   the next n bytes received are echoed back on the IN EP
+ *     SINK:<n>       the next n bytes received are discarded
+ *
+ * Both are acknowledged with OK:LOOPBACK:<n> / OK:SINK:<n> before any data
+ * flows. When the last byte has been consumed (and for LOOPBACK echoed),
+ * the result follows:
+ *
+ *     LOOPBACK:BYTES:<n>,US:<t>,BPS:<rate>,XFERS:<k>
+ *     SINK:BYTES:<n>,US:<t>,BPS:<rate>
+ *
+ * US runs from the first received byte to the last byte consumed / echo
+ * completed; BPS is bytes per second in one direction. The IN direction
+ * alone is measured with SOURCE:<n> (= USB_TPUT). A test that receives
+ * nothing for LINK_TEST_TIMEOUT_MS is abandoned with
+ * ERROR:LINK_TEST_TIMEOUT:<bytes received>.
+ *
+ * Echo data goes out zero-copy through the binary transfer queue from two
+ * alternating buffers, so reception continues while one is in flight. The
+ * buffers are borrowed from the pre-trigger pool, so LOOPBACK needs the
+ * ring idle (PRETRIG_OFF); SINK needs no buffers.
+ *
+ ******************************************************************************
+ */
+
+#ifndef LINK_TEST_H
+#define LINK_TEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Test configuration */
+#define LINK_TEST_BUFFER_SIZE   512     // Per echo buffer (two are used)
+#define LINK_TEST_TIMEOUT_MS    2000    // Idle time before a test is abandoned
+
+/* Test modes */
+typedef enum {
+    LINK_TEST_IDLE = 0,
+    LINK_TEST_LOOPBACK,
+    LINK_TEST_SINK
+} Link_Test_Mode_t;
+
+/**
+ * @brief Start a loopback or sink test
+ * @param mode LINK_TEST_LOOPBACK or LINK_TEST_SINK
+ * @param bytes Bytes the host will send (> 0)
+ * @return false if the parameters are invalid, a test is running or (for
+ *         LOOPBACK) the pre-trigger pool is in use
+ */
+bool link_test_start(Link_Test_Mode_t mode, uint32_t bytes);
+
+/**
+ * @brief Check whether a link test owns the RX stream
+ */
+bool link_test_is_active(void);
+
+/**
+ * @brief Consume / echo test data (call from the command layer while active)
+ */
+void link_test_process(void);
+
+#endif /* LINK_TEST_H */
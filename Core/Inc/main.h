@@ -61,6 +61,10 @@ void Error_Handler(void);
 /* Private defines -----------------------------------------------------------*/
 
 /* USER CODE BEGIN Private defines */
+/* External trigger input: rising edge on PB0 (EXTI0) */
+#define TRIG_IN_Pin GPIO_PIN_0
+#define TRIG_IN_GPIO_Port GPIOB
+#define TRIG_IN_EXTI_IRQn EXTI0_IRQn
 
 /* USER CODE END Private defines */
 
@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ * @file    mark.h
+ * @brief   Host annotation tags in the stream (MARK)
+ ******************************************************************************
+ * @attention
+ *
+ * MARK:<id> tags the stream at the next frame boundary: directly before the
+ * data of the next streamed readout (band packet and/or frame) a marker
+ * packet is sent (little-endian):
+ *
+ *     "MARK" | id u32 | seq u16 | tick_ms u32 | crc16
+ *
+ * seq is the frame counter of that readout, the first one recorded after
+ * the mark, tick_ms the HAL tick when the packet was queued. crc16 is
+ * CRC16-CCITT over the preceding bytes. A recording thus carries its own
+ * segmentation: everything after a MARK packet up to the next one belongs
+ * to that id.
+ *
+ * One mark can be pending at a time; it waits for streaming (START) and
+ * for room in the transfer queue for itself and all of the readout's data
+ * (band packet and frame), so it never lands inside a frame and is never
+ * sent for a readout whose data is then refused by a full queue.
+ *
+ ******************************************************************************
+ */
+
+#ifndef MARK_H
+#define MARK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ccd_data_layer.h"
+
+/* Packet layout */
+#define MARK_PACKET_SIZE        16      // marker(4) + id(4) + seq(2) + tick(4) + crc(2)
+
+/**
+ * @brief Request a marker packet before the next streamed readout
+ * @param id Host-chosen tag
+ * @return false if the previous mark has not been sent yet
+ */
+bool mark_request(uint32_t id);
+
+/**
+ * @brief Cancel a pending mark
+ */
+void mark_cancel(void);
+
+/**
+ * @brief Check whether a mark is waiting to be sent
+ */
+bool mark_is_pending(void);
+
+/**
+ * @brief Queue a pending marker packet (ADC callback, before the readout's data)
+ * @param frame Frame that is about to be streamed
+ * @param data_entries Queue entries the readout's data will take
+ */
+void mark_on_readout(const CCD_Frame_t* frame, uint8_t data_entries);
+
+#endif /* MARK_H */
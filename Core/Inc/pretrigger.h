@@ -0,0 +1,117 @@
+/**
+ ******************************************************************************
+ * @file    pretrigger.h
+ * @brief   Pre-trigger frame ring: keep the last K readouts, dump around an
+ *          event
+ ******************************************************************************
+ * @attention
+ *
+ * While armed, every readout's region of interest is packed to 12 bits and
+ * stored in a RAM ring; nothing is streamed. A trigger (TRIGGER command or a
+ * rising edge on the trigger input) marks the next completed readout as the
+ * trigger frame. Once M frames from the trigger frame on have been captured,
+ * the ring is frozen and up to K pre-trigger plus the M post-trigger frames
+ * are sent, oldest first, after a PRETRIG_DUMP info line:
+ *
+ *     PRETRIG_DUMP:PRE:<k>,POST:<m>,TRIG_SEQ:<seq>,ROI:<start>,<len>,SOURCE:<SW|GPIO>
+ *
+ * Each frame is one packet (little-endian):
+ *
+ *     "PTRG" | seq u16 | roi_start u16 | pixel_count u16 | flags u16 |
+ *     packed12 pixels | crc16
+ *
+ * seq is the readout's frame counter, flags bit 0 = post-trigger frame,
+ * bit 1 = trigger frame, bit 2 = settling readout, bits 8-11 = ADC resolution of a reduced-resolution
+ * readout (0 = 12 bits; pixels stay in ADC counts), crc16 is CRC16-CCITT over the preceding bytes.
+ * The dump ends with OK:PRETRIG_DONE and the ring returns to idle.
+ *
+ ******************************************************************************
+ */
+
+#ifndef PRETRIGGER_H
+#define PRETRIGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ccd_data_layer.h"
+
+/* Ring configuration */
+#define PRETRIG_POOL_SIZE     16384   // Bytes shared by all slots
+#define PRETRIG_HEADER_SIZE   12      // marker(4) + seq + roi_start + pixel_count + flags
+#define PRETRIG_CRC_SIZE      2
+
+/* Packet flags */
+#define PRETRIG_FLAG_POST     0x0001  // Captured at or after the trigger
+#define PRETRIG_FLAG_TRIGGER  0x0002  // First readout completed after the trigger
+#define PRETRIG_FLAG_SETTLING 0x0004  // Settling readout (SETTLE FLAG mode)
+#define PRETRIG_FLAG_BITS_SHIFT 8     // ADC bits of a 10/8-bit readout (0 = 12)
+#define PRETRIG_FLAG_BITS_MASK  0x0F00
+
+/* Trigger sources */
+typedef enum {
+    PRETRIG_SOURCE_SW = 0,      // TRIGGER command
+    PRETRIG_SOURCE_GPIO = 1     // Trigger input (EXTI)
+} Pretrig_Source_t;
+
+/* Ring state */
+typedef enum {
+    PRETRIG_STATE_IDLE = 0,     // Not capturing
+    PRETRIG_STATE_ARMED,        // Capturing, waiting for a trigger
+    PRETRIG_STATE_POST,         // Triggered, capturing post-trigger frames
+    PRETRIG_STATE_DUMP          // Frozen, sending frames
+} Pretrig_State_t;
+
+/**
+ * @brief Arm the ring
+ * @param pre Pre-trigger frames to keep (K)
+ * @param post Post-trigger frames to capture (M, at least 1)
+ * @param roi_start First pixel of the region of interest
+ * @param roi_length Pixels in the region of interest
+ * @return true if K + M slots of this ROI fit in the pool
+ */
+bool pretrig_arm(uint16_t pre, uint16_t post, uint16_t roi_start, uint16_t roi_length);
+
+/**
+ * @brief Disarm and discard the ring
+ */
+void pretrig_disarm(void);
+
+/**
+ * @brief Slots available for a given ROI length
+ */
+uint16_t pretrig_capacity(uint16_t roi_length);
+
+/**
+ * @brief Trigger the ring (safe from interrupt context)
+ * @param source Trigger source, reported in the dump
+ * @return true if the ring was armed and this trigger was accepted
+ */
+bool pretrig_trigger(Pretrig_Source_t source);
+
+/**
+ * @brief Store a processed readout (call from the ADC complete callback)
+ * @param frame Frame that was just processed
+ */
+void pretrig_capture(const CCD_Frame_t* frame);
+
+/**
+ * @brief Send a frozen ring (call from main loop)
+ */
+void pretrig_process(void);
+
+/**
+ * @brief Current ring state
+ */
+Pretrig_State_t pretrig_get_state(void);
+
+/**
+ * @brief Lend the slot pool to the main loop while the ring is idle
+ * @return PRETRIG_POOL_SIZE bytes, or NULL if the ring is in use
+ * @note The pool is only valid until the caller returns to the main loop;
+ *       arming the ring takes it back. The LOOPBACK link test keeps it for
+ *       the whole session, which is safe because no command (and so no
+ *       PRETRIG_ARM) is parsed while the test owns RX.
+ */
+uint8_t* pretrig_borrow_pool(void);
+
+#endif /* PRETRIGGER_H */
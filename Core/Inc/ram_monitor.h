@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ * @file    ram_monitor.h
+ * @brief   Stack painting and RAM high-water telemetry
+ ******************************************************************************
+ * @attention
+ *
+ * At startup the free RAM between the heap end and the current stack
+ * pointer is painted with a fixed pattern. The deepest overwritten word
+ * gives the MSP high-water mark over all paths (main loop and interrupts
+ * share the MSP). The stack pointer at ADC callback entry is sampled
+ * separately, which shows how deep the interrupted code was when the
+ * heaviest ISR starts.
+ *
+ * Uses the CubeIDE linker symbols _end, _estack and _Min_Stack_Size (see
+ * sysmem.c). The linker script reserves _Min_Stack_Size after .bss and
+ * fails the link if it does not fit, so a stack_peak above stack_reserved
+ * means the reservation in the .ioc is too small.
+ *
+ ******************************************************************************
+ */
+
+#ifndef RAM_MONITOR_H
+#define RAM_MONITOR_H
+
+#include <stdint.h>
+
+/* RAM usage snapshot (bytes) */
+typedef struct {
+    uint32_t stack_peak;        // Deepest MSP use since startup/reset
+    uint32_t stack_reserved;    // _Min_Stack_Size from the linker script
+    uint32_t stack_free;        // Never-touched bytes between heap and stack
+    uint32_t isr_entry_peak;    // Deepest MSP use seen at ADC callback entry
+    uint32_t heap_used;         // newlib heap (sbrk) in use
+    uint32_t static_ram;        // .data + .bss
+} ram_monitor_stats_t;
+
+/**
+ * @brief Paint the unused stack area
+ * @note Call first thing in main(), before any deep call chains
+ */
+void ram_monitor_init(void);
+
+/**
+ * @brief Sample the stack pointer at ADC callback entry
+ */
+void ram_monitor_sample_isr(void);
+
+/**
+ * @brief Measure current RAM usage
+ * @param stats Receives the snapshot
+ * @note Scans the painted area; call from the main loop only
+ */
+void ram_monitor_get_stats(ram_monitor_stats_t* stats);
+
+/**
+ * @brief Repaint the unused stack area and clear the high-water marks
+ */
+void ram_monitor_reset(void);
+
+#endif /* RAM_MONITOR_H */
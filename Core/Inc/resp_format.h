@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ * @file    resp_format.h
+ * @brief   Fixed-buffer response formatter (no printf, no heap)
+ ******************************************************************************
+ * @attention
+ *
+ * Builds the ASCII responses in a caller-supplied buffer. Every call is
+ * bounded (at most 10 digits per number, strings stop at the buffer end),
+ * nothing is static, and no newlib code is involved - so the same helpers
+ * are used from the main loop and from interrupt handlers.
+ *
+ * Output that does not fit is truncated and the overflow flag is set; the
+ * buffer is always NUL-terminated.
+ *
+ * Typical use:
+ *
+ *     char line[64];
+ *     Resp_Buffer_t r;
+ *     resp_init(&r, line, sizeof(line));
+ *     resp_str(&r, "OK:PRETRIG_ARMED:");
+ *     resp_kv_u32(&r, "PRE", pre);      // "PRE:<pre>"
+ *     resp_kv_u32(&r, "POST", post);    // ",POST:<post>"
+ *     resp_end(&r);                     // "\n"
+ *
+ * resp_kv_* insert the ',' separator unless the text so far ends in ':'.
+ *
+ ******************************************************************************
+ */
+
+#ifndef RESP_FORMAT_H
+#define RESP_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    char* buf;
+    uint16_t size;              // Including the terminating NUL
+    uint16_t len;
+    bool overflow;
+} Resp_Buffer_t;
+
+/**
+ * @brief Start a response in buf
+ */
+void resp_init(Resp_Buffer_t* r, char* buf, uint16_t size);
+
+/**
+ * @brief Append one character
+ */
+void resp_char(Resp_Buffer_t* r, char c);
+
+/**
+ * @brief Append a NUL-terminated string
+ */
+void resp_str(Resp_Buffer_t* r, const char* s);
+
+/**
+ * @brief Append an unsigned decimal number
+ */
+void resp_u32(Resp_Buffer_t* r, uint32_t value);
+
+/**
+ * @brief Append a signed decimal number
+ */
+void resp_i32(Resp_Buffer_t* r, int32_t value);
+
+/**
+ * @brief Append a 16-bit value as four upper-case hex digits
+ */
+void resp_hex16(Resp_Buffer_t* r, uint16_t value);
+
+/**
+ * @brief Append "KEY:value" (with a leading ',' unless following ':')
+ */
+void resp_kv_u32(Resp_Buffer_t* r, const char* key, uint32_t value);
+
+/**
+ * @brief Append "KEY:text" (with a leading ',' unless following ':')
+ */
+void resp_kv_str(Resp_Buffer_t* r, const char* key, const char* text);
+
+/**
+ * @brief Terminate the line with '\n'
+ * @return The response text
+ * @note The '\n' is always kept, even if the body was truncated
+ */
+const char* resp_end(Resp_Buffer_t* r);
+
+/**
+ * @brief Length of the response so far
+ */
+static inline uint16_t resp_len(const Resp_Buffer_t* r)
+{
+    return r->len;
+}
+
+#endif /* RESP_FORMAT_H */
@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file    settle.h
+ * @brief   Settling readouts after configuration changes
+ ******************************************************************************
+ * @attention
+ *
+ * When the integration time, the master clock or the ADC resolution
+ * changes, the readout in progress is mixed and the next one still holds
+ * charge integrated under the old timing. The command layer reports every
+ * such change here; the next SETTLE count readouts are then settling
+ * readouts and are either
+ *
+ *     DROP  not processed or sent at all (default): no frame, band, trace,
+ *           SNAP or GETFRAME data, and no frame counter step, so the host
+ *           sees no seq gap
+ *     FLAG  sent, marked where the format has room: FRMX flags byte bit 0,
+ *           PTRG flags bit 2, ",SETTLING:1" on the GETFRAME line. FRME
+ *           frames have no spare field, so a settling readout that would
+ *           go out as FRME is dropped (and counted) even in FLAG mode; the
+ *           command layer refuses FLAG while every frame is FRME.
+ *
+ * Readouts are counted whether or not streaming is on, so settling that
+ * finished while stopped costs nothing after START.
+ *
+ ******************************************************************************
+ */
+
+#ifndef SETTLE_H
+#define SETTLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Configuration */
+#define SETTLE_DEFAULT_FRAMES   2       // Readout in progress + the next one
+#define SETTLE_MAX_FRAMES       16
+
+/* Handling of settling readouts */
+typedef enum {
+    SETTLE_MODE_DROP = 0,
+    SETTLE_MODE_FLAG
+} Settle_Mode_t;
+
+/* What to do with a completed readout */
+typedef enum {
+    SETTLE_READOUT_NORMAL = 0,  // Not settling
+    SETTLE_READOUT_DROP,        // Settling, discard
+    SETTLE_READOUT_FLAG         // Settling, send flagged
+} Settle_Readout_t;
+
+/**
+ * @brief Set the number of settling readouts per change and their handling
+ * @param frames 0 (off) to SETTLE_MAX_FRAMES
+ * @return false if frames is out of range
+ */
+bool settle_configure(uint8_t frames, Settle_Mode_t mode);
+
+/**
+ * @brief Settling readouts per change
+ */
+uint8_t settle_get_frames(void);
+
+/**
+ * @brief Handling of settling readouts
+ */
+Settle_Mode_t settle_get_mode(void);
+
+/**
+ * @brief Report a configuration change (main loop)
+ */
+void settle_mark_change(void);
+
+/**
+ * @brief Account for a completed readout (call from the ADC complete callback)
+ * @param can_flag false if the readout goes out in a format without a flags
+ *        field (FRME): a settling readout is then dropped in FLAG mode too
+ * @return How the readout is to be handled
+ */
+Settle_Readout_t settle_on_readout(bool can_flag);
+
+/**
+ * @brief Settling readouts dropped since startup
+ */
+uint32_t settle_get_dropped_count(void);
+
+#endif /* SETTLE_H */
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * @file    snap.h
+ * @brief   Single-shot SNAP: deliver the next complete readout after a
+ *          software or hardware trigger, with timing
+ ******************************************************************************
+ * @attention
+ *
+ * The sensor keeps running; a SNAP only selects which readout is sent. The
+ * first readout completed after the trigger is sent as
+ *
+ *     SNAP:SEQ:<seq>,SOURCE:<SW|GPIO>,TRIG_MS:<tick>,LATENCY_US:<us>,PROC_US:<us>
+ *
+ * followed directly by the frame (FRME, or FRMX at reduced resolution).
+ * LATENCY_US is trigger to readout complete (DMA done), PROC_US is readout
+ * complete to the frame being queued for USB (copy + CRC). TRIG_MS is the HAL tick at the trigger.
+ *
+ ******************************************************************************
+ */
+
+#ifndef SNAP_H
+#define SNAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ccd_data_layer.h"
+
+/* Trigger sources */
+typedef enum {
+    SNAP_SOURCE_SW = 0,         // SNAP command
+    SNAP_SOURCE_GPIO = 1        // Trigger input edge (after SNAP:GPIO)
+} Snap_Source_t;
+
+/* SNAP state */
+typedef enum {
+    SNAP_STATE_IDLE = 0,
+    SNAP_STATE_WAIT_EDGE,       // Armed for the trigger input
+    SNAP_STATE_PENDING          // Triggered, waiting for the next readout
+} Snap_State_t;
+
+/**
+ * @brief Trigger a snap now
+ * @return false if a snap is already pending or its info line is still queued
+ */
+bool snap_request(void);
+
+/**
+ * @brief Arm a snap on the next trigger input edge
+ * @return false if a snap is already armed/pending
+ */
+bool snap_arm_gpio(void);
+
+/**
+ * @brief Cancel an armed or pending snap
+ */
+void snap_cancel(void);
+
+/**
+ * @brief Trigger input edge (call from the EXTI callback)
+ * @param edge_cycles DWT cycle count taken at the edge
+ */
+void snap_trigger_input(uint32_t edge_cycles);
+
+/**
+ * @brief Deliver a pending snap (call from the ADC complete callback)
+ * @param frame Frame that was just processed and encoded
+ * @param frame_size Bytes to send (ccd_data_layer_encode_frame())
+ * @param readout_cycles DWT cycle count taken when the readout completed
+ * @return true if the frame was queued for USB by the snap
+ */
+bool snap_on_readout(const CCD_Frame_t* frame, uint16_t frame_size, uint32_t readout_cycles);
+
+/**
+ * @brief Current snap state
+ */
+Snap_State_t snap_get_state(void);
+
+#endif /* SNAP_H */
@@ -58,6 +58,7 @@ void SysTick_Handler(void);
 void DMA2_Stream0_IRQHandler(void);
 void OTG_FS_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void EXTI0_IRQHandler(void);
 
 /* USER CODE END EFP */
 
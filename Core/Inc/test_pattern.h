@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * @file    test_pattern.h
+ * @brief   Synthetic pixel data for end-to-end transport validation
+ ******************************************************************************
+ * @attention
+ *
+ * With a pattern selected, the ADC buffer is overwritten with deterministic
+ * data in the ADC complete callback, just before the readout is processed.
+ * Timing, copy, band sums, encoding, CRC and USB stay the real thing, so a
+ * host that regenerates the pattern can check every byte at full rate.
+ *
+ * Pixel i of the readout with frame counter seq (masked to the ADC bits):
+ *
+ *   RAMP      (i + seq) & 0xFFF             ramp shifted one step per frame
+ *   CONST     value                         PATTERN:CONST,<value>
+ *   PRBS      lowbias32(seq * 0x9E3779B1 + i) >> 20
+ *   COUNTER   (seq * CCD_PIXEL_COUNT + i) & 0xFFF   continuous sample count
+ *
+ * lowbias32(x): x ^= x >> 16; x *= 0x7FEB352D; x ^= x >> 15;
+ *               x *= 0x846CA68B; x ^= x >> 16   (all mod 2^32)
+ *
+ * PRBS is addressable by (seq, i) rather than a running LFSR, so any frame
+ * can be checked on its own after drops.
+ *
+ ******************************************************************************
+ */
+
+#ifndef TEST_PATTERN_H
+#define TEST_PATTERN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Patterns */
+typedef enum {
+    TEST_PATTERN_OFF = 0,       // Real ADC data
+    TEST_PATTERN_RAMP,
+    TEST_PATTERN_CONST,
+    TEST_PATTERN_PRBS,
+    TEST_PATTERN_COUNTER,
+    TEST_PATTERN_COUNT
+} Test_Pattern_t;
+
+#define TEST_PATTERN_CONST_DEFAULT  0x0A5A
+
+/**
+ * @brief Select a pattern
+ * @param pattern TEST_PATTERN_xxx
+ * @param value Pixel value for TEST_PATTERN_CONST (ignored otherwise)
+ */
+void test_pattern_set(Test_Pattern_t pattern, uint16_t value);
+
+/**
+ * @brief Pattern in use
+ */
+Test_Pattern_t test_pattern_get(void);
+
+/**
+ * @brief Name of a pattern ("OFF", "RAMP", ...)
+ */
+const char* test_pattern_name(Test_Pattern_t pattern);
+
+/**
+ * @brief Look up a pattern by name (case-insensitive)
+ * @return true if found
+ */
+bool test_pattern_from_name(const char* name, Test_Pattern_t* pattern);
+
+/**
+ * @brief Overwrite the ADC buffer with the pattern (call from the ADC callback)
+ * @param buffer ADC buffer, at least CCD_PIXEL_COUNT samples
+ * @param seq Frame counter the readout will get
+ * @param bits ADC resolution the values are masked to
+ * @note Does nothing while no pattern is selected
+ */
+void test_pattern_fill(volatile uint16_t* buffer, uint16_t seq, uint8_t bits);
+
+#endif /* TEST_PATTERN_H */
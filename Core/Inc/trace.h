@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @file    trace.h
+ * @brief   Readout latency trace: cycle timestamps of the device-side stages
+ *          of each streamed frame
+ ******************************************************************************
+ * @attention
+ *
+ * With TRACE:ON every readout processed while acquiring is followed by a
+ * trace packet (little-endian):
+ *
+ *     "TRCE" | seq u16 | flags u8 | cycles_per_us u8 | tick_ms u32 |
+ *     icg u32 | dma u32 | ready u32 | submit u32 | crc16
+ *
+ * The four stamps are DWT cycle counts (HCLK):
+ *   icg     last ICG edge (end of the ICG pulse) before the DMA completed,
+ *           i.e. the end of the newest integration in the buffer
+ *   dma     ADC DMA complete (callback entry)
+ *   ready   copy, CRC and encoding done
+ *   submit  frame handed to the USB transfer queue (0 if not sent)
+ * flags bit 0 is set if the frame was queued. tick_ms is the HAL tick when
+ * the packet was built, for unwrapping the 32-bit stamps on the host. crc16
+ * is CRC16-CCITT over the preceding bytes.
+ *
+ * The ICG edge is reconstructed from the TIM2 counter, which runs at HCLK
+ * in this clock tree, so no extra interrupt is needed.
+ *
+ ******************************************************************************
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ccd_data_layer.h"
+
+/* Packet layout */
+#define TRACE_PACKET_SIZE       30
+#define TRACE_FLAG_SENT         0x01
+
+/**
+ * @brief Enable or disable trace packets
+ */
+void trace_set_enabled(bool enabled);
+
+/**
+ * @brief Check whether trace packets are enabled
+ */
+bool trace_is_enabled(void);
+
+/**
+ * @brief Queue the trace packet for a processed readout (ADC callback)
+ * @param frame Frame that was just processed
+ * @param dma_cycles Cycle count at DMA complete
+ * @param ready_cycles Cycle count after processing and encoding
+ * @param submit_cycles Cycle count after queueing the frame
+ * @param sent true if the frame was queued for USB
+ */
+void trace_on_readout(const CCD_Frame_t* frame, uint32_t dma_cycles,
+                      uint32_t ready_cycles, uint32_t submit_cycles, bool sent);
+
+/**
+ * @brief Trace packets that could not be queued since startup
+ */
+uint32_t trace_get_dropped_count(void);
+
+#endif /* TRACE_H */
@@ -7,10 +7,18 @@
  * @attention
  *
  * This layer provides:
- * - Ring-buffered USB RX (commands from Python)
+ * - Ring-buffered USB RX (commands from Python), lossless: the OUT endpoint
+ *   is only re-armed while the ring can take another full packet, so the
+ *   host is NAKed (USB back-pressure) instead of bytes being dropped
  * - Ring-buffered USB TX (responses to Python)
+ * - Queue of zero-copy binary transfers (frames), safe to fill from
+ *   interrupts and chained from the transmit complete interrupt
  * - Non-blocking send/receive
  * - Separation of data path (frames) from control path (commands)
+ * - Device-side bulk IN throughput test and OTG FIFO profile selection
+ * - Host presence from the CDC line state (DTR): nothing is sent while no
+ *   host has the port open, and an IN transfer the host never collects is
+ *   aborted by a watchdog, so streaming resumes on reconnect
  *
  ******************************************************************************
  */
@@ -23,8 +31,14 @@
 #include <stddef.h>
 
 /* Transport configuration */
-#define USB_RX_BUFFER_SIZE  256   // Command receive buffer
+#define USB_RX_BUFFER_SIZE  1024  // Command / upload receive buffer
+#define USB_RX_PACKET_SIZE  64    // Largest OUT packet (CDC_DATA_FS_MAX_PACKET_SIZE)
 #define USB_TX_BUFFER_SIZE  512   // Response transmit buffer
+#define USB_TX_QUEUE_DEPTH  4     // Binary transfers waiting for the data IN EP
+#define USB_TX_TIMEOUT_MS   500   // IN transfer watchdog (a full frame takes ~7 ms)
+
+/* Throughput test configuration */
+#define USB_TPUT_MAX_CHUNK  2048  // Largest single CDC transfer used by the test
 
 /* Function prototypes */
 
@@ -100,24 +114,75 @@ uint16_t usb_transport_write_string(const char *str);
  */
 bool usb_transport_send_direct(const uint8_t *buffer, uint16_t length);
 
+/**
+ * @brief Queue a binary transfer behind any queued or in-flight transfer
+ * @param buffer Data to send; must stay untouched until
+ *        usb_transport_is_queued() returns false for it
+ * @param length Number of bytes
+ * @return true if queued, false if the queue is full (counted in stats)
+ * @note Safe from interrupt context. Queued transfers go out before
+ *       buffered responses.
+ */
+bool usb_transport_queue_direct(const uint8_t *buffer, uint16_t length);
+
+/**
+ * @brief Free entries in the binary transfer queue
+ */
+uint8_t usb_transport_queue_space(void);
+
+/**
+ * @brief Check whether a buffer is still queued or being transmitted
+ * @param buffer Buffer passed to usb_transport_queue_direct()
+ */
+bool usb_transport_is_queued(const uint8_t *buffer);
+
 /**
  * @brief Called by USB CDC receive callback (internal use)
  * @param buffer Received data
  * @param length Number of bytes received
+ * @return true if the OUT endpoint may be re-armed now, false if the ring
+ *         cannot take another packet (the transport re-arms it once the
+ *         consumer has made room)
  */
-void usb_transport_rx_callback(uint8_t *buffer, uint32_t length);
+bool usb_transport_rx_callback(uint8_t *buffer, uint32_t length);
 
 /**
  * @brief Called by USB CDC transmit complete callback (internal use)
  */
 void usb_transport_tx_complete_callback(void);  // ← ADDED
 
+/**
+ * @brief Called on CDC SET_CONTROL_LINE_STATE (internal use)
+ * @param line_state wValue of the request: bit 0 = DTR, bit 1 = RTS
+ */
+void usb_transport_line_state_callback(uint16_t line_state);
+
+/**
+ * @brief Called when the CDC class is initialised / de-initialised (internal use)
+ * @param configured true after SET_CONFIGURATION, false on reset or unplug
+ */
+void usb_transport_class_state_callback(bool configured);
+
+/**
+ * @brief Check whether a host is there to receive data
+ * @return true if the device is configured and the host has the port open
+ *         (DTR set). Until a host sets DTR for the first time it is assumed
+ *         present, so terminals that never touch DTR keep working.
+ */
+bool usb_transport_host_present(void);
+
 /**
  * @brief Check if USB is busy transmitting
  * @return true if busy, false if ready
  */
 bool usb_transport_is_tx_busy(void);
 
+/**
+ * @brief Check that no transfer is in flight and no response is queued
+ * @return true if a direct send now goes out after everything written so far
+ */
+bool usb_transport_tx_idle(void);
+
 /**
  * @brief Get statistics (for debugging)
  */
@@ -126,9 +191,64 @@ typedef struct {
     uint32_t tx_bytes_total;
     uint32_t rx_overflow_count;
     uint32_t tx_overflow_count;
+    uint32_t rx_pause_count;      // Times the OUT endpoint was held off (ring full)
+    uint32_t tx_queue_drops;      // Binary transfers refused (queue full)
+    uint32_t tx_timeouts;         // IN transfers aborted by the watchdog
+    uint32_t tx_truncated;        // ... of which the host had already received part
+    uint32_t host_closes;         // Times the host dropped DTR (port closed)
 } usb_transport_stats_t;
 
 void usb_transport_get_stats(usb_transport_stats_t *stats);
 void usb_transport_reset_stats(void);
 
+/**
+ * @brief Throughput test result
+ *
+ * Stream byte n carries the value (n & 0xFF), so the host can verify the data.
+ * "xfer" is the time one CDC transfer occupies the IN endpoint; "gap" is the
+ * idle time between a transfer completing and the next one being submitted.
+ */
+typedef struct {
+    uint8_t  fifo_profile;       // USBD_FIFO_PROFILE_xxx in use
+    uint32_t bytes;              // Bytes sent
+    uint16_t chunk;              // Bytes per CDC transfer
+    uint32_t transfers;          // Number of CDC transfers
+    uint32_t elapsed_us;         // First submit to last completion
+    uint32_t bytes_per_sec;      // bytes / elapsed
+    uint32_t xfer_min_us;
+    uint32_t xfer_max_us;
+    uint32_t gap_min_us;
+    uint32_t gap_max_us;
+    uint32_t gap_avg_us;
+} usb_throughput_result_t;
+
+/**
+ * @brief Start a device-side bulk IN throughput test
+ * @param total_bytes Number of bytes to stream
+ * @param chunk Bytes per CDC transfer (1..USB_TPUT_MAX_CHUNK)
+ * @return true if started, false if parameters invalid or a test is running
+ * @note Frame streaming must be stopped - frames share the IN endpoint
+ */
+bool usb_transport_throughput_start(uint32_t total_bytes, uint16_t chunk);
+
+/**
+ * @brief Fetch the result of a finished throughput test (once)
+ * @param result Destination for the result
+ * @return true if a new result was available
+ */
+bool usb_transport_throughput_get_result(usb_throughput_result_t *result);
+
+/**
+ * @brief Select an OTG FIFO profile and re-enumerate the device
+ * @param profile USBD_FIFO_PROFILE_xxx
+ * @return true if accepted (re-init happens from usb_transport_process once
+ *         the pending responses have been flushed)
+ */
+bool usb_transport_set_fifo_profile(uint8_t profile);
+
+/**
+ * @brief Get the OTG FIFO profile in use
+ */
+uint8_t usb_transport_get_fifo_profile(void);
+
 #endif /* USB_TRANSPORT_H */
@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ * @file    adaptive_format.c
+ * @brief   Adaptive frame encoding implementation
+ ******************************************************************************
+ */
+
+#include "adaptive_format.h"
+#include "hotpath.h"
+
+/* Encodings from full to most compact */
+static const uint8_t level_bits[] = {12, 10, 8};
+#define LEVEL_COUNT     (sizeof(level_bits) / sizeof(level_bits[0]))
+
+/* Private variables */
+static volatile bool enabled = false;
+static volatile uint8_t level = 0;
+static uint8_t window_frames = 0;       // ADC callback only
+static uint8_t window_busy = 0;
+static uint8_t clean_windows = 0;
+static uint8_t recover_windows = ADAPT_RECOVER_WINDOWS;
+static uint8_t windows_since_up = 0xFF; // Saturating
+static volatile bool restart = false;   // Set by the main loop, window reset in the callback
+static volatile uint32_t steps_down = 0;
+static volatile uint32_t steps_up = 0;
+
+/**
+ * @brief Enable / disable adaptive encoding
+ */
+void adaptive_format_set_enabled(bool on)
+{
+    level = 0;
+    restart = true;
+    enabled = on;
+}
+
+/**
+ * @brief Check whether adaptive encoding is on
+ */
+bool adaptive_format_is_enabled(void)
+{
+    return enabled;
+}
+
+/**
+ * @brief Resolution limit for the next streamed frame
+ */
+HOTPATH_FUNC uint8_t adaptive_format_get_bits(void)
+{
+    return enabled ? level_bits[level] : 12;
+}
+
+/**
+ * @brief Start a new evaluation window
+ */
+static inline void window_reset(void)
+{
+    window_frames = 0;
+    window_busy = 0;
+}
+
+/**
+ * @brief Step to the next more compact encoding
+ */
+static void step_down(void)
+{
+    if (level + 1U < LEVEL_COUNT) {
+        level++;
+        steps_down++;
+    }
+    // Fell behind soon after stepping up: wait longer next time
+    if (windows_since_up < recover_windows && recover_windows < ADAPT_RECOVER_MAX_WINDOWS) {
+        recover_windows *= 2;
+    }
+    windows_since_up = 0xFF;
+    clean_windows = 0;
+}
+
+/**
+ * @brief Account for a streamed frame
+ */
+HOTPATH_FUNC void adaptive_format_on_submit(bool sent, uint8_t queue_space)
+{
+    if (!enabled) {
+        return;
+    }
+    if (restart) {
+        restart = false;
+        window_reset();
+        clean_windows = 0;
+        recover_windows = ADAPT_RECOVER_WINDOWS;
+        windows_since_up = 0xFF;
+    }
+
+    // A dropped frame: more compact right away
+    if (!sent) {
+        step_down();
+        window_reset();
+        return;
+    }
+
+    window_frames++;
+    if (queue_space <= ADAPT_BUSY_SPACE) {
+        window_busy++;
+    }
+    if (window_frames < ADAPT_WINDOW) {
+        return;
+    }
+
+    if (windows_since_up < 0xFF) {
+        windows_since_up++;
+    }
+
+    if (window_busy > ADAPT_WINDOW / 2) {
+        // Sustained backlog without drops yet
+        step_down();
+    } else if (window_busy == 0) {
+        if (++clean_windows >= recover_windows) {
+            if (level > 0) {
+                level--;
+                steps_up++;
+                windows_since_up = 0;
+            }
+            clean_windows = 0;
+        }
+    } else {
+        clean_windows = 0;
+    }
+    window_reset();
+}
+
+/**
+ * @brief Steps to a more compact encoding since startup
+ */
+uint32_t adaptive_format_get_steps_down(void)
+{
+    return steps_down;
+}
+
+/**
+ * @brief Steps back to a fuller encoding since startup
+ */
+uint32_t adaptive_format_get_steps_up(void)
+{
+    return steps_up;
+}
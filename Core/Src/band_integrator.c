@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ * @file    band_integrator.c
+ * @brief   Spectral band integrator implementation
+ ******************************************************************************
+ * @attention
+ *
+ * The sums come out of the data layer's copy loop, so a readout costs only
+ * the centroid divisions and a CRC over at most 74 bytes here. Packets are
+ * double-buffered like the frames: a buffer still queued for USB is never
+ * rewritten.
+ *
+ ******************************************************************************
+ */
+
+#include "band_integrator.h"
+#include "usb_transport.h"
+#include "hotpath.h"
+#include <string.h>
+
+static const uint8_t BAND_MARKER[4] = {'B', 'A', 'N', 'D'};
+
+/* Configuration */
+static volatile uint8_t active_count = 0;
+static volatile uint32_t active_generation = 0;  // Band set the packets are for
+static volatile uint16_t frame_divider = 0;
+
+/* Packet buffers (written by the ADC callback) */
+static uint8_t packets[2][BAND_PACKET_SIZE(CCD_MAX_BANDS)] __attribute__((aligned(4)));
+static uint8_t packet_next = 0;
+static uint16_t frames_since_full = 0;
+static volatile uint32_t dropped_count = 0;
+
+/**
+ * @brief Enable band telemetry with a new band set
+ */
+Band_Status_t band_integrator_configure(const CCD_Band_t* bands, uint8_t count)
+{
+    if (count == 0 || count > CCD_MAX_BANDS) {
+        return BAND_ERROR_COUNT;
+    }
+
+    for (uint8_t b = 0; b < count; b++) {
+        if (bands[b].length == 0 ||
+            (uint32_t)bands[b].start + bands[b].length > CCD_PIXEL_COUNT) {
+            return BAND_ERROR_RANGE;
+        }
+        // The copy loop walks the readout once, left to right
+        if (b > 0 && bands[b].start < bands[b - 1].start + bands[b - 1].length) {
+            return BAND_ERROR_ORDER;
+        }
+    }
+
+    active_generation = ccd_data_layer_set_bands(bands, count);
+    active_count = count;
+    frames_since_full = 0;
+    return BAND_OK;
+}
+
+/**
+ * @brief Disable band telemetry
+ */
+void band_integrator_disable(void)
+{
+    active_count = 0;
+    ccd_data_layer_set_bands(NULL, 0);
+}
+
+/**
+ * @brief Number of active bands
+ */
+uint8_t band_integrator_get_count(void)
+{
+    return active_count;
+}
+
+/**
+ * @brief Send a full frame only every Nth readout while bands are active
+ */
+void band_integrator_set_frame_divider(uint16_t divider)
+{
+    frame_divider = divider;
+    frames_since_full = 0;
+}
+
+/**
+ * @brief Current full-frame divider
+ */
+uint16_t band_integrator_get_frame_divider(void)
+{
+    return frame_divider;
+}
+
+/**
+ * @brief Transfers the readout's data will take in the queue
+ */
+HOTPATH_FUNC uint8_t band_integrator_entries_due(void)
+{
+    uint8_t count;
+    uint32_t generation;
+
+    if (active_count == 0) {
+        return 1;                       // The full frame, as without bands
+    }
+
+    // No packet (and no frame) until the new band set is applied
+    ccd_data_layer_get_band_sums(&count, &generation);
+    if (generation != active_generation) {
+        return 0;
+    }
+
+    bool frame_due = (frame_divider != 0 && frames_since_full + 1U >= frame_divider);
+    return frame_due ? 2 : 1;
+}
+
+/**
+ * @brief Queue the band packet for a processed readout
+ */
+HOTPATH_FUNC bool band_integrator_on_readout(const CCD_Frame_t* frame)
+{
+    if (active_count == 0) {
+        return true;
+    }
+
+    uint8_t count;
+    uint32_t generation;
+    const CCD_Band_Sum_t* sums = ccd_data_layer_get_band_sums(&count, &generation);
+
+    // The new band set is applied with the next readout (the count alone
+    // cannot tell a replaced set of the same size)
+    if (generation != active_generation) {
+        return false;
+    }
+
+    uint8_t index = packet_next;
+    if (usb_transport_is_queued(packets[index])) {
+        index ^= 1;
+    }
+
+    if (usb_transport_is_queued(packets[index])) {
+        dropped_count++;
+    } else {
+        uint8_t* packet = packets[index];
+        uint16_t size = BAND_PACKET_SIZE(count);
+
+        memcpy(packet, BAND_MARKER, 4);
+        memcpy(&packet[4], (const void*)&frame->frame_counter, 2);
+        packet[6] = count;
+        packet[7] = (ccd_data_layer_get_frame_bits() == 12) ? 0 : ccd_data_layer_get_frame_bits();
+
+        for (uint8_t b = 0; b < count; b++) {
+            uint32_t entry[2];
+
+            entry[0] = sums[b].sum;
+            entry[1] = (sums[b].sum == 0) ? BAND_CENTROID_NONE :
+                       ((uint32_t)sums[b].start << 8) +
+                       (uint32_t)((sums[b].moment << 8) / sums[b].sum);
+            memcpy(&packet[BAND_HEADER_SIZE + b * BAND_ENTRY_SIZE], entry, sizeof(entry));
+        }
+
+        uint16_t crc = ccd_data_layer_calculate_crc16(packet, size - BAND_CRC_SIZE);
+        memcpy(&packet[size - BAND_CRC_SIZE], &crc, BAND_CRC_SIZE);
+
+        if (usb_transport_queue_direct(packet, size)) {
+            packet_next = index ^ 1;
+        } else {
+            dropped_count++;
+        }
+    }
+
+    // Rate-limit full frames
+    if (frame_divider == 0) {
+        return false;
+    }
+    if (++frames_since_full >= frame_divider) {
+        frames_since_full = 0;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Band packets that could not be queued
+ */
+uint32_t band_integrator_get_dropped_count(void)
+{
+    return dropped_count;
+}
@@ -0,0 +1,584 @@
+/**
+ ******************************************************************************
+ * @file    bulk_upload.c
+ * @brief   Chunked binary upload channel implementation
+ ******************************************************************************
+ * @attention
+ *
+ * Flash store layout (append-only, starting at UPLOAD_FLASH_BASE):
+ *
+ *     size u32 | UPLOAD_RECORD_MAGIC|type u32 | data (padded to 4) | commit u32
+ *
+ * The first two words are programmed when the upload opens, the data as the
+ * chunks arrive, and the commit word (UPLOAD_COMMIT_MAGIC|crc16) only after
+ * the whole image has been verified. A record without a commit word (aborted
+ * upload) is skipped. The log ends at the first erased size word.
+ *
+ * The store must never hold code. The tree has no linker script (CubeIDE
+ * generates it), so the firmware checks its own image at boot: it ends at
+ * _sidata + (_edata - _sdata), the load image of .data being the last thing
+ * in flash. If that reaches UPLOAD_FLASH_BASE the store is disabled (no
+ * program, no erase), so an upload can never overwrite the running code.
+ *
+ ******************************************************************************
+ */
+
+#include "bulk_upload.h"
+#include "usb_transport.h"
+#include "ccd_data_layer.h"
+#include "resp_format.h"
+#include "main.h"
+#include <string.h>
+
+/* Flash record markers */
+#define UPLOAD_RECORD_MAGIC   0x55504C00U   // "UPL" + type in the low byte
+#define UPLOAD_COMMIT_MAGIC   0xC0DE0000U   // + image crc16 in the low half
+#define UPLOAD_ERASED_WORD    0xFFFFFFFFU
+#define UPLOAD_RECORD_OVERHEAD 12U          // size + type + commit words
+
+#define PAD4(x)  (((x) + 3U) & ~3U)
+
+/* The store is the last sector of the part; a bigger part needs a new layout */
+_Static_assert(UPLOAD_FLASH_BASE + UPLOAD_FLASH_SIZE - 1U == FLASH_END,
+               "upload store must be the last flash sector");
+
+/* Linker script symbols: end of the firmware image in flash */
+extern uint8_t _sidata;
+extern uint8_t _sdata;
+extern uint8_t _edata;
+
+static const uint8_t UPLOAD_CHUNK_MARKER[4] = {'U', 'P', 'C', 'K'};
+
+/* Receive state */
+typedef enum {
+    UPLOAD_IDLE = 0,
+    UPLOAD_RX_HEADER,
+    UPLOAD_RX_PAYLOAD,
+    UPLOAD_RX_SKIP              // Discarding the payload of a rejected chunk
+} upload_state_t;
+
+/* Session */
+static upload_state_t state = UPLOAD_IDLE;
+static Upload_Type_t session_type;
+static Upload_Target_t session_target;
+static uint32_t session_size = 0;
+static uint32_t session_received = 0;       // Next expected offset
+static uint32_t session_record = 0;         // Flash record address
+static uint32_t last_rx_tick = 0;
+
+/* Chunk reassembly */
+static uint8_t header_buf[UPLOAD_CHUNK_HEADER_SIZE];
+static uint16_t header_count = 0;
+static uint8_t payload_buf[UPLOAD_MAX_CHUNK];
+static uint16_t payload_count = 0;
+static uint16_t skip_remaining = 0;
+static uint32_t chunk_offset = 0;
+static uint16_t chunk_length = 0;
+static uint16_t chunk_crc = 0;
+
+/* RAM target */
+static uint8_t ram_image[UPLOAD_RAM_SIZE];
+static bool ram_image_valid = false;
+static Upload_Type_t ram_image_type;
+static uint32_t ram_image_size = 0;
+static uint16_t ram_image_crc = 0;
+
+/* Flash store usable (firmware image ends below it) */
+static bool flash_store_ok = false;
+
+/* Private function prototypes */
+static void handle_header(void);
+static void handle_chunk(void);
+static void handle_close(uint16_t image_crc);
+static void send_ack(void);
+static void send_nak(const char *reason);
+static void end_session(void);
+static uint32_t flash_log_tail(void);
+static bool flash_program(uint32_t address, const uint8_t *data, uint32_t length);
+static void flash_flush_data_cache(void);
+
+/**
+ * @brief Initialize the upload channel
+ */
+void bulk_upload_init(void)
+{
+    state = UPLOAD_IDLE;
+    ram_image_valid = false;
+    header_count = 0;
+    payload_count = 0;
+
+    uint32_t image_end = (uint32_t)&_sidata + (uint32_t)(&_edata - &_sdata);
+    flash_store_ok = (image_end <= UPLOAD_FLASH_BASE);
+}
+
+/**
+ * @brief Check whether the flash store is clear of the firmware image
+ */
+bool bulk_upload_flash_usable(void)
+{
+    return flash_store_ok;
+}
+
+/**
+ * @brief Open an upload session
+ */
+Upload_Status_t bulk_upload_begin(Upload_Type_t type, uint32_t size, Upload_Target_t target)
+{
+    if (state != UPLOAD_IDLE) {
+        return UPLOAD_ERROR_BUSY;
+    }
+
+    if (type < UPLOAD_TYPE_CAL || type > UPLOAD_TYPE_SEQ || size == 0) {
+        return UPLOAD_ERROR_INVALID_PARAM;
+    }
+
+    if (target == UPLOAD_TARGET_RAM) {
+        if (size > UPLOAD_RAM_SIZE) {
+            return UPLOAD_ERROR_NO_SPACE;
+        }
+        // The old RAM image is overwritten as chunks arrive
+        ram_image_valid = false;
+    }
+    else {
+        if (!flash_store_ok) {
+            return UPLOAD_ERROR_FLASH;
+        }
+        if (size > bulk_upload_flash_free()) {
+            return UPLOAD_ERROR_NO_SPACE;
+        }
+
+        // Open the record now so an aborted upload can still be skipped
+        uint32_t record = flash_log_tail();
+        uint32_t record_header[2] = { size, UPLOAD_RECORD_MAGIC | (uint32_t)type };
+
+        if (!flash_program(record, (const uint8_t*)record_header, sizeof(record_header))) {
+            return UPLOAD_ERROR_FLASH;
+        }
+        session_record = record;
+    }
+
+    session_type = type;
+    session_target = target;
+    session_size = size;
+    session_received = 0;
+    header_count = 0;
+    payload_count = 0;
+    last_rx_tick = HAL_GetTick();
+    state = UPLOAD_RX_HEADER;
+
+    return UPLOAD_OK;
+}
+
+/**
+ * @brief Check whether a binary upload owns the RX stream
+ */
+bool bulk_upload_is_active(void)
+{
+    return (state != UPLOAD_IDLE);
+}
+
+/**
+ * @brief Consume upload chunks from the USB RX buffer
+ */
+void bulk_upload_process(void)
+{
+    if (state == UPLOAD_IDLE) {
+        return;
+    }
+
+    if (!usb_transport_available()) {
+        if ((HAL_GetTick() - last_rx_tick) > UPLOAD_TIMEOUT_MS) {
+            end_session();
+            usb_transport_write_string("ERROR:UPLOAD_TIMEOUT\n");
+        }
+        return;
+    }
+
+    last_rx_tick = HAL_GetTick();
+
+    while (state != UPLOAD_IDLE && usb_transport_available()) {
+        if (state == UPLOAD_RX_HEADER) {
+            header_count += usb_transport_read(&header_buf[header_count],
+                                               UPLOAD_CHUNK_HEADER_SIZE - header_count);
+            if (header_count == UPLOAD_CHUNK_HEADER_SIZE) {
+                handle_header();
+            }
+        }
+        else if (state == UPLOAD_RX_SKIP) {
+            uint8_t discard[64];
+            uint16_t want = (skip_remaining < sizeof(discard)) ? skip_remaining : sizeof(discard);
+            skip_remaining -= usb_transport_read(discard, want);
+            if (skip_remaining == 0) {
+                state = UPLOAD_RX_HEADER;
+            }
+        }
+        else {
+            payload_count += usb_transport_read(&payload_buf[payload_count],
+                                                chunk_length - payload_count);
+            if (payload_count == chunk_length) {
+                handle_chunk();
+                state = UPLOAD_RX_HEADER;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Find the newest committed image of a type
+ */
+bool bulk_upload_find(Upload_Type_t type, bulk_upload_image_t *image)
+{
+    if (ram_image_valid && ram_image_type == type) {
+        image->type = type;
+        image->target = UPLOAD_TARGET_RAM;
+        image->size = ram_image_size;
+        image->crc = ram_image_crc;
+        image->data = ram_image;
+        return true;
+    }
+
+    bool found = false;
+    uint32_t address = UPLOAD_FLASH_BASE;
+
+    if (!flash_store_ok) {
+        return false;       // Sector 5 holds code, not images
+    }
+
+    while (address + UPLOAD_RECORD_OVERHEAD <= UPLOAD_FLASH_BASE + UPLOAD_FLASH_SIZE) {
+        uint32_t size = *(const volatile uint32_t*)address;
+        if (size == UPLOAD_ERASED_WORD ||
+            address + UPLOAD_RECORD_OVERHEAD + PAD4(size) > UPLOAD_FLASH_BASE + UPLOAD_FLASH_SIZE) {
+            break;
+        }
+
+        uint32_t tag = *(const volatile uint32_t*)(address + 4);
+        uint32_t commit = *(const volatile uint32_t*)(address + 8 + PAD4(size));
+
+        if (tag == (UPLOAD_RECORD_MAGIC | (uint32_t)type) &&
+            (commit & 0xFFFF0000U) == UPLOAD_COMMIT_MAGIC) {
+            // Keep scanning - the newest record wins
+            image->type = type;
+            image->target = UPLOAD_TARGET_FLASH;
+            image->size = size;
+            image->crc = (uint16_t)(commit & 0xFFFFU);
+            image->data = (const uint8_t*)(address + 8);
+            found = true;
+        }
+
+        address += UPLOAD_RECORD_OVERHEAD + PAD4(size);
+    }
+
+    return found;
+}
+
+/**
+ * @brief Erase the flash image store
+ */
+Upload_Status_t bulk_upload_erase_flash(void)
+{
+    if (state != UPLOAD_IDLE) {
+        return UPLOAD_ERROR_BUSY;
+    }
+    if (!flash_store_ok) {
+        return UPLOAD_ERROR_FLASH;      // Would erase the firmware itself
+    }
+
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t sector_error = 0;
+
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = UPLOAD_FLASH_SECTOR;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &sector_error);
+    HAL_FLASH_Lock();
+
+    return (status == HAL_OK) ? UPLOAD_OK : UPLOAD_ERROR_FLASH;
+}
+
+/**
+ * @brief Bytes still free in the flash image store
+ */
+uint32_t bulk_upload_flash_free(void)
+{
+    if (!flash_store_ok) {
+        return 0;
+    }
+
+    uint32_t used = flash_log_tail() - UPLOAD_FLASH_BASE;
+
+    if (used + UPLOAD_RECORD_OVERHEAD >= UPLOAD_FLASH_SIZE) {
+        return 0;
+    }
+    // Image data is padded to a word, so round the usable size down
+    return (UPLOAD_FLASH_SIZE - used - UPLOAD_RECORD_OVERHEAD) & ~3U;
+}
+
+/* ============================================================================
+   Chunk handling
+   ============================================================================ */
+
+/**
+ * @brief A complete chunk header is in header_buf
+ */
+static void handle_header(void)
+{
+    // Lost sync (host sent garbage or a stray command) - slide by one byte
+    if (memcmp(header_buf, UPLOAD_CHUNK_MARKER, 4) != 0) {
+        memmove(header_buf, &header_buf[1], UPLOAD_CHUNK_HEADER_SIZE - 1);
+        header_count = UPLOAD_CHUNK_HEADER_SIZE - 1;
+        return;
+    }
+
+    memcpy(&chunk_offset, &header_buf[4], 4);
+    memcpy(&chunk_length, &header_buf[8], 2);
+    memcpy(&chunk_crc, &header_buf[10], 2);
+    header_count = 0;
+
+    if (chunk_length == 0) {
+        handle_close(chunk_crc);
+        return;
+    }
+
+    if (chunk_length > UPLOAD_MAX_CHUNK) {
+        // Too big to store, but the header says how long it is: skip it, so
+        // an "UPCK" inside the payload is never taken for a chunk header
+        send_nak("LENGTH");
+        skip_remaining = chunk_length;
+        state = UPLOAD_RX_SKIP;
+        return;
+    }
+
+    payload_count = 0;
+    state = UPLOAD_RX_PAYLOAD;
+}
+
+/**
+ * @brief A complete chunk payload is in payload_buf
+ */
+static void handle_chunk(void)
+{
+    if (chunk_offset != session_received) {
+        send_nak("ORDER");
+        return;
+    }
+
+    if (chunk_offset + chunk_length > session_size) {
+        send_nak("RANGE");
+        return;
+    }
+
+    if (ccd_data_layer_calculate_crc16(payload_buf, chunk_length) != chunk_crc) {
+        send_nak("CRC");
+        return;
+    }
+
+    if (session_target == UPLOAD_TARGET_RAM) {
+        memcpy(&ram_image[chunk_offset], payload_buf, chunk_length);
+    }
+    else if (!flash_program(session_record + 8 + chunk_offset, payload_buf, chunk_length)) {
+        // Part of the chunk may be programmed and flash cannot be rewritten
+        // without an erase, so a resend would fail too: give up the record
+        // (never committed, so skipped) and let the host open a new upload
+        char response[40];
+        Resp_Buffer_t r;
+        resp_init(&r, response, sizeof(response));
+        resp_kv_u32(&r, "ERROR:UPLOAD_FLASH", chunk_offset);
+        end_session();
+        usb_transport_write_string(resp_end(&r));
+        return;
+    }
+
+    session_received += chunk_length;
+    send_ack();
+}
+
+/**
+ * @brief Closing chunk: verify the stored image and commit it
+ */
+static void handle_close(uint16_t image_crc)
+{
+    char response[64];
+    Resp_Buffer_t r;
+
+    resp_init(&r, response, sizeof(response));
+    if (session_received != session_size) {
+        resp_str(&r, "ERROR:UPLOAD_INCOMPLETE:");
+        resp_u32(&r, session_received);
+        resp_char(&r, ',');
+        resp_u32(&r, session_size);
+        end_session();
+        usb_transport_write_string(resp_end(&r));
+        return;
+    }
+
+    // Verify what was actually stored, not what was received
+    const uint8_t *stored;
+    if (session_target == UPLOAD_TARGET_RAM) {
+        stored = ram_image;
+    } else {
+        stored = (const uint8_t*)(session_record + 8);
+    }
+
+    uint16_t stored_crc = ccd_data_layer_calculate_crc16(stored, session_size);
+
+    if (stored_crc != image_crc) {
+        resp_str(&r, "ERROR:UPLOAD_VERIFY:");
+        resp_hex16(&r, image_crc);
+        resp_char(&r, ',');
+        resp_hex16(&r, stored_crc);
+        end_session();
+        usb_transport_write_string(resp_end(&r));
+        return;
+    }
+
+    if (session_target == UPLOAD_TARGET_RAM) {
+        ram_image_type = session_type;
+        ram_image_size = session_size;
+        ram_image_crc = stored_crc;
+        ram_image_valid = true;
+    }
+    else {
+        uint32_t commit = UPLOAD_COMMIT_MAGIC | stored_crc;
+        if (!flash_program(session_record + 8 + PAD4(session_size),
+                           (const uint8_t*)&commit, sizeof(commit))) {
+            end_session();
+            usb_transport_write_string("ERROR:UPLOAD_FLASH\n");
+            return;
+        }
+    }
+
+    resp_str(&r, "OK:UPLOAD_COMMITTED:");
+    resp_str(&r, bulk_upload_type_name(session_type));
+    resp_str(&r, (session_target == UPLOAD_TARGET_RAM) ? ",RAM," : ",FLASH,");
+    resp_u32(&r, session_size);
+    resp_char(&r, ',');
+    resp_hex16(&r, stored_crc);
+    end_session();
+    usb_transport_write_string(resp_end(&r));
+}
+
+/**
+ * @brief Acknowledge the current chunk with the upload progress
+ */
+static void send_ack(void)
+{
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_kv_u32(&r, "UPLOAD_ACK", chunk_offset);
+    resp_char(&r, ',');
+    resp_u32(&r, session_received);
+    resp_char(&r, ',');
+    resp_u32(&r, session_size);
+    usb_transport_write_string(resp_end(&r));
+}
+
+/**
+ * @brief Reject the current chunk; the host resends from the expected offset
+ */
+static void send_nak(const char *reason)
+{
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_kv_u32(&r, "UPLOAD_NAK", chunk_offset);
+    resp_char(&r, ',');
+    resp_str(&r, reason);
+    resp_char(&r, ',');
+    resp_u32(&r, session_received);
+    usb_transport_write_string(resp_end(&r));
+}
+
+/**
+ * @brief Return the RX stream to the command parser
+ */
+static void end_session(void)
+{
+    state = UPLOAD_IDLE;
+    header_count = 0;
+    payload_count = 0;
+    skip_remaining = 0;
+}
+
+/* ============================================================================
+   Flash helpers
+   ============================================================================ */
+
+/**
+ * @brief Address of the first free record in the flash log
+ */
+static uint32_t flash_log_tail(void)
+{
+    uint32_t address = UPLOAD_FLASH_BASE;
+
+    while (address + UPLOAD_RECORD_OVERHEAD <= UPLOAD_FLASH_BASE + UPLOAD_FLASH_SIZE) {
+        uint32_t size = *(const volatile uint32_t*)address;
+        if (size == UPLOAD_ERASED_WORD) {
+            return address;
+        }
+        if (size > UPLOAD_FLASH_SIZE) {
+            break;  // Corrupt log - treat as full until erased
+        }
+        address += UPLOAD_RECORD_OVERHEAD + PAD4(size);
+    }
+
+    return UPLOAD_FLASH_BASE + UPLOAD_FLASH_SIZE;
+}
+
+/**
+ * @brief Program bytes into erased flash (words where aligned)
+ */
+static bool flash_program(uint32_t address, const uint8_t *data, uint32_t length)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+
+    HAL_FLASH_Unlock();
+
+    while (length > 0 && status == HAL_OK) {
+        if ((address & 3U) == 0 && length >= 4) {
+            uint32_t word;
+            memcpy(&word, data, 4);
+            status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, word);
+            address += 4;
+            data += 4;
+            length -= 4;
+        }
+        else {
+            status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, address, *data);
+            address++;
+            data++;
+            length--;
+        }
+    }
+
+    HAL_FLASH_Lock();
+    flash_flush_data_cache();
+
+    return (status == HAL_OK);
+}
+
+/**
+ * @brief Drop stale ART data cache lines after programming
+ */
+static void flash_flush_data_cache(void)
+{
+    __HAL_FLASH_DATA_CACHE_DISABLE();
+    __HAL_FLASH_DATA_CACHE_RESET();
+    __HAL_FLASH_DATA_CACHE_ENABLE();
+}
+
+/**
+ * @brief Image type as used in the UPLOAD command
+ */
+const char* bulk_upload_type_name(Upload_Type_t type)
+{
+    switch (type) {
+        case UPLOAD_TYPE_CAL:    return "CAL";
+        case UPLOAD_TYPE_DEFECT: return "DEFECT";
+        case UPLOAD_TYPE_SEQ:    return "SEQ";
+        default:                 return "?";
+    }
+}
@@ -12,23 +12,51 @@
   * 32-bit integers. When transmitted over USB, Python will see:
   * - b'FRME' at the start
   * - b'ENDF' at the end
+  * (b'FRMX' instead of b'FRME' for reduced-resolution frames)
   *
   ******************************************************************************
   */
 
 #include "ccd_data_layer.h"
+#include "hotpath.h"
 #include <string.h>
 
 /* Private variables */
 static uint16_t frame_counter = 0;
+static volatile uint32_t dropped_count = 0;
 static bool initialized = false;
 
+/* Bands: staged by the main loop, applied at the start of a readout */
+static volatile CCD_Band_t staged_bands[CCD_MAX_BANDS];
+static volatile uint8_t staged_band_count = 0;
+static volatile bool bands_staged = false;
+static volatile uint32_t staged_band_generation = 0;
+static CCD_Band_t bands[CCD_MAX_BANDS];
+static uint8_t band_count = 0;
+static uint32_t band_generation = 0;     // Set the current sums were taken with
+static CCD_Band_Sum_t band_sums[CCD_MAX_BANDS];
+
+/* Pixel resolution: staged by the main loop, latched per readout */
+static volatile uint8_t staged_bits = 12;
+static uint8_t frame_bits = 12;
+
+/* Encoding limit for streamed frames (ADAPT), set by the ADC callback */
+static uint8_t encode_limit = 12;
+static uint8_t encoded_bits = 12;
+
+/* Readout flags, set by the ADC callback before processing */
+static uint8_t frame_flags = 0;
+
+/* Readout callback timing (ADC callback entry to DMA restart) */
+static CCD_Cycle_Stats_t readout_cycles = {0};
+
 /* Frame marker definitions - these will be copied as ASCII bytes */
 static const uint8_t FRAME_START_MARKER[4] = {'F', 'R', 'M', 'E'};
 static const uint8_t FRAME_END_MARKER[4] = {'E', 'N', 'D', 'F'};
+static const uint8_t FRAMEX_START_MARKER[4] = {'F', 'R', 'M', 'X'};
 
 /* CRC16-CCITT Lookup Table (polynomial 0x1021) */
-static const uint16_t crc16_table[256] = {
+static HOTPATH_CONST uint16_t crc16_table[256] = {
     0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
     0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
     0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
@@ -66,7 +94,7 @@ static const uint16_t crc16_table[256] = {
 /**
  * @brief Calculate CRC16 checksum using lookup table
  */
-uint16_t ccd_data_layer_calculate_crc16(const uint8_t* data, uint32_t length)
+HOTPATH_FUNC uint16_t ccd_data_layer_calculate_crc16(const uint8_t* data, uint32_t length)
 {
     uint16_t crc = 0xFFFF;  // Initial value
 
@@ -78,6 +106,46 @@ uint16_t ccd_data_layer_calculate_crc16(const uint8_t* data, uint32_t length)
     return crc;
 }
 
+/**
+ * @brief Copy one readout's pixels and integrate bands
+ */
+HOTPATH_FUNC void ccd_data_layer_copy_pixels(const volatile uint16_t* adc_buffer, uint16_t* pixels,
+                                             const CCD_Band_t* band_list, uint8_t count,
+                                             uint16_t full_scale, CCD_Band_Sum_t* sums)
+{
+    // Manual copy to handle volatile correctly. Each pixel is a 16-bit value
+    // containing the ADC reading. Band pixels are summed on the way, so
+    // integration costs no extra pass. The sensor output drops with light,
+    // so the bands integrate full_scale - value: sums and centroids follow
+    // the light, not the dark pixels.
+    uint32_t i = 0;
+
+    for (uint8_t b = 0; b < count; b++) {
+        uint32_t band_end = (uint32_t)band_list[b].start + band_list[b].length;
+        uint32_t sum = 0;
+        uint64_t moment = 0;
+
+        for (; i < band_list[b].start; i++) {
+            pixels[i] = adc_buffer[i];
+        }
+        for (uint32_t k = 0; i < band_end; i++, k++) {
+            uint16_t value = adc_buffer[i];
+            uint32_t light = (value < full_scale) ? (uint32_t)(full_scale - value) : 0U;
+            pixels[i] = value;
+            sum += light;
+            moment += (uint64_t)k * light;
+        }
+
+        sums[b].start = band_list[b].start;
+        sums[b].sum = sum;
+        sums[b].moment = moment;
+    }
+
+    for (; i < CCD_PIXEL_COUNT; i++) {
+        pixels[i] = adc_buffer[i];
+    }
+}
+
 /**
  * @brief Initialize the CCD data layer
  */
@@ -94,8 +162,8 @@ CCD_Frame_Status_t ccd_data_layer_init(void)
  * CRITICAL FIX: This function now properly formats the frame with ASCII markers
  * that Python can easily find. The markers are literal byte sequences, not integers.
  */
-CCD_Frame_Status_t ccd_data_layer_process_readout(const volatile uint16_t* adc_buffer,
-                                                    CCD_Frame_t* frame_out)
+HOTPATH_FUNC CCD_Frame_Status_t ccd_data_layer_process_readout(const volatile uint16_t* adc_buffer,
+                                                                 CCD_Frame_t* frame_out)
 {
     if (!initialized) {
         return CCD_FRAME_ERROR_INVALID_DATA;
@@ -110,19 +178,34 @@ CCD_Frame_Status_t ccd_data_layer_process_readout(const volatile uint16_t* adc_b
     frame_out->frame_counter = frame_counter;
     frame_out->pixel_count = CCD_PIXEL_COUNT;
 
-    // Copy pixel data (manual copy to handle volatile correctly)
-    // Each pixel is a 16-bit value containing the 12-bit ADC reading
-    for (uint32_t i = 0; i < CCD_PIXEL_COUNT; i++) {
-        frame_out->pixel_data[i] = adc_buffer[i];
+    // Pick up a new band set between readouts
+    if (bands_staged) {
+        band_count = staged_band_count;
+        for (uint8_t b = 0; b < band_count; b++) {
+            bands[b].start = staged_bands[b].start;
+            bands[b].length = staged_bands[b].length;
+        }
+        band_generation = staged_band_generation;
+        bands_staged = false;
     }
+    frame_bits = staged_bits;
+    encoded_bits = (encode_limit < frame_bits) ? encode_limit : frame_bits;
+
+    // Copy pixel data, summing the bands on the way
+    uint16_t* pixels = (uint16_t*)((uint8_t*)frame_out + FRAME_HEADER_SIZE);
+    ccd_data_layer_copy_pixels(adc_buffer, pixels, bands, band_count,
+                               (uint16_t)((1U << frame_bits) - 1U), band_sums);
 
     // Fill frame footer with ASCII markers
     memcpy(frame_out->end_marker, FRAME_END_MARKER, 4);
 
     // Calculate checksum over everything except the checksum field itself
-    uint32_t checksum_length = FRAME_TOTAL_SIZE - sizeof(frame_out->checksum);
-    frame_out->checksum = ccd_data_layer_calculate_crc16((const uint8_t*)frame_out,
-                                                          checksum_length);
+    // (reduced-resolution frames get theirs in ccd_data_layer_encode_frame)
+    if (encoded_bits == 12) {
+        uint32_t checksum_length = FRAME_TOTAL_SIZE - sizeof(frame_out->checksum);
+        frame_out->checksum = ccd_data_layer_calculate_crc16((const uint8_t*)frame_out,
+                                                              checksum_length);
+    }
 
     // Increment frame counter (wraps at 65535)
     frame_counter++;
@@ -130,6 +213,217 @@ CCD_Frame_Status_t ccd_data_layer_process_readout(const volatile uint16_t* adc_b
     return CCD_FRAME_OK;
 }
 
+/**
+ * @brief Pack 12-bit pixels two-per-three-bytes
+ */
+void ccd_data_layer_pack12(const uint16_t* pixels, uint32_t count, uint8_t* packed)
+{
+    uint32_t i = 0;
+
+    for (; i + 1 < count; i += 2) {
+        uint16_t p0 = pixels[i] & 0x0FFF;
+        uint16_t p1 = pixels[i + 1] & 0x0FFF;
+        *packed++ = (uint8_t)p0;
+        *packed++ = (uint8_t)((p0 >> 8) | (p1 << 4));
+        *packed++ = (uint8_t)(p1 >> 4);
+    }
+
+    // Odd count: last pixel pairs with zero
+    if (i < count) {
+        uint16_t p0 = pixels[i] & 0x0FFF;
+        *packed++ = (uint8_t)p0;
+        *packed++ = (uint8_t)(p0 >> 8);
+        *packed++ = 0;
+    }
+}
+
+/**
+ * @brief Pack four 10-bit pixels into five bytes (LSB-first)
+ */
+static inline void pack10_group(uint16_t p0, uint16_t p1, uint16_t p2, uint16_t p3,
+                                uint8_t* out)
+{
+    p0 &= 0x03FF;
+    p1 &= 0x03FF;
+    p2 &= 0x03FF;
+    p3 &= 0x03FF;
+    out[0] = (uint8_t)p0;
+    out[1] = (uint8_t)((p0 >> 8) | (p1 << 2));
+    out[2] = (uint8_t)((p1 >> 6) | (p2 << 4));
+    out[3] = (uint8_t)((p2 >> 4) | (p3 << 6));
+    out[4] = (uint8_t)(p3 >> 2);
+}
+
+/**
+ * @brief Select the pixel resolution the frames are encoded for
+ */
+bool ccd_data_layer_set_resolution(uint8_t bits)
+{
+    if (bits != 12 && bits != 10 && bits != 8) {
+        return false;
+    }
+    staged_bits = bits;
+    return true;
+}
+
+/**
+ * @brief Resolution frames are encoded for
+ */
+uint8_t ccd_data_layer_get_resolution(void)
+{
+    return staged_bits;
+}
+
+/**
+ * @brief Resolution of the most recently processed readout
+ */
+uint8_t ccd_data_layer_get_frame_bits(void)
+{
+    return frame_bits;
+}
+
+/**
+ * @brief Limit the resolution the next readout is encoded at
+ */
+void ccd_data_layer_set_encode_limit(uint8_t bits)
+{
+    encode_limit = bits;
+}
+
+/**
+ * @brief Resolution the most recent readout was encoded at
+ */
+uint8_t ccd_data_layer_get_encoded_bits(void)
+{
+    return encoded_bits;
+}
+
+/**
+ * @brief Set the flags of the readout being processed
+ */
+void ccd_data_layer_set_frame_flags(uint8_t flags)
+{
+    frame_flags = flags;
+}
+
+/**
+ * @brief Flags of the most recently processed readout
+ */
+uint8_t ccd_data_layer_get_frame_flags(void)
+{
+    return frame_flags;
+}
+
+/**
+ * @brief Finish a processed frame for transmission
+ */
+HOTPATH_FUNC uint16_t ccd_data_layer_encode_frame(CCD_Frame_t* frame)
+{
+    return ccd_data_layer_encode_frame_bits(frame, encoded_bits,
+                                            (uint8_t)(frame_bits - encoded_bits), frame_flags);
+}
+
+/**
+ * @brief Encode a processed frame at a given resolution
+ *
+ * The FRMX payload starts 4 bytes later than the FRME pixels but each pixel
+ * shrinks to 1 or 1.25 bytes, so writing overtakes reading only within the
+ * first 8 pixels: those are read up front, the rest is compacted in place.
+ * A shift drops low bits on the way (12-bit readout sent as 10/8 bits).
+ */
+HOTPATH_FUNC uint16_t ccd_data_layer_encode_frame_bits(CCD_Frame_t* frame, uint8_t bits,
+                                                       uint8_t shift, uint8_t flags)
+{
+    if (bits == 12) {
+        return FRAME_TOTAL_SIZE;
+    }
+
+    uint8_t* base = (uint8_t*)frame;
+    const uint16_t* pixels = (const uint16_t*)(base + FRAME_HEADER_SIZE);
+    uint8_t* out = base + FRAMEX_HEADER_SIZE;
+    uint16_t first[8];
+    uint16_t payload;
+    uint32_t i;
+
+    for (i = 0; i < 8; i++) {
+        first[i] = (uint16_t)(pixels[i] >> shift);
+    }
+
+    if (bits == 8) {
+        for (i = 0; i < 8; i++) {
+            out[i] = (uint8_t)first[i];
+        }
+        for (; i < CCD_PIXEL_COUNT; i++) {
+            out[i] = (uint8_t)(pixels[i] >> shift);
+        }
+        payload = CCD_PIXEL_COUNT;
+    } else {
+        pack10_group(first[0], first[1], first[2], first[3], &out[0]);
+        pack10_group(first[4], first[5], first[6], first[7], &out[5]);
+        out += 10;
+        for (i = 8; i + 3 < CCD_PIXEL_COUNT; i += 4) {
+            pack10_group(pixels[i] >> shift, pixels[i + 1] >> shift,
+                         pixels[i + 2] >> shift, pixels[i + 3] >> shift, out);
+            out += 5;
+        }
+        // Tail: pad the last group with zeros
+        if (i < CCD_PIXEL_COUNT) {
+            uint16_t tail[4] = {0, 0, 0, 0};
+            for (uint32_t k = 0; i + k < CCD_PIXEL_COUNT; k++) {
+                tail[k] = (uint16_t)(pixels[i + k] >> shift);
+            }
+            pack10_group(tail[0], tail[1], tail[2], tail[3], out);
+        }
+        payload = CCD_PACKED10_SIZE(CCD_PIXEL_COUNT);
+    }
+
+    // Header last: its extra bytes overlay the first pixels
+    // (frame_counter and pixel_count stay where they are)
+    memcpy(base, FRAMEX_START_MARKER, 4);
+    base[8] = bits;
+    base[9] = flags;
+    memcpy(&base[10], &payload, 2);
+
+    uint32_t crc_length = FRAMEX_HEADER_SIZE + payload + 4;
+    memcpy(&base[FRAMEX_HEADER_SIZE + payload], FRAME_END_MARKER, 4);
+    uint16_t crc = ccd_data_layer_calculate_crc16(base, crc_length);
+    memcpy(&base[crc_length], &crc, 2);
+
+    return (uint16_t)FRAMEX_TOTAL_SIZE(payload);
+}
+
+/**
+ * @brief Set the bands integrated during the copy loop
+ */
+uint32_t ccd_data_layer_set_bands(const CCD_Band_t* new_bands, uint8_t count)
+{
+    if (count > CCD_MAX_BANDS) {
+        count = CCD_MAX_BANDS;
+    }
+
+    // Withdraw any unapplied set first so the ADC callback never sees a
+    // half-written table
+    bands_staged = false;
+    for (uint8_t b = 0; b < count; b++) {
+        staged_bands[b].start = new_bands[b].start;
+        staged_bands[b].length = new_bands[b].length;
+    }
+    staged_band_count = count;
+    staged_band_generation++;
+    bands_staged = true;
+    return staged_band_generation;
+}
+
+/**
+ * @brief Band sums of the most recent readout
+ */
+const CCD_Band_Sum_t* ccd_data_layer_get_band_sums(uint8_t* count, uint32_t* generation)
+{
+    *count = band_count;
+    *generation = band_generation;
+    return band_sums;
+}
+
 /**
  * @brief Get the current frame counter
  */
@@ -181,3 +475,62 @@ void ccd_data_layer_reset_counter(void)
 {
     frame_counter = 0;
 }
+
+/**
+ * @brief Count a readout that could not be delivered
+ */
+void ccd_data_layer_count_dropped(void)
+{
+    dropped_count++;
+}
+
+/**
+ * @brief Get the number of dropped readouts
+ */
+uint32_t ccd_data_layer_get_dropped_count(void)
+{
+    return dropped_count;
+}
+
+/**
+ * @brief Record the cycles one readout took in the ADC callback
+ */
+void ccd_data_layer_record_cycles(uint32_t cycles)
+{
+    if (readout_cycles.count == 0 || cycles < readout_cycles.min) {
+        readout_cycles.min = cycles;
+    }
+    if (cycles > readout_cycles.max) {
+        readout_cycles.max = cycles;
+    }
+    readout_cycles.last = cycles;
+    readout_cycles.sum += cycles;
+    readout_cycles.count++;
+}
+
+/**
+ * @brief Get the readout timing statistics
+ */
+void ccd_data_layer_get_cycle_stats(CCD_Cycle_Stats_t* stats)
+{
+    // The 64-bit sum is updated from the ADC callback: copy with it masked
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = readout_cycles;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Clear the readout timing statistics
+ */
+void ccd_data_layer_reset_cycle_stats(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    readout_cycles.count = 0;
+    readout_cycles.min = 0;
+    readout_cycles.max = 0;
+    readout_cycles.last = 0;
+    readout_cycles.sum = 0;
+    __set_PRIMASK(primask);
+}
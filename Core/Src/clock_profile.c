@@ -0,0 +1,176 @@
+/**
+ ******************************************************************************
+ * @file    clock_profile.c
+ * @brief   Master clock profile implementation
+ ******************************************************************************
+ */
+
+#include "clock_profile.h"
+#include "main.h"
+#include <string.h>
+
+/* Timer / ADC handles (main.c) */
+extern TIM_HandleTypeDef htim2;
+extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim4;
+extern TIM_HandleTypeDef htim5;
+extern ADC_HandleTypeDef hadc1;
+
+#define ICG_SH_DELAY_COUNTS  66     // TIM2 start offset, as in main()
+#define TIMER_COUNTS_PER_US  84     // Timers run at 84 MHz, prescaler 0
+#define SH_PULSE_COUNTS      336    // SH high for 4 us, as in MX_TIM5_Init()
+#define SH_PERIOD_BOOT       1680   // TIM5 ARR + 1 at boot (20 us)
+
+static const Clock_Profile_Config_t profiles[CLOCK_PROFILE_COUNT] = {
+    [CLOCK_PROFILE_2MHZ] = {
+        .name = "2MHZ",
+        .fm_hz = 2000000,
+        .fm_period = 42,
+        .adc_period = 168,
+        .adc_pulse = 42,
+        .icg_min_period = 630000,
+        .adc_sampling_time = ADC_SAMPLETIME_3CYCLES,
+        .readout_us = 7388
+    },
+    [CLOCK_PROFILE_4MHZ] = {
+        .name = "4MHZ",
+        .fm_hz = 4000000,
+        .fm_period = 21,
+        .adc_period = 84,
+        .adc_pulse = 21,
+        .icg_min_period = 315000,
+        .adc_sampling_time = ADC_SAMPLETIME_3CYCLES,
+        .readout_us = 3694
+    }
+};
+
+static Clock_Profile_t current_profile = CLOCK_PROFILE_2MHZ;
+static uint32_t sh_period = SH_PERIOD_BOOT;
+static uint32_t icg_period = 630000;       // TIM2 ARR + 1 at boot (375 SH periods)
+
+/**
+ * @brief Shortest ICG period that holds the readout and is whole SH periods
+ * @note The TCD1304 needs SH in the same phase at every ICG pulse; an ICG
+ *       period that is not a multiple of the SH period walks SH across it
+ */
+static uint32_t icg_period_for(const Clock_Profile_Config_t* cfg, uint32_t sh)
+{
+    return ((cfg->icg_min_period + sh - 1) / sh) * sh;
+}
+
+/**
+ * @brief Program TIM2/3/4/5 and the ADC channel, restart the timers in boot order
+ */
+static void apply_timing(Clock_Profile_t profile, uint32_t sh)
+{
+    const Clock_Profile_Config_t* cfg = &profiles[profile];
+    uint32_t icg = icg_period_for(cfg, sh);
+    ADC_ChannelConfTypeDef sConfig = {0};
+    sConfig.Channel = ADC_CHANNEL_3;
+    sConfig.Rank = 1;
+    sConfig.SamplingTime = cfg->adc_sampling_time;
+
+    // Masked throughout: the ADC callback restarts the DMA, and
+    // HAL_ADC_Start_DMA fails while ConfigChannel holds the ADC lock
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    HAL_TIM_PWM_Stop(&htim5, TIM_CHANNEL_3);
+    HAL_TIM_PWM_Stop(&htim2, TIM_CHANNEL_1);
+    HAL_TIM_PWM_Stop(&htim4, TIM_CHANNEL_4);
+    HAL_TIM_PWM_Stop(&htim3, TIM_CHANNEL_1);
+
+    // No conversions are triggered while TIM4 is stopped
+    HAL_ADC_ConfigChannel(&hadc1, &sConfig);
+
+    __HAL_TIM_SET_AUTORELOAD(&htim3, cfg->fm_period - 1);
+    __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, cfg->fm_period / 2 - 1);
+    __HAL_TIM_SET_AUTORELOAD(&htim4, cfg->adc_period - 1);
+    __HAL_TIM_SET_COMPARE(&htim4, TIM_CHANNEL_4, cfg->adc_pulse - 1);
+    __HAL_TIM_SET_AUTORELOAD(&htim2, icg - 1);
+    __HAL_TIM_SET_AUTORELOAD(&htim5, sh - 1);
+    __HAL_TIM_SET_COMPARE(&htim5, TIM_CHANNEL_3, SH_PULSE_COUNTS - 1);
+
+    __HAL_TIM_SET_COUNTER(&htim3, 0);
+    __HAL_TIM_SET_COUNTER(&htim4, 0);
+    __HAL_TIM_SET_COUNTER(&htim5, 0);
+
+    // Same start order and ICG-SH offset as at boot
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+    HAL_TIM_PWM_Start(&htim4, TIM_CHANNEL_4);
+    HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
+    __HAL_TIM_SET_COUNTER(&htim2, ICG_SH_DELAY_COUNTS);
+    HAL_TIM_PWM_Start(&htim5, TIM_CHANNEL_3);
+
+    current_profile = profile;
+    sh_period = sh;
+    icg_period = icg;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Switch to another master clock profile
+ */
+bool clock_profile_set(Clock_Profile_t profile)
+{
+    if (profile >= CLOCK_PROFILE_COUNT) {
+        return false;
+    }
+
+    apply_timing(profile, sh_period);
+    return true;
+}
+
+/**
+ * @brief Set the SH period (integration time) within the current profile
+ */
+bool clock_profile_set_integration_us(uint32_t microseconds)
+{
+    uint32_t sh = microseconds * TIMER_COUNTS_PER_US;
+
+    if (sh <= SH_PULSE_COUNTS) {
+        return false;
+    }
+
+    apply_timing(current_profile, sh);
+    return true;
+}
+
+/**
+ * @brief ICG period in use, in microseconds
+ */
+uint32_t clock_profile_get_icg_us(void)
+{
+    return icg_period / TIMER_COUNTS_PER_US;
+}
+
+/**
+ * @brief Profile in use
+ */
+Clock_Profile_t clock_profile_get(void)
+{
+    return current_profile;
+}
+
+/**
+ * @brief Settings of the profile in use
+ */
+const Clock_Profile_Config_t* clock_profile_get_config(void)
+{
+    return &profiles[current_profile];
+}
+
+/**
+ * @brief Look up a profile by name
+ */
+bool clock_profile_from_name(const char* name, Clock_Profile_t* profile)
+{
+    for (uint32_t i = 0; i < CLOCK_PROFILE_COUNT; i++) {
+        if (strcmp(name, profiles[i].name) == 0) {
+            *profile = (Clock_Profile_t)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -12,20 +12,76 @@
   * - START              : Begin transmitting frames
   * - STOP               : Stop transmitting frames
   * - STATUS             : Query current state
+  * - STATS              : Query transport counters and RAM high-water marks
+  * - STATS_RESET        : Repaint the stack and clear the high-water marks
   * - SET_INT_TIME:xxx   : Set integration time (stub for future)
+  * - CLOCK:2MHZ|4MHZ    : Select the master clock profile (readout 7.4 / 3.7 ms)
+  * - ADC_BITS:12|10|8   : ADC resolution; 10/8 bits send compact FRMX frames
+  * - PATTERN:p[,v]      : Synthetic pixel data (OFF|RAMP|CONST|PRBS|COUNTER)
+  * - SETTLE:n[,mode]    : Settling readouts after a change (mode DROP|FLAG)
+  * - USB_TPUT:n[,chunk] : Stream n test bytes on the data IN EP, report rate
+  * - SOURCE:n[,chunk]   : Same as USB_TPUT (IN half of the link tests)
+  * - LOOPBACK:n         : Echo the next n received bytes back, report rate
+  * - SINK:n             : Discard the next n received bytes, report rate
+  * - USB_PROFILE:p      : Select OTG FIFO profile p and re-enumerate
+  * - UPLOAD:t,n[,dest]  : Receive an n-byte image of type t in binary chunks
+  * - UPLOAD_INFO:t      : Report the newest committed image of type t
+  * - UPLOAD_ERASE       : Erase the flash image store
+  * - PRETRIG:k,m[,s,n]  : Keep the last k readouts (pixels s..s+n-1), dump
+  *                        them plus m post-trigger readouts on a trigger
+  * - PRETRIG_OFF        : Disarm the pre-trigger ring
+  * - TRIGGER            : Software trigger
+  * - SNAP               : Send the next complete readout with trigger timing
+  * - SNAP:GPIO          : Same, triggered by the next trigger input edge
+  * - SNAP:CANCEL        : Cancel an armed SNAP
+  * - GETFRAME           : Send the most recent complete readout now, with its age
+  * - BANDS:s,n[,s,n...] : Stream band sums/centroids for up to 8 pixel bands
+  * - BANDS_OFF          : Back to full frames for every readout
+  * - BAND_FRAMES:n      : Full frame every nth readout while bands are on
+  * - FMT_BENCH          : Time the response formatter (and snprintf if built in)
+  * - BENCH              : Cycles per call of the readout kernels (copy, CRC, packing)
+  * - PERF               : Cycles per readout in the ADC callback, ART state
+  * - PERF_RESET         : Clear the readout timing
+  * - ART:ON / ART:OFF   : Enable / disable the flash ART accelerator
+  * - TRACE:ON / TRACE:OFF : Stage timestamp packet after every streamed frame
+  * - MARK:id            : Marker packet with id before the next streamed readout
+  * - MARK:CANCEL        : Drop a mark that has not been sent yet
+  * - ADAPT:ON / ADAPT:OFF : Step streamed frames to 10/8 bits while USB falls behind
+  * - SYNC:n             : Echo n (host drains older replies up to OK:SYNC:n)
   *
   ******************************************************************************
   */
 
 #include "command_layer.h"
 #include "usb_transport.h"
+#include "bulk_upload.h"
+#include "pretrigger.h"
+#include "snap.h"
+#include "band_integrator.h"
+#include "ram_monitor.h"
+#include "usbd_conf.h"
+#include "resp_format.h"
+#include "cycle_counter.h"
+#include "hotpath.h"
+#include "clock_profile.h"
+#include "test_pattern.h"
+#include "link_test.h"
+#include "latest_frame.h"
+#include "trace.h"
+#include "kernel_bench.h"
+#include "settle.h"
+#include "mark.h"
+#include "adaptive_format.h"
 #include <string.h>
 #include <stdlib.h>
+#ifdef RESP_FORMAT_BENCH_SNPRINTF
 #include <stdio.h>
+#endif
 #include "main.h"  // For htim5 access for variable int time
 
 /* External timer handle from main.c */
 extern TIM_HandleTypeDef htim5;  // ← ADD THIS LINE
+extern ADC_HandleTypeDef hadc1;  // ADC resolution (ADC_BITS)
 
 /* Private variables */
 static Acquisition_State_t acquisition_state = ACQ_STATE_IDLE;
@@ -36,6 +92,9 @@ static uint8_t command_index = 0;
 /* Private function prototypes */
 static void parse_and_execute_command(const char* cmd);
 static void send_response(const char* response);
+static void report_throughput_result(void);
+static bool parse_upload_type(const char* name, Upload_Type_t* type);
+static bool parse_u32(const char* text, int base, uint32_t* value);
 
 /**
  * @brief Initialize the command layer
@@ -62,6 +121,21 @@ Command_Status_t command_layer_init(void)
  */
 void command_layer_process(void)
 {
+    // Report a finished USB throughput test
+    report_throughput_result();
+
+    // A binary upload owns the RX stream until its closing chunk
+    if (bulk_upload_is_active()) {
+        bulk_upload_process();
+        return;
+    }
+
+    // So does a loopback / sink test until its last byte
+    if (link_test_is_active()) {
+        link_test_process();
+        return;
+    }
+
     // Read available bytes from RX ring buffer
     while (usb_transport_available()) {
         uint8_t byte;
@@ -77,6 +151,12 @@ void command_layer_process(void)
                 command_buffer[command_index] = '\0';
                 parse_and_execute_command(command_buffer);
                 command_index = 0;
+
+                // Bytes after an UPLOAD command are chunk data, bytes
+                // after LOOPBACK / SINK belong to the link test
+                if (bulk_upload_is_active() || link_test_is_active()) {
+                    break;
+                }
             }
         }
         else if (command_index < (CMD_BUFFER_SIZE - 1)) {
@@ -117,6 +197,13 @@ static void parse_and_execute_command(const char* cmd)
     else if (strcmp(clean_cmd, "STATUS") == 0) {
         command_handle_get_status();
     }
+    else if (strcmp(clean_cmd, "STATS") == 0) {
+        command_handle_get_stats();
+    }
+    else if (strcmp(clean_cmd, "STATS_RESET") == 0) {
+        ram_monitor_reset();
+        send_response("OK:STATS_RESET\n");
+    }
     else if (strncmp(clean_cmd, "SET_INT_TIME:", 13) == 0) {
         // Extract parameter
         const char* param_str = &clean_cmd[13];
@@ -132,12 +219,246 @@ static void parse_and_execute_command(const char* cmd)
             send_response("ERROR:INVALID_PARAM\n");
         }
     }
+    else if (strncmp(clean_cmd, "CLOCK:", 6) == 0) {
+        if (command_handle_clock(&clean_cmd[6]) == CMD_ERROR_INVALID_PARAM) {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strncmp(clean_cmd, "ADC_BITS:", 9) == 0) {
+        uint32_t bits;
+        if (!parse_u32(&clean_cmd[9], 10, &bits) ||
+            command_handle_adc_bits(bits) == CMD_ERROR_INVALID_PARAM) {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strncmp(clean_cmd, "SETTLE:", 7) == 0) {
+        if (command_handle_settle(&clean_cmd[7]) == CMD_ERROR_INVALID_PARAM) {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strncmp(clean_cmd, "MARK:", 5) == 0) {
+        command_handle_mark(&clean_cmd[5]);
+    }
+    else if (strncmp(clean_cmd, "PATTERN:", 8) == 0) {
+        if (command_handle_pattern(&clean_cmd[8]) == CMD_ERROR_INVALID_PARAM) {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strncmp(clean_cmd, "USB_TPUT:", 9) == 0 || strncmp(clean_cmd, "SOURCE:", 7) == 0) {
+        // USB_TPUT:<bytes>[,<chunk>] - chunk defaults to one frame-sized transfer
+        const char* params = (clean_cmd[0] == 'U') ? &clean_cmd[9] : &clean_cmd[7];
+        char* param_end;
+        uint32_t total = (uint32_t)strtoul(params, &param_end, 10);
+        uint32_t chunk = USB_TPUT_MAX_CHUNK;
+        if (*param_end == ',') {
+            chunk = (uint32_t)strtoul(param_end + 1, NULL, 10);
+        }
+
+        if (command_handle_usb_throughput(total, chunk) == CMD_ERROR_INVALID_PARAM) {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strncmp(clean_cmd, "LOOPBACK:", 9) == 0 || strncmp(clean_cmd, "SINK:", 5) == 0) {
+        bool loopback = (clean_cmd[0] == 'L');
+        uint32_t bytes;
+        if (parse_u32(loopback ? &clean_cmd[9] : &clean_cmd[5], 10, &bytes)) {
+            command_handle_link_test(loopback ? LINK_TEST_LOOPBACK : LINK_TEST_SINK, bytes);
+        } else {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strncmp(clean_cmd, "USB_PROFILE:", 12) == 0) {
+        uint32_t profile;
+        if (parse_u32(&clean_cmd[12], 10, &profile)) {
+            command_handle_usb_profile(profile);
+        } else {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strncmp(clean_cmd, "UPLOAD:", 7) == 0) {
+        command_handle_upload(&clean_cmd[7]);
+    }
+    else if (strncmp(clean_cmd, "UPLOAD_INFO:", 12) == 0) {
+        command_handle_upload_info(&clean_cmd[12]);
+    }
+    else if (strcmp(clean_cmd, "UPLOAD_ERASE") == 0) {
+        command_handle_upload_erase();
+    }
+    else if (strncmp(clean_cmd, "PRETRIG:", 8) == 0) {
+        // PRETRIG:<pre>,<post>[,<roi_start>,<roi_length>] - ROI defaults to the full readout
+        uint32_t values[4] = {0, 0, 0, CCD_PIXEL_COUNT};
+        const char* p = &clean_cmd[8];
+        char* param_end;
+        int count = 0;
+
+        while (count < 4) {
+            values[count++] = (uint32_t)strtoul(p, &param_end, 10);
+            if (*param_end != ',') {
+                break;
+            }
+            p = param_end + 1;
+        }
+
+        if ((count == 2 || count == 4) && *param_end == '\0') {
+            command_handle_pretrig(values[0], values[1], values[2], values[3]);
+        } else {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strcmp(clean_cmd, "PRETRIG_OFF") == 0) {
+        pretrig_disarm();
+        send_response("OK:PRETRIG_OFF\n");
+    }
+    else if (strcmp(clean_cmd, "TRIGGER") == 0) {
+        command_handle_trigger();
+    }
+    else if (strcmp(clean_cmd, "SNAP") == 0) {
+        command_handle_snap(false);
+    }
+    else if (strcmp(clean_cmd, "SNAP:GPIO") == 0) {
+        command_handle_snap(true);
+    }
+    else if (strcmp(clean_cmd, "SNAP:CANCEL") == 0) {
+        snap_cancel();
+        send_response("OK:SNAP_CANCELLED\n");
+    }
+    else if (strcmp(clean_cmd, "GETFRAME") == 0) {
+        command_handle_getframe();
+    }
+    else if (strncmp(clean_cmd, "BANDS:", 6) == 0) {
+        command_handle_bands(&clean_cmd[6]);
+    }
+    else if (strcmp(clean_cmd, "BANDS_OFF") == 0) {
+        band_integrator_disable();
+        send_response("OK:BANDS_OFF\n");
+    }
+    else if (strncmp(clean_cmd, "BAND_FRAMES:", 12) == 0) {
+        uint32_t divider;
+        if (parse_u32(&clean_cmd[12], 10, &divider)) {
+            command_handle_band_frames(divider);
+        } else {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
+    else if (strcmp(clean_cmd, "FMT_BENCH") == 0) {
+        command_handle_fmt_bench();
+    }
+    else if (strcmp(clean_cmd, "BENCH") == 0) {
+        command_handle_bench();
+    }
+    else if (strcmp(clean_cmd, "PERF") == 0) {
+        command_handle_perf();
+    }
+    else if (strcmp(clean_cmd, "PERF_RESET") == 0) {
+        ccd_data_layer_reset_cycle_stats();
+        send_response("OK:PERF_RESET\n");
+    }
+    else if (strcmp(clean_cmd, "ART:ON") == 0) {
+        hotpath_art_config(true);
+        ccd_data_layer_reset_cycle_stats();
+        send_response("OK:ART:ON\n");
+    }
+    else if (strcmp(clean_cmd, "ART:OFF") == 0) {
+        hotpath_art_config(false);
+        ccd_data_layer_reset_cycle_stats();
+        send_response("OK:ART:OFF\n");
+    }
+    else if (strcmp(clean_cmd, "TRACE:ON") == 0) {
+        trace_set_enabled(true);
+        send_response("OK:TRACE:ON\n");
+    }
+    else if (strcmp(clean_cmd, "TRACE:OFF") == 0) {
+        trace_set_enabled(false);
+        send_response("OK:TRACE:OFF\n");
+    }
+    else if (strcmp(clean_cmd, "ADAPT:ON") == 0) {
+        adaptive_format_set_enabled(true);
+        send_response("OK:ADAPT:ON\n");
+    }
+    else if (strcmp(clean_cmd, "ADAPT:OFF") == 0) {
+        adaptive_format_set_enabled(false);
+        send_response("OK:ADAPT:OFF\n");
+    }
+    else if (strncmp(clean_cmd, "SYNC:", 5) == 0) {
+        uint32_t token;
+        if (parse_u32(&clean_cmd[5], 10, &token)) {
+            char response[32];
+            Resp_Buffer_t r;
+            resp_init(&r, response, sizeof(response));
+            resp_str(&r, "OK:SYNC:");
+            resp_u32(&r, token);
+            send_response(resp_end(&r));
+        } else {
+            send_response("ERROR:INVALID_PARAM\n");
+        }
+    }
     else {
         // Unknown command
         char response[64];
-        snprintf(response, sizeof(response), "ERROR:UNKNOWN_CMD:%s\n", clean_cmd);
-        send_response(response);
+        Resp_Buffer_t r;
+        resp_init(&r, response, sizeof(response));
+        resp_str(&r, "ERROR:UNKNOWN_CMD:");
+        resp_str(&r, clean_cmd);
+        send_response(resp_end(&r));
+    }
+}
+
+/**
+ * @brief Send the result of a completed USB throughput test, if any
+ */
+static void report_throughput_result(void)
+{
+    usb_throughput_result_t result;
+
+    if (!usb_transport_throughput_get_result(&result)) {
+        return;
+    }
+
+    char response[192];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "USB_TPUT:");
+    resp_kv_u32(&r, "PROFILE", result.fifo_profile);
+    resp_kv_u32(&r, "BYTES", result.bytes);
+    resp_kv_u32(&r, "CHUNK", result.chunk);
+    resp_kv_u32(&r, "XFERS", result.transfers);
+    resp_kv_u32(&r, "US", result.elapsed_us);
+    resp_kv_u32(&r, "BPS", result.bytes_per_sec);
+    resp_kv_u32(&r, "XFER_MIN_US", result.xfer_min_us);
+    resp_kv_u32(&r, "XFER_MAX_US", result.xfer_max_us);
+    resp_kv_u32(&r, "GAP_MIN_US", result.gap_min_us);
+    resp_kv_u32(&r, "GAP_MAX_US", result.gap_max_us);
+    resp_kv_u32(&r, "GAP_AVG_US", result.gap_avg_us);
+    send_response(resp_end(&r));
+}
+
+/**
+ * @brief Map an upload type name to its code
+ */
+static bool parse_upload_type(const char* name, Upload_Type_t* type)
+{
+    for (Upload_Type_t t = UPLOAD_TYPE_CAL; t <= UPLOAD_TYPE_SEQ; t++) {
+        if (strcmp(name, bulk_upload_type_name(t)) == 0) {
+            *type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Parse a whole argument as an unsigned number
+ * @return false if it is empty, not a number or followed by anything
+ */
+static bool parse_u32(const char* text, int base, uint32_t* value)
+{
+    char* end;
+
+    if (text[0] < '0' || text[0] > '9') {
+        return false;       // strtoul would skip spaces and accept a sign
     }
+    *value = (uint32_t)strtoul(text, &end, base);
+    return (*end == '\0');
 }
 
 /**
@@ -181,6 +502,12 @@ uint32_t command_layer_get_integration_time(void)
  */
 void command_handle_start(void)
 {
+    // Frames and pre-trigger dumps share the data IN endpoint
+    if (pretrig_get_state() != PRETRIG_STATE_IDLE) {
+        send_response("ERROR:PRETRIG_ACTIVE\n");
+        return;
+    }
+
     acquisition_state = ACQ_STATE_RUNNING;
     send_response("OK:STARTED\n");
 }
@@ -217,49 +544,823 @@ Command_Status_t command_handle_set_integration_time(uint32_t microseconds)
         return CMD_ERROR_INVALID_PARAM;
     }
 
-    // Stop TIM5 (SH)
-    HAL_TIM_PWM_Stop(&htim5, TIM_CHANNEL_3);
+    // TIM5 (SH) and TIM2 (ICG) together: the ICG period is re-derived as
+    // a whole number of SH periods and both restart in the boot phase
+    if (!clock_profile_set_integration_us(microseconds)) {
+        send_response("ERROR:RANGE_10_TO_100000\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
 
-    // Calculate new ARR: (84MHz × integration_time_us) / 1MHz - 1
-    uint32_t arr_value = (84 * microseconds) - 1;
+    // Update stored value
+    integration_time_us = microseconds;
+    settle_mark_change();
 
-    // CCR stays constant at 4µs = 336 clocks
-    uint32_t ccr_value = 335;
+    // Send success response
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "INT_TIME_SET", microseconds);
+    resp_kv_u32(&r, "ICG_US", clock_profile_get_icg_us());
+    send_response(resp_end(&r));
 
-    // Update TIM5 registers
-    __HAL_TIM_SET_AUTORELOAD(&htim5, arr_value);
-    __HAL_TIM_SET_COMPARE(&htim5, TIM_CHANNEL_3, ccr_value);
+    return CMD_OK;
+}
 
-    // Reset counter for clean start
-    __HAL_TIM_SET_COUNTER(&htim5, 0);
+/**
+ * @brief Select the CCD master clock profile
+ */
+Command_Status_t command_handle_clock(const char* name)
+{
+    Clock_Profile_t profile;
 
-    // Restart TIM5
-    HAL_TIM_PWM_Start(&htim5, TIM_CHANNEL_3);
+    // Timers are restarted: never in the middle of a stream
+    if (acquisition_state == ACQ_STATE_RUNNING) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
 
-    // Update stored value
-    integration_time_us = microseconds;
+    if (!clock_profile_from_name(name, &profile) || !clock_profile_set(profile)) {
+        return CMD_ERROR_INVALID_PARAM;
+    }
+    settle_mark_change();
 
-    // Send success response
+    const Clock_Profile_Config_t* cfg = clock_profile_get_config();
     char response[64];
-    snprintf(response, sizeof(response), "OK:INT_TIME_SET:%lu\n",
-             (unsigned long)microseconds);
-    send_response(response);
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_str(&r, "CLOCK", cfg->name);
+    resp_kv_u32(&r, "FM_HZ", cfg->fm_hz);
+    resp_kv_u32(&r, "READOUT_US", cfg->readout_us);
+    resp_kv_u32(&r, "ICG_US", clock_profile_get_icg_us());
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Select the ADC resolution and frame encoding
+ */
+Command_Status_t command_handle_adc_bits(uint32_t bits)
+{
+    uint32_t resolution;
+    uint32_t frame_bytes;
+
+    if (acquisition_state == ACQ_STATE_RUNNING) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    switch (bits) {
+        case 12:
+            resolution = ADC_RESOLUTION_12B;
+            frame_bytes = FRAME_TOTAL_SIZE;
+            break;
+        case 10:
+            resolution = ADC_RESOLUTION_10B;
+            frame_bytes = FRAMEX_TOTAL_SIZE(CCD_PACKED10_SIZE(CCD_PIXEL_COUNT));
+            break;
+        case 8:
+            resolution = ADC_RESOLUTION_8B;
+            frame_bytes = FRAMEX_TOTAL_SIZE(CCD_PIXEL_COUNT);
+            break;
+        default:
+            return CMD_ERROR_INVALID_PARAM;
+    }
+
+    // Conversion time drops from 15 to 13 / 11 ADC clocks; the pixel rate
+    // is still set by TIM4. RES may change between conversions, and the
+    // readout in progress is mixed-resolution either way.
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    MODIFY_REG(hadc1.Instance->CR1, ADC_CR1_RES, resolution);
+    hadc1.Init.Resolution = resolution;
+    ccd_data_layer_set_resolution((uint8_t)bits);
+    __set_PRIMASK(primask);
+    settle_mark_change();
+
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "ADC_BITS", bits);
+    resp_kv_u32(&r, "FRAME_BYTES", frame_bytes);
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Configure settling readout handling
+ */
+Command_Status_t command_handle_settle(const char* params)
+{
+    char* param_end;
+    uint32_t frames = (uint32_t)strtoul(params, &param_end, 10);
+    Settle_Mode_t mode = settle_get_mode();
+
+    if (param_end == params) {
+        return CMD_ERROR_INVALID_PARAM;
+    }
+    if (*param_end == ',') {
+        if (strcmp(param_end + 1, "DROP") == 0) {
+            mode = SETTLE_MODE_DROP;
+        } else if (strcmp(param_end + 1, "FLAG") == 0) {
+            mode = SETTLE_MODE_FLAG;
+        } else {
+            return CMD_ERROR_INVALID_PARAM;
+        }
+    } else if (*param_end != '\0') {
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    // Every frame is FRME (no flags field) at 12 bits without ADAPT
+    if (mode == SETTLE_MODE_FLAG && ccd_data_layer_get_resolution() == 12 &&
+        !adaptive_format_is_enabled()) {
+        send_response("ERROR:SETTLE_FLAG_NEEDS_FRMX\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    if (frames > SETTLE_MAX_FRAMES || !settle_configure((uint8_t)frames, mode)) {
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "SETTLE", frames);
+    resp_kv_str(&r, "MODE", (mode == SETTLE_MODE_FLAG) ? "FLAG" : "DROP");
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Tag the stream at the next frame boundary
+ */
+Command_Status_t command_handle_mark(const char* params)
+{
+    if (strcmp(params, "CANCEL") == 0) {
+        mark_cancel();
+        send_response("OK:MARK_CANCELLED\n");
+        return CMD_OK;
+    }
+
+    char* param_end;
+    uint32_t id = (uint32_t)strtoul(params, &param_end, 10);
+    if (param_end == params || *param_end != '\0') {
+        send_response("ERROR:INVALID_PARAM\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    if (!mark_request(id)) {
+        send_response("ERROR:MARK_PENDING\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    char response[32];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "MARK", id);
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Replace the readout data with a test pattern
+ */
+Command_Status_t command_handle_pattern(const char* params)
+{
+    char name[12];
+    uint32_t value = TEST_PATTERN_CONST_DEFAULT;
+    uint32_t n = 0;
+    Test_Pattern_t pattern;
+
+    while (params[n] != '\0' && params[n] != ',' && n < sizeof(name) - 1) {
+        name[n] = params[n];
+        n++;
+    }
+    name[n] = '\0';
+
+    if (params[n] == ',') {
+        if (!parse_u32(&params[n + 1], 0, &value)) {
+            return CMD_ERROR_INVALID_PARAM;
+        }
+    } else if (params[n] != '\0') {
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    if (!test_pattern_from_name(name, &pattern) || value > 0x0FFF) {
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    test_pattern_set(pattern, (uint16_t)value);
+
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_str(&r, "PATTERN", test_pattern_name(pattern));
+    if (pattern == TEST_PATTERN_CONST) {
+        resp_kv_u32(&r, "VALUE", value);
+    }
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Start a device-side USB throughput test
+ */
+Command_Status_t command_handle_usb_throughput(uint32_t total_bytes, uint32_t chunk)
+{
+    // Frames and test data share the data IN endpoint
+    if (acquisition_state == ACQ_STATE_RUNNING) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    if (chunk == 0 || chunk > USB_TPUT_MAX_CHUNK ||
+        !usb_transport_throughput_start(total_bytes, (uint16_t)chunk)) {
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "USB_TPUT", total_bytes);
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Start a loopback or sink link test
+ */
+Command_Status_t command_handle_link_test(uint8_t mode, uint32_t bytes)
+{
+    // Echo data and frames would share the data IN endpoint
+    if (acquisition_state == ACQ_STATE_RUNNING) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    // The echo buffers are borrowed from the pre-trigger pool
+    if (mode == LINK_TEST_LOOPBACK && pretrig_get_state() != PRETRIG_STATE_IDLE) {
+        send_response("ERROR:PRETRIG_ACTIVE\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    if (!link_test_start((Link_Test_Mode_t)mode, bytes)) {
+        send_response("ERROR:INVALID_PARAM\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, (mode == LINK_TEST_LOOPBACK) ? "LOOPBACK" : "SINK", bytes);
+    send_response(resp_end(&r));
 
     return CMD_OK;
 }
+
+/**
+ * @brief Select an OTG FIFO profile (device re-enumerates afterwards)
+ */
+Command_Status_t command_handle_usb_profile(uint32_t profile)
+{
+    if (acquisition_state == ACQ_STATE_RUNNING) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    if (profile > UINT8_MAX || !usb_transport_set_fifo_profile((uint8_t)profile)) {
+        send_response("ERROR:INVALID_PARAM\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    char response[32];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "USB_PROFILE", profile);
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
 /**
  * @brief Send status information
  */
 void command_handle_get_status(void)
 {
-    char response[128];
+    char response[224];
+    Resp_Buffer_t r;
 
     const char* state_str = (acquisition_state == ACQ_STATE_RUNNING) ? "RUNNING" : "IDLE";
+    static const char* const pretrig_str[] = {"IDLE", "ARMED", "POST", "DUMP"};
+
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "STATUS:");
+    resp_str(&r, state_str);
+    resp_kv_u32(&r, "INT_TIME", integration_time_us);
+    resp_kv_str(&r, "CLOCK", clock_profile_get_config()->name);
+    resp_kv_u32(&r, "ADC_BITS", ccd_data_layer_get_resolution());
+    resp_kv_str(&r, "PATTERN", test_pattern_name(test_pattern_get()));
+    resp_kv_u32(&r, "SETTLE", settle_get_frames());
+    resp_kv_str(&r, "SETTLE_MODE", (settle_get_mode() == SETTLE_MODE_FLAG) ? "FLAG" : "DROP");
+    resp_kv_u32(&r, "USB_PROFILE", usb_transport_get_fifo_profile());
+    resp_kv_str(&r, "PRETRIG", pretrig_str[pretrig_get_state()]);
+    resp_kv_u32(&r, "BANDS", band_integrator_get_count());
+    resp_kv_u32(&r, "BAND_FRAMES", band_integrator_get_frame_divider());
+    resp_kv_str(&r, "TRACE", trace_is_enabled() ? "ON" : "OFF");
+    resp_kv_u32(&r, "MARK_PENDING", mark_is_pending() ? 1 : 0);
+    resp_kv_str(&r, "ADAPT", adaptive_format_is_enabled() ? "ON" : "OFF");
+    resp_kv_u32(&r, "ADAPT_BITS", adaptive_format_get_bits());
+
+    send_response(resp_end(&r));
+}
+
+/**
+ * @brief Send transport statistics
+ */
+void command_handle_get_stats(void)
+{
+    char response[512];
+    Resp_Buffer_t r;
+    usb_transport_stats_t usb_stats;
+    ram_monitor_stats_t ram;
+
+    usb_transport_get_stats(&usb_stats);
+    ram_monitor_get_stats(&ram);
+
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "STATS:");
+    resp_kv_u32(&r, "RX_BYTES", usb_stats.rx_bytes_total);
+    resp_kv_u32(&r, "TX_BYTES", usb_stats.tx_bytes_total);
+    resp_kv_u32(&r, "RX_OVERFLOW", usb_stats.rx_overflow_count);
+    resp_kv_u32(&r, "TX_OVERFLOW", usb_stats.tx_overflow_count);
+    resp_kv_u32(&r, "RX_PAUSES", usb_stats.rx_pause_count);
+    resp_kv_u32(&r, "TX_QUEUE_DROPS", usb_stats.tx_queue_drops);
+    resp_kv_u32(&r, "TX_TIMEOUTS", usb_stats.tx_timeouts);
+    resp_kv_u32(&r, "TX_TRUNCATED", usb_stats.tx_truncated);
+    resp_kv_u32(&r, "HOST_CLOSES", usb_stats.host_closes);
+    resp_kv_u32(&r, "DROPPED", ccd_data_layer_get_dropped_count());
+    resp_kv_u32(&r, "BAND_DROPS", band_integrator_get_dropped_count());
+    resp_kv_u32(&r, "TRACE_DROPS", trace_get_dropped_count());
+    resp_kv_u32(&r, "SETTLE_DROPS", settle_get_dropped_count());
+    resp_kv_u32(&r, "ADAPT_DOWN", adaptive_format_get_steps_down());
+    resp_kv_u32(&r, "ADAPT_UP", adaptive_format_get_steps_up());
+    resp_kv_u32(&r, "MSP_PEAK", ram.stack_peak);
+    resp_kv_u32(&r, "MSP_RESERVED", ram.stack_reserved);
+    resp_kv_u32(&r, "MSP_FREE", ram.stack_free);
+    resp_kv_u32(&r, "ISR_SP_PEAK", ram.isr_entry_peak);
+    resp_kv_u32(&r, "HEAP", ram.heap_used);
+    resp_kv_u32(&r, "STATIC_RAM", ram.static_ram);
+    resp_kv_u32(&r, "USB_STATIC_SIZE", USBD_static_get_capacity());
+
+    send_response(resp_end(&r));
+}
+
+/**
+ * @brief Open a chunked binary upload
+ */
+Command_Status_t command_handle_upload(const char* params)
+{
+    char type_name[8];
+    size_t name_len = strcspn(params, ",");
+    Upload_Type_t type;
+
+    if (name_len == 0 || name_len >= sizeof(type_name) || params[name_len] != ',') {
+        send_response("ERROR:INVALID_PARAM\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+    memcpy(type_name, params, name_len);
+    type_name[name_len] = '\0';
+
+    char* param_end;
+    uint32_t size = (uint32_t)strtoul(&params[name_len + 1], &param_end, 10);
+
+    Upload_Target_t target = UPLOAD_TARGET_RAM;
+    if (strcmp(param_end, ",FLASH") == 0) {
+        target = UPLOAD_TARGET_FLASH;
+    } else if (*param_end != '\0' && strcmp(param_end, ",RAM") != 0) {
+        send_response("ERROR:INVALID_PARAM\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    if (!parse_upload_type(type_name, &type)) {
+        send_response("ERROR:INVALID_PARAM\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    // Flash programming stalls instruction fetch - frames would be dropped
+    if (target == UPLOAD_TARGET_FLASH && acquisition_state == ACQ_STATE_RUNNING) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    // The firmware image has grown into the store sector
+    if (target == UPLOAD_TARGET_FLASH && !bulk_upload_flash_usable()) {
+        send_response("ERROR:UPLOAD_FLASH_OVERLAP\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    switch (bulk_upload_begin(type, size, target)) {
+        case UPLOAD_OK:
+            break;
+        case UPLOAD_ERROR_NO_SPACE:
+            send_response("ERROR:UPLOAD_NO_SPACE\n");
+            return CMD_ERROR_INVALID_PARAM;
+        case UPLOAD_ERROR_FLASH:
+            send_response("ERROR:UPLOAD_FLASH\n");
+            return CMD_ERROR_BUSY;
+        default:
+            send_response("ERROR:INVALID_PARAM\n");
+            return CMD_ERROR_INVALID_PARAM;
+    }
+
+    char response[48];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "UPLOAD_READY", size);
+    resp_char(&r, ',');
+    resp_u32(&r, UPLOAD_MAX_CHUNK);
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Report the newest committed image of a type
+ */
+void command_handle_upload_info(const char* type_name)
+{
+    Upload_Type_t type;
+    bulk_upload_image_t image;
+
+    if (!parse_upload_type(type_name, &type)) {
+        send_response("ERROR:INVALID_PARAM\n");
+        return;
+    }
+
+    char response[80];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_kv_str(&r, "UPLOAD_INFO", type_name);
+    if (bulk_upload_find(type, &image)) {
+        resp_char(&r, ',');
+        resp_str(&r, (image.target == UPLOAD_TARGET_RAM) ? "RAM" : "FLASH");
+        resp_char(&r, ',');
+        resp_u32(&r, image.size);
+        resp_char(&r, ',');
+        resp_hex16(&r, image.crc);
+    } else {
+        resp_str(&r, ",NONE");
+    }
+    resp_kv_u32(&r, "FLASH_FREE", bulk_upload_flash_free());
+    send_response(resp_end(&r));
+}
+
+/**
+ * @brief Erase the flash image store
+ */
+Command_Status_t command_handle_upload_erase(void)
+{
+    if (acquisition_state == ACQ_STATE_RUNNING) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    if (!bulk_upload_flash_usable()) {
+        send_response("ERROR:UPLOAD_FLASH_OVERLAP\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    if (bulk_upload_erase_flash() != UPLOAD_OK) {
+        send_response("ERROR:UPLOAD_FLASH\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    send_response("OK:UPLOAD_ERASED\n");
+    return CMD_OK;
+}
+
+/**
+ * @brief Arm the pre-trigger ring
+ */
+Command_Status_t command_handle_pretrig(uint32_t pre, uint32_t post,
+                                        uint32_t roi_start, uint32_t roi_length)
+{
+    // Frames and pre-trigger dumps share the data IN endpoint
+    if (acquisition_state == ACQ_STATE_RUNNING) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    if (roi_length == 0 || roi_start + roi_length > CCD_PIXEL_COUNT) {
+        send_response("ERROR:INVALID_PARAM\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    char response[96];
+    Resp_Buffer_t r;
+    uint16_t slots = pretrig_capacity((uint16_t)roi_length);
+
+    resp_init(&r, response, sizeof(response));
+    if (pre + post > slots ||
+        !pretrig_arm((uint16_t)pre, (uint16_t)post, (uint16_t)roi_start, (uint16_t)roi_length)) {
+        resp_str(&r, "ERROR:");
+        resp_kv_u32(&r, "PRETRIG_CAPACITY", slots);
+        send_response(resp_end(&r));
+        return CMD_ERROR_INVALID_PARAM;
+    }
 
-    snprintf(response, sizeof(response),
-             "STATUS:%s,INT_TIME:%lu\n",
-             state_str,
-             (unsigned long)integration_time_us);
+    resp_str(&r, "OK:PRETRIG_ARMED:");
+    resp_kv_u32(&r, "PRE", pre);
+    resp_kv_u32(&r, "POST", post);
+    resp_kv_u32(&r, "ROI", roi_start);
+    resp_char(&r, ',');
+    resp_u32(&r, roi_length);
+    resp_kv_u32(&r, "SLOTS", slots);
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Software trigger for the pre-trigger ring
+ */
+Command_Status_t command_handle_trigger(void)
+{
+    if (!pretrig_trigger(PRETRIG_SOURCE_SW)) {
+        send_response("ERROR:NOT_ARMED\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    send_response("OK:TRIGGERED\n");
+    return CMD_OK;
+}
+
+/**
+ * @brief Request a single-shot frame
+ */
+Command_Status_t command_handle_snap(bool wait_for_edge)
+{
+    if (wait_for_edge) {
+        if (!snap_arm_gpio()) {
+            send_response("ERROR:SNAP_BUSY\n");
+            return CMD_ERROR_BUSY;
+        }
+        send_response("OK:SNAP_ARMED\n");
+        return CMD_OK;
+    }
+
+    // No OK line: the SNAP info line and frame are the response, and they
+    // would overtake it on the data endpoint anyway
+    if (!snap_request()) {
+        send_response("ERROR:SNAP_BUSY\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Send the latest complete frame
+ */
+Command_Status_t command_handle_getframe(void)
+{
+    // Streaming already sends every frame; a pulled one would be a duplicate
+    if (command_layer_is_acquiring()) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    // No OK line: as with SNAP, the info line and frame are the response
+    switch (latest_frame_request()) {
+        case LATEST_FRAME_SENT:
+            return CMD_OK;
+        case LATEST_FRAME_NONE:
+            send_response("ERROR:NO_FRAME\n");
+            return CMD_ERROR_BUSY;
+        default:
+            send_response("ERROR:GETFRAME_BUSY\n");
+            return CMD_ERROR_BUSY;
+    }
+}
+
+/**
+ * @brief Configure the band integrator
+ */
+Command_Status_t command_handle_bands(const char* params)
+{
+    CCD_Band_t bands[CCD_MAX_BANDS];
+    uint32_t values[2 * CCD_MAX_BANDS];
+    const char* p = params;
+    char* param_end = (char*)params;
+    int count = 0;
+
+    while (count < 2 * CCD_MAX_BANDS) {
+        values[count++] = (uint32_t)strtoul(p, &param_end, 10);
+        if (*param_end != ',') {
+            break;
+        }
+        p = param_end + 1;
+    }
+
+    if (*param_end != '\0' || (count % 2) != 0) {
+        send_response("ERROR:INVALID_PARAM\n");
+        return CMD_ERROR_INVALID_PARAM;
+    }
+
+    for (int b = 0; b < count / 2; b++) {
+        bands[b].start = (uint16_t)((values[2 * b] > 0xFFFF) ? 0xFFFF : values[2 * b]);
+        bands[b].length = (uint16_t)((values[2 * b + 1] > 0xFFFF) ? 0xFFFF : values[2 * b + 1]);
+    }
+
+    switch (band_integrator_configure(bands, (uint8_t)(count / 2))) {
+        case BAND_OK:
+            break;
+        case BAND_ERROR_ORDER:
+            send_response("ERROR:BAND_ORDER\n");
+            return CMD_ERROR_INVALID_PARAM;
+        default:
+            send_response("ERROR:INVALID_PARAM\n");
+            return CMD_ERROR_INVALID_PARAM;
+    }
+
+    char response[64];
+    Resp_Buffer_t r;
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "BANDS", (uint32_t)(count / 2));
+    resp_kv_u32(&r, "PACKET", BAND_PACKET_SIZE(count / 2));
+    resp_kv_u32(&r, "FRAMES", band_integrator_get_frame_divider());
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Set how often full frames are sent while bands are active
+ */
+Command_Status_t command_handle_band_frames(uint32_t divider)
+{
+    char response[32];
+    Resp_Buffer_t r;
+
+    if (divider > 0xFFFF) {
+        divider = 0xFFFF;
+    }
+    band_integrator_set_frame_divider((uint16_t)divider);
+
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "OK:");
+    resp_kv_u32(&r, "BAND_FRAMES", divider);
+    send_response(resp_end(&r));
+
+    return CMD_OK;
+}
+
+/**
+ * @brief Time the response formatter on a worst-case key/value line
+ */
+void command_handle_fmt_bench(void)
+{
+    char line[128];
+    char response[112];
+    Resp_Buffer_t r;
+    uint32_t resp_min = UINT32_MAX, resp_max = 0;
+
+    // Every value 10 digits wide: the longest conversions the formatter does
+    for (uint32_t run = 0; run < FMT_BENCH_RUNS; run++) {
+        uint32_t start = cycle_counter_now();
+
+        resp_init(&r, line, sizeof(line));
+        resp_str(&r, "STATS:");
+        resp_kv_u32(&r, "RX_BYTES", 4294967295UL);
+        resp_kv_u32(&r, "TX_BYTES", 4294967295UL);
+        resp_kv_u32(&r, "RX_OVERFLOW", 4294967295UL);
+        resp_kv_u32(&r, "TX_OVERFLOW", 4294967295UL);
+        resp_kv_u32(&r, "RX_PAUSES", 4294967295UL);
+        resp_kv_u32(&r, "DROPPED", 4294967295UL);
+        resp_end(&r);
+
+        uint32_t cycles = cycle_counter_now() - start;
+        if (cycles < resp_min) {
+            resp_min = cycles;
+        }
+        if (cycles > resp_max) {
+            resp_max = cycles;
+        }
+    }
+
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "FMT_BENCH:");
+    resp_kv_u32(&r, "LEN", (uint32_t)strlen(line));
+    resp_kv_u32(&r, "RESP_MIN", resp_min);
+    resp_kv_u32(&r, "RESP_MAX", resp_max);
+
+#ifdef RESP_FORMAT_BENCH_SNPRINTF
+    // Comparison build only: links newlib's formatter back in
+    uint32_t printf_min = UINT32_MAX, printf_max = 0;
+
+    for (uint32_t run = 0; run < FMT_BENCH_RUNS; run++) {
+        uint32_t start = cycle_counter_now();
+
+        snprintf(line, sizeof(line),
+                 "STATS:RX_BYTES:%lu,TX_BYTES:%lu,RX_OVERFLOW:%lu,TX_OVERFLOW:%lu,"
+                 "RX_PAUSES:%lu,DROPPED:%lu\n",
+                 4294967295UL, 4294967295UL, 4294967295UL,
+                 4294967295UL, 4294967295UL, 4294967295UL);
+
+        uint32_t cycles = cycle_counter_now() - start;
+        if (cycles < printf_min) {
+            printf_min = cycles;
+        }
+        if (cycles > printf_max) {
+            printf_max = cycles;
+        }
+    }
+
+    resp_kv_u32(&r, "SNPRINTF_MIN", printf_min);
+    resp_kv_u32(&r, "SNPRINTF_MAX", printf_max);
+#endif
+
+    resp_kv_u32(&r, "RUNS", FMT_BENCH_RUNS);
+    send_response(resp_end(&r));
+}
+
+/**
+ * @brief Benchmark the readout kernels
+ */
+Command_Status_t command_handle_bench(void)
+{
+    Kernel_Bench_Result_t results[KERNEL_COUNT];
+    char response[256];
+    Resp_Buffer_t r;
+
+    if (command_layer_is_acquiring()) {
+        send_response("ERROR:MUST_STOP_FIRST\n");
+        return CMD_ERROR_BUSY;
+    }
+    if (!kernel_bench_run(results)) {
+        send_response("ERROR:PRETRIG_ACTIVE\n");
+        return CMD_ERROR_BUSY;
+    }
+
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "BENCH:");
+    resp_kv_u32(&r, "RUNS", KERNEL_BENCH_RUNS);
+    resp_kv_u32(&r, "MHZ", HAL_RCC_GetHCLKFreq() / 1000000U);
+    resp_kv_str(&r, "ART", hotpath_art_enabled() ? "ON" : "OFF");
+    resp_kv_str(&r, "HOTPATH", HOTPATH_LOCATION);
+    for (uint32_t k = 0; k < KERNEL_COUNT; k++) {
+        const char* name = kernel_bench_name((Kernel_Id_t)k);
+        resp_kv_u32(&r, name, results[k].min);
+        resp_char(&r, ',');
+        resp_str(&r, name);
+        resp_str(&r, "_MAX:");
+        resp_u32(&r, results[k].max);
+    }
+    send_response(resp_end(&r));
+    return CMD_OK;
+}
+
+/**
+ * @brief Report the cycles spent per readout in the ADC callback
+ */
+void command_handle_perf(void)
+{
+    char response[160];
+    Resp_Buffer_t r;
+    CCD_Cycle_Stats_t stats;
+    uint32_t avg = 0;
+
+    ccd_data_layer_get_cycle_stats(&stats);
+    if (stats.count > 0) {
+        avg = (uint32_t)(stats.sum / stats.count);
+    }
 
-    send_response(response);
+    resp_init(&r, response, sizeof(response));
+    resp_str(&r, "PERF:");
+    resp_kv_u32(&r, "FRAMES", stats.count);
+    resp_kv_u32(&r, "CYC_MIN", stats.min);
+    resp_kv_u32(&r, "CYC_MAX", stats.max);
+    resp_kv_u32(&r, "CYC_AVG", avg);
+    resp_kv_u32(&r, "CYC_LAST", stats.last);
+    resp_kv_u32(&r, "US_AVG", cycle_counter_to_us(avg));
+    resp_kv_u32(&r, "US_MAX", cycle_counter_to_us(stats.max));
+    resp_kv_str(&r, "ART", hotpath_art_enabled() ? "ON" : "OFF");
+    resp_kv_str(&r, "HOTPATH", HOTPATH_LOCATION);
+    send_response(resp_end(&r));
 }
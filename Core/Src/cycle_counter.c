@@ -0,0 +1,34 @@
+/**
+ ******************************************************************************
+ * @file    cycle_counter.c
+ * @brief   DWT cycle counter helpers
+ ******************************************************************************
+ */
+
+#include "cycle_counter.h"
+
+/* Cycles per microsecond, cached at init (HCLK does not change at runtime) */
+static uint32_t cycles_per_us = 84;
+
+/**
+ * @brief Enable the DWT cycle counter
+ */
+void cycle_counter_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    cycles_per_us = HAL_RCC_GetHCLKFreq() / 1000000U;
+    if (cycles_per_us == 0) {
+        cycles_per_us = 1;
+    }
+}
+
+/**
+ * @brief Convert cycles to microseconds
+ */
+uint32_t cycle_counter_to_us(uint32_t cycles)
+{
+    return cycles / cycles_per_us;
+}
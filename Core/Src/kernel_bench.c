@@ -0,0 +1,134 @@
+/**
+ ******************************************************************************
+ * @file    kernel_bench.c
+ * @brief   On-device kernel benchmark implementation
+ ******************************************************************************
+ */
+
+#include "kernel_bench.h"
+#include "ccd_data_layer.h"
+#include "pretrigger.h"
+#include "cycle_counter.h"
+#include "main.h"
+
+extern volatile uint16_t CCDPixelBuffer[];
+
+static const char* const kernel_names[KERNEL_COUNT] = {
+    "COPY", "BANDS", "CRC16", "PACK12", "PACK10", "PACK8"
+};
+
+/* Working buffers inside the borrowed pool (7404 + 5541 of 16384 bytes) */
+#define BENCH_FRAME_OFFSET      0
+#define BENCH_PACKED_OFFSET     ((sizeof(CCD_Frame_t) + 3U) & ~3U)
+
+/* Kernel working state, set up by kernel_bench_run() */
+static CCD_Frame_t* frame;
+static uint16_t* pixels;
+static uint8_t* packed;
+static CCD_Band_t bands[CCD_MAX_BANDS];
+static CCD_Band_Sum_t sums[CCD_MAX_BANDS];
+
+/**
+ * @brief One call of a kernel (KERNEL_COUNT: nothing, for the overhead)
+ */
+__attribute__((noinline)) static void run_kernel(uint32_t kernel)
+{
+    switch (kernel) {
+        case KERNEL_COPY:
+            ccd_data_layer_copy_pixels(CCDPixelBuffer, pixels, bands, 0, 4095U, sums);
+            break;
+        case KERNEL_BANDS:
+            ccd_data_layer_copy_pixels(CCDPixelBuffer, pixels, bands, CCD_MAX_BANDS, 4095U, sums);
+            break;
+        case KERNEL_CRC16:
+            ccd_data_layer_calculate_crc16((const uint8_t*)frame, FRAME_TOTAL_SIZE - 2U);
+            break;
+        case KERNEL_PACK12:
+            ccd_data_layer_pack12(pixels, CCD_PIXEL_COUNT, packed);
+            break;
+        case KERNEL_PACK10:
+            ccd_data_layer_encode_frame_bits(frame, 10, 0, 0);
+            break;
+        case KERNEL_PACK8:
+            ccd_data_layer_encode_frame_bits(frame, 8, 0, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Time one kernel call with interrupts masked
+ */
+static uint32_t time_kernel(uint32_t kernel)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t start = cycle_counter_now();
+    run_kernel(kernel);
+    uint32_t cycles = cycle_counter_now() - start;
+
+    __set_PRIMASK(primask);
+    return cycles;
+}
+
+/**
+ * @brief Run every kernel KERNEL_BENCH_RUNS times
+ */
+bool kernel_bench_run(Kernel_Bench_Result_t* results)
+{
+    uint8_t* pool = pretrig_borrow_pool();
+    if (pool == NULL) {
+        return false;
+    }
+
+    frame = (CCD_Frame_t*)&pool[BENCH_FRAME_OFFSET];
+    pixels = (uint16_t*)((uint8_t*)frame + FRAME_HEADER_SIZE);
+    packed = &pool[BENCH_PACKED_OFFSET];
+
+    for (uint8_t b = 0; b < CCD_MAX_BANDS; b++) {
+        bands[b].start = (uint16_t)(32U + b * 450U);
+        bands[b].length = 400U;
+    }
+
+    // Call and timer overhead, subtracted from every result
+    uint32_t overhead = UINT32_MAX;
+    for (uint32_t run = 0; run < KERNEL_BENCH_RUNS; run++) {
+        uint32_t cycles = time_kernel(KERNEL_COUNT);
+        if (cycles < overhead) {
+            overhead = cycles;
+        }
+    }
+
+    for (uint32_t k = 0; k < KERNEL_COUNT; k++) {
+        results[k].min = UINT32_MAX;
+        results[k].max = 0;
+
+        for (uint32_t run = 0; run < KERNEL_BENCH_RUNS; run++) {
+            // The FRMX encoders work in place: refill the pixels (untimed)
+            if (k == KERNEL_PACK10 || k == KERNEL_PACK8) {
+                run_kernel(KERNEL_COPY);
+            }
+
+            uint32_t cycles = time_kernel(k);
+            cycles = (cycles > overhead) ? (cycles - overhead) : 0;
+            if (cycles < results[k].min) {
+                results[k].min = cycles;
+            }
+            if (cycles > results[k].max) {
+                results[k].max = cycles;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Name of a kernel
+ */
+const char* kernel_bench_name(Kernel_Id_t kernel)
+{
+    return (kernel < KERNEL_COUNT) ? kernel_names[kernel] : "?";
+}
@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ * @file    latest_frame.c
+ * @brief   Latest-frame slot implementation
+ ******************************************************************************
+ */
+
+#include "latest_frame.h"
+#include "usb_transport.h"
+#include "cycle_counter.h"
+#include "resp_format.h"
+#include "main.h"
+#include "hotpath.h"
+
+/* Slot, written by the ADC callback only */
+static const CCD_Frame_t* volatile latest = NULL;
+static volatile uint16_t latest_size = 0;
+static volatile uint8_t latest_bits = 12;
+static volatile uint8_t latest_flags = 0;
+static volatile uint32_t latest_cycles = 0;
+static volatile uint32_t latest_tick = 0;
+
+// Info line; stays untouched while queued for USB
+static char info_line[64];
+
+/**
+ * @brief Record a completed frame
+ */
+HOTPATH_FUNC void latest_frame_on_readout(const CCD_Frame_t* frame, uint16_t frame_size,
+                                          uint32_t readout_cycles)
+{
+    latest_size = frame_size;
+    latest_bits = ccd_data_layer_get_encoded_bits();
+    latest_flags = ccd_data_layer_get_frame_flags();
+    latest_cycles = readout_cycles;
+    latest_tick = HAL_GetTick();
+    latest = frame;
+}
+
+/**
+ * @brief Queue the info line and the latest frame for USB
+ */
+Latest_Frame_Status_t latest_frame_request(void)
+{
+    Latest_Frame_Status_t result = LATEST_FRAME_SENT;
+    Resp_Buffer_t r;
+
+    // The callback must not move the slot between reading and queueing it;
+    // once queued, it steers around the buffer by itself
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (latest == NULL) {
+        result = LATEST_FRAME_NONE;
+    }
+    else if (usb_transport_is_queued((const uint8_t*)info_line) ||
+             usb_transport_queue_space() < 2) {
+        result = LATEST_FRAME_BUSY;
+    }
+    else {
+        uint32_t age_ms = HAL_GetTick() - latest_tick;
+        uint32_t age_us = (age_ms < 1000U) ?
+                          cycle_counter_to_us(cycle_counter_now() - latest_cycles) :
+                          ((age_ms < 4000000U) ? age_ms * 1000U : 0xFFFFFFFFU);
+
+        resp_init(&r, info_line, sizeof(info_line));
+        resp_str(&r, "GETFRAME:");
+        resp_kv_u32(&r, "SEQ", latest->frame_counter);
+        resp_kv_u32(&r, "AGE_US", age_us);
+        resp_kv_u32(&r, "BITS", latest_bits);
+        if (latest_flags & CCD_FRAME_FLAG_SETTLING) {
+            resp_kv_u32(&r, "SETTLING", 1);
+        }
+        resp_end(&r);
+
+        usb_transport_queue_direct((const uint8_t*)info_line, resp_len(&r));
+        usb_transport_queue_direct((const uint8_t*)latest, latest_size);
+    }
+
+    __set_PRIMASK(primask);
+    return result;
+}
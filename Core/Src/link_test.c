@@ -0,0 +1,195 @@
+/**
+ ******************************************************************************
+ * @file    link_test.c
+ * @brief   Raw USB link test implementation
+ ******************************************************************************
+ */
+
+#include "link_test.h"
+#include "usb_transport.h"
+#include "cycle_counter.h"
+#include "resp_format.h"
+#include "pretrigger.h"
+#include "main.h"
+
+_Static_assert(2U * LINK_TEST_BUFFER_SIZE <= PRETRIG_POOL_SIZE,
+               "link test echo buffers must fit in the pre-trigger pool");
+
+/* Session */
+static Link_Test_Mode_t mode = LINK_TEST_IDLE;
+static uint32_t total_bytes = 0;
+static uint32_t received = 0;
+static uint32_t transfers = 0;
+static bool started = false;                // First byte seen
+static uint32_t start_cycles = 0;
+static uint64_t elapsed_cycles = 0;         // Accumulated, so DWT wraps do not matter
+static uint32_t last_rx_tick = 0;
+
+/* Echo buffers, borrowed from the idle pre-trigger pool for the session */
+static uint8_t* echo_buf[2] = { NULL, NULL };
+static uint16_t echo_fill = 0;
+static uint8_t echo_index = 0;
+
+/* Sink scratch */
+static uint8_t sink_buf[64];
+
+/**
+ * @brief Advance the elapsed time to now
+ */
+static void update_elapsed(void)
+{
+    uint32_t now = cycle_counter_now();
+    elapsed_cycles += (uint32_t)(now - start_cycles);
+    start_cycles = now;
+}
+
+/**
+ * @brief Send the result line and end the session
+ */
+static void finish(void)
+{
+    char line[96];
+    Resp_Buffer_t r;
+    uint32_t us = (uint32_t)(elapsed_cycles / (HAL_RCC_GetHCLKFreq() / 1000000U));
+    uint32_t bps = (us > 0) ? (uint32_t)(((uint64_t)total_bytes * 1000000U) / us) : 0;
+
+    resp_init(&r, line, sizeof(line));
+    resp_str(&r, (mode == LINK_TEST_LOOPBACK) ? "LOOPBACK:" : "SINK:");
+    resp_kv_u32(&r, "BYTES", total_bytes);
+    resp_kv_u32(&r, "US", us);
+    resp_kv_u32(&r, "BPS", bps);
+    if (mode == LINK_TEST_LOOPBACK) {
+        resp_kv_u32(&r, "XFERS", transfers);
+    }
+    usb_transport_write_string(resp_end(&r));
+
+    mode = LINK_TEST_IDLE;
+}
+
+/**
+ * @brief Start a loopback or sink test
+ */
+bool link_test_start(Link_Test_Mode_t new_mode, uint32_t bytes)
+{
+    if (mode != LINK_TEST_IDLE || bytes == 0 ||
+        (new_mode != LINK_TEST_LOOPBACK && new_mode != LINK_TEST_SINK)) {
+        return false;
+    }
+
+    // Commands are not parsed while the test owns RX, so the ring cannot be
+    // armed (and take the pool back) before the session ends
+    if (new_mode == LINK_TEST_LOOPBACK) {
+        uint8_t* pool = pretrig_borrow_pool();
+        if (pool == NULL) {
+            return false;
+        }
+        echo_buf[0] = pool;
+        echo_buf[1] = pool + LINK_TEST_BUFFER_SIZE;
+    }
+
+    total_bytes = bytes;
+    received = 0;
+    transfers = 0;
+    started = false;
+    elapsed_cycles = 0;
+    echo_fill = 0;
+    echo_index = 0;
+    last_rx_tick = HAL_GetTick();
+    mode = new_mode;
+    return true;
+}
+
+/**
+ * @brief Check whether a link test owns the RX stream
+ */
+bool link_test_is_active(void)
+{
+    return (mode != LINK_TEST_IDLE);
+}
+
+/**
+ * @brief Consume / echo test data
+ */
+void link_test_process(void)
+{
+    if (mode == LINK_TEST_IDLE) {
+        return;
+    }
+
+    // Host went away: nothing can be echoed or reported
+    if (!usb_transport_host_present()) {
+        mode = LINK_TEST_IDLE;
+        return;
+    }
+
+    if (started) {
+        update_elapsed();
+    }
+
+    if (usb_transport_available()) {
+        if (!started) {
+            started = true;
+            start_cycles = cycle_counter_now();
+        }
+        last_rx_tick = HAL_GetTick();
+    }
+    else if (received < total_bytes && (HAL_GetTick() - last_rx_tick) > LINK_TEST_TIMEOUT_MS) {
+        // Keep the borrowed pool until the IN EP is done with it (the TX
+        // watchdog bounds the wait)
+        if (mode == LINK_TEST_LOOPBACK &&
+            (usb_transport_is_queued(echo_buf[0]) || usb_transport_is_queued(echo_buf[1]))) {
+            return;
+        }
+
+        char line[48];
+        Resp_Buffer_t r;
+        resp_init(&r, line, sizeof(line));
+        resp_str(&r, "ERROR:LINK_TEST_TIMEOUT:");
+        resp_u32(&r, received);
+        usb_transport_write_string(resp_end(&r));
+        mode = LINK_TEST_IDLE;
+        return;
+    }
+
+    if (mode == LINK_TEST_SINK) {
+        while (received < total_bytes && usb_transport_available()) {
+            uint32_t want = total_bytes - received;
+            if (want > sizeof(sink_buf)) {
+                want = sizeof(sink_buf);
+            }
+            received += usb_transport_read(sink_buf, (uint16_t)want);
+        }
+        if (received == total_bytes) {
+            update_elapsed();
+            finish();
+        }
+        return;
+    }
+
+    // Loopback: fill the free buffer, hand it to the IN EP as soon as
+    // nothing more is waiting (small packets keep their latency)
+    uint8_t* buf = echo_buf[echo_index];
+    if (!usb_transport_is_queued(buf)) {
+        uint32_t want = total_bytes - received;
+        uint32_t space = LINK_TEST_BUFFER_SIZE - echo_fill;
+        uint16_t n = usb_transport_read(&buf[echo_fill], (uint16_t)((want < space) ? want : space));
+
+        echo_fill += n;
+        received += n;
+
+        if (echo_fill > 0 && (echo_fill == LINK_TEST_BUFFER_SIZE || !usb_transport_available())) {
+            if (usb_transport_queue_direct(buf, echo_fill)) {
+                transfers++;
+                echo_fill = 0;
+                echo_index ^= 1;
+            }
+        }
+    }
+
+    // Done once everything is echoed and the last transfer has completed
+    if (received == total_bytes && echo_fill == 0 &&
+        !usb_transport_is_queued(echo_buf[0]) && !usb_transport_is_queued(echo_buf[1])) {
+        update_elapsed();
+        finish();
+    }
+}
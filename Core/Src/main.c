@@ -22,12 +22,25 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-#include <stdio.h>
 #include <string.h>
 #include "usbd_cdc_if.h"
 #include "usb_transport.h"  // ← ADDED for USB transport code
 #include "ccd_data_layer.h"  // ← ADDED for CCD frame management
 #include "command_layer.h"   // ← ADDED FOR COMMAND layer
+#include "cycle_counter.h"   // DWT cycle counter for on-target timing
+#include "bulk_upload.h"     // Chunked binary upload channel
+#include "pretrigger.h"      // Pre-trigger frame ring
+#include "snap.h"            // Single-shot SNAP
+#include "band_integrator.h" // Band telemetry packets
+#include "ram_monitor.h"     // Stack painting / RAM high-water marks
+#include "resp_format.h"     // printf-free response formatting
+#include "hotpath.h"         // SRAM placement of the readout path / ART control
+#include "test_pattern.h"    // Synthetic pixel data (PATTERN)
+#include "latest_frame.h"    // Latest-frame slot (GETFRAME)
+#include "trace.h"           // Readout latency trace packets
+#include "settle.h"          // Settling readouts after configuration changes
+#include "mark.h"            // Host annotation markers (MARK)
+#include "adaptive_format.h" // Backlog-driven frame encoding (ADAPT)
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -76,8 +89,10 @@ static void MX_ADC1_Init(void);
 #define CCDBuffer 6000
 volatile uint16_t CCDPixelBuffer[CCDBuffer];
 
-// Frame buffer for processed data
-static CCD_Frame_t current_frame;
+// Frame buffers for processed data: one can be queued for USB while the
+// next readout is processed into the other
+static CCD_Frame_t frame_buffers[2];
+static uint8_t frame_next = 0;
 /* USER CODE END 0 */
 
 /**
@@ -88,7 +103,8 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
-
+  // Paint the free stack area before anything runs deep
+  ram_monitor_init();
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -104,7 +120,10 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
-
+  cycle_counter_init();
+  // HAL_Init enabled the ART accelerator at reset wait states; flush and
+  // re-enable it now that SystemClock_Config has set FLASH_LATENCY_2
+  hotpath_art_config(true);
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
@@ -128,6 +147,8 @@ int main(void)
   usb_transport_init();
   // Initialize CCD data layer
   ccd_data_layer_init();
+  // Initialize upload channel
+  bulk_upload_init();
   // Initialize command layer
   command_layer_init();
 
@@ -145,6 +166,7 @@ int main(void)
 
 	usb_transport_process();  // ← ADDED for USB IO
 	command_layer_process();  // ← ADDED for command layer
+	pretrig_process();        // Send a frozen pre-trigger ring
 
 
   }
@@ -522,6 +544,17 @@ static void MX_GPIO_Init(void)
   __HAL_RCC_GPIOA_CLK_ENABLE();
 
   /* USER CODE BEGIN MX_GPIO_Init_2 */
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  /* Trigger input: PB0, rising edge, pulled down so an open input stays quiet */
+  __HAL_RCC_GPIOB_CLK_ENABLE();
+  GPIO_InitStruct.Pin = TRIG_IN_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+  GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+  HAL_GPIO_Init(TRIG_IN_GPIO_Port, &GPIO_InitStruct);
+
+  HAL_NVIC_SetPriority(TRIG_IN_EXTI_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(TRIG_IN_EXTI_IRQn);
 
   /* USER CODE END MX_GPIO_Init_2 */
 }
@@ -531,42 +564,154 @@ static void MX_GPIO_Init(void)
 // Debug counter
 static uint32_t callback_count = 0;
 
-void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
+HOTPATH_FUNC void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
 {
     // // DEBUG CALLBACK MESSAGE - SEND THIS IMMEDIATELY - before anything else!
     // uint8_t test[] = "CALLBACK!\r\n";
     // CDC_Transmit_FS(test, sizeof(test)-1);
 
+    uint32_t readout_cycles = cycle_counter_now();
+
+    ram_monitor_sample_isr();
+
+    // Streamed frames follow the ADAPT encoding; SNAP/GETFRAME while
+    // stopped get the full resolution
+    uint8_t encode_limit = command_layer_is_acquiring() ? adaptive_format_get_bits() : 12;
+
+    // Settling readouts are counted first, so settling also runs out while
+    // no host is listening. A 12-bit FRME frame has no room for the flag.
+    Settle_Readout_t settle = settle_on_readout(
+        ccd_data_layer_get_resolution() != 12 || encode_limit != 12);
+
+    // Nobody listening: skip the copy and CRC unless the pre-trigger ring
+    // is capturing (it keeps its frames until a host collects the dump)
+    Pretrig_State_t pretrig_state = pretrig_get_state();
+    if (!usb_transport_host_present() &&
+        pretrig_state != PRETRIG_STATE_ARMED && pretrig_state != PRETRIG_STATE_POST) {
+        HAL_ADC_Start_DMA(&hadc1, (uint32_t*)CCDPixelBuffer, CCDBuffer);
+        return;
+    }
+
     callback_count++;
 
+    // Settling readouts after a configuration change: skipped before they
+    // cost anything, or processed and flagged (SETTLE)
+    if (settle == SETTLE_READOUT_DROP) {
+        HAL_ADC_Start_DMA(&hadc1, (uint32_t*)CCDPixelBuffer, CCDBuffer);
+        return;
+    }
+    ccd_data_layer_set_frame_flags((settle == SETTLE_READOUT_FLAG) ? CCD_FRAME_FLAG_SETTLING : 0);
+
     // // DIAGNOSTIC: Send a test marker first to prove this NEW code is running
     // if (callback_count == 1) {
     //     uint8_t test[] = "***NEW_CALLBACK_RUNNING***\r\n";
     //     CDC_Transmit_FS(test, sizeof(test)-1);
     // }
 
+    // Never overwrite a frame that is still queued for USB
+    uint8_t index = frame_next;
+    if (usb_transport_is_queued((const uint8_t*)&frame_buffers[index])) {
+        index ^= 1;
+        if (usb_transport_is_queued((const uint8_t*)&frame_buffers[index])) {
+            ccd_data_layer_count_dropped();
+            if (command_layer_is_acquiring()) {
+                adaptive_format_on_submit(false, 0);
+            }
+            HAL_ADC_Start_DMA(&hadc1, (uint32_t*)CCDPixelBuffer, CCDBuffer);
+            return;
+        }
+    }
+    frame_next = index ^ 1;
+    CCD_Frame_t* frame = &frame_buffers[index];
+
+    // Synthetic data in place of the readout while a PATTERN is selected
+    test_pattern_fill(CCDPixelBuffer, ccd_data_layer_get_frame_count(),
+                      ccd_data_layer_get_resolution());
+
+    ccd_data_layer_set_encode_limit(encode_limit);
+
     // Process raw ADC data into a frame with markers and checksum
     CCD_Frame_Status_t status = ccd_data_layer_process_readout(
         CCDPixelBuffer,
-        &current_frame
+        frame
     );
 
     if (status == CCD_FRAME_OK) {
-            // Only send frame if acquisition is enabled
+            // Keep the readout in the pre-trigger ring while armed; this
+            // needs the 16-bit pixels, so it comes before the encoding
+            pretrig_capture(frame);
+            uint16_t frame_size = ccd_data_layer_encode_frame(frame);
+
+            uint32_t ready_cycles = cycle_counter_now();
+
+            // USB backlog as left by earlier readouts: sampled before this
+            // readout's MARK / band packets take queue entries (ADAPT)
+            uint8_t backlog_space = usb_transport_queue_space();
+
+            // Freshest frame for GETFRAME, streaming or not
+            latest_frame_on_readout(frame, frame_size, readout_cycles);
+
+            // A pending SNAP sends this frame itself; otherwise only send
+            // the frame if acquisition is enabled. With bands active every
+            // readout sends a band packet and full frames are rate-limited.
+            bool queued = snap_on_readout(frame, frame_size, readout_cycles);
+
+            // A pending MARK goes out first, so it heads this readout's data
+            if (!queued && command_layer_is_acquiring()) {
+                mark_on_readout(frame, band_integrator_entries_due());
+            }
+
+            bool send_frame = command_layer_is_acquiring() &&
+                              band_integrator_on_readout(frame);
+
+            bool sent = false;
+            if (!queued && send_frame) {
+                sent = usb_transport_queue_direct((const uint8_t*)frame, frame_size);
+                if (!sent) {
+                    ccd_data_layer_count_dropped();
+                }
+                adaptive_format_on_submit(sent, backlog_space);
+            }
+
+            // Stage timestamps of streamed readouts (TRACE:ON)
             if (command_layer_is_acquiring()) {
-                CDC_Transmit_FS((uint8_t*)&current_frame, FRAME_TOTAL_SIZE);
+                trace_on_readout(frame, readout_cycles, ready_cycles, cycle_counter_now(), sent);
             }
         } else {
             // DIAGNOSTIC: Send error code if frame processing fails
             // Always send error messages (even when not acquiring - important for debugging)
-            uint8_t error_msg[32];
-            sprintf((char*)error_msg, "FRAME_ERROR: status=%d\r\n", status);
-            CDC_Transmit_FS(error_msg, strlen((char*)error_msg));
+            // Static: the message must outlive this callback while queued for USB
+            static char error_msg[32];
+            if (!usb_transport_is_queued((const uint8_t*)error_msg)) {
+                Resp_Buffer_t r;
+                resp_init(&r, error_msg, sizeof(error_msg));
+                resp_str(&r, "FRAME_ERROR: status=");
+                resp_i32(&r, status);
+                resp_char(&r, '\r');
+                resp_end(&r);
+                usb_transport_queue_direct((const uint8_t*)error_msg, resp_len(&r));
+            }
         }
 
+    // Time the processed path only (PERF); skipped readouts return early
+    ccd_data_layer_record_cycles(cycle_counter_now() - readout_cycles);
+
     // Restart ADC for next frame
     HAL_ADC_Start_DMA(&hadc1, (uint32_t*)CCDPixelBuffer, CCDBuffer);
 }
+
+/**
+ * @brief EXTI callback - trigger input edge
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    if (GPIO_Pin == TRIG_IN_Pin) {
+        uint32_t edge_cycles = cycle_counter_now();
+
+        snap_trigger_input(edge_cycles);
+        pretrig_trigger(PRETRIG_SOURCE_GPIO);
+    }
+}
 /* USER CODE END 4 */
 
 
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * @file    mark.c
+ * @brief   Stream marker implementation
+ ******************************************************************************
+ */
+
+#include "mark.h"
+#include "usb_transport.h"
+#include "main.h"
+#include "hotpath.h"
+#include <string.h>
+
+static const uint8_t MARK_MARKER[4] = {'M', 'A', 'R', 'K'};
+
+/* Pending mark, set by the main loop and taken by the ADC callback */
+static volatile bool pending = false;
+static volatile uint32_t pending_id = 0;
+
+// Packet; stays untouched while queued for USB
+static uint8_t packet[MARK_PACKET_SIZE] __attribute__((aligned(4)));
+
+/**
+ * @brief Request a marker packet before the next streamed readout
+ */
+bool mark_request(uint32_t id)
+{
+    if (pending || usb_transport_is_queued(packet)) {
+        return false;
+    }
+
+    pending_id = id;
+    pending = true;
+    return true;
+}
+
+/**
+ * @brief Cancel a pending mark
+ */
+void mark_cancel(void)
+{
+    pending = false;
+}
+
+/**
+ * @brief Check whether a mark is waiting to be sent
+ */
+bool mark_is_pending(void)
+{
+    return pending;
+}
+
+/**
+ * @brief Queue a pending marker packet
+ */
+HOTPATH_FUNC void mark_on_readout(const CCD_Frame_t* frame, uint8_t data_entries)
+{
+    // Needs a queue entry of its own plus all of the readout's data, so the
+    // mark never goes out without the readout it names
+    if (!pending || data_entries == 0 || usb_transport_queue_space() < 1U + data_entries) {
+        return;
+    }
+
+    uint32_t id = pending_id;
+    uint32_t tick = HAL_GetTick();
+
+    memcpy(packet, MARK_MARKER, 4);
+    memcpy(&packet[4], &id, 4);
+    memcpy(&packet[8], (const void*)&frame->frame_counter, 2);
+    memcpy(&packet[10], &tick, 4);
+
+    uint16_t crc = ccd_data_layer_calculate_crc16(packet, MARK_PACKET_SIZE - 2);
+    memcpy(&packet[MARK_PACKET_SIZE - 2], &crc, 2);
+
+    if (usb_transport_queue_direct(packet, MARK_PACKET_SIZE)) {
+        pending = false;
+    }
+}
@@ -0,0 +1,237 @@
+/**
+ ******************************************************************************
+ * @file    pretrigger.c
+ * @brief   Pre-trigger frame ring implementation
+ ******************************************************************************
+ * @attention
+ *
+ * Capture runs in the ADC complete callback; the dump runs from the main
+ * loop. The ring needs K + M slots so the pre-trigger frames survive the
+ * post-trigger capture, and it is frozen (capture stops) while the dump is
+ * sent straight out of the slots - no extra frame buffer is needed.
+ *
+ ******************************************************************************
+ */
+
+#include "pretrigger.h"
+#include "usb_transport.h"
+#include "resp_format.h"
+#include <string.h>
+
+#define PAD4(x)  (((x) + 3U) & ~3U)
+
+static const uint8_t PRETRIG_MARKER[4] = {'P', 'T', 'R', 'G'};
+
+/* Slot storage */
+static uint8_t pool[PRETRIG_POOL_SIZE] __attribute__((aligned(4)));
+static uint16_t packet_size = 0;            // Bytes sent per frame
+static uint16_t slot_stride = 0;            // Bytes per slot (word aligned)
+static uint16_t slot_count = 0;
+
+/* Configuration */
+static uint16_t cfg_pre = 0;
+static uint16_t cfg_post = 0;
+static uint16_t cfg_roi_start = 0;
+static uint16_t cfg_roi_length = 0;
+
+/* Capture state (written by the ADC callback) */
+static volatile Pretrig_State_t state = PRETRIG_STATE_IDLE;
+static volatile bool trigger_pending = false;
+static volatile Pretrig_Source_t trigger_source = PRETRIG_SOURCE_SW;
+static uint16_t head = 0;                   // Next slot to write
+static uint16_t stored = 0;                 // Valid slots
+static uint16_t pre_available = 0;          // Pre-trigger frames kept (<= cfg_pre)
+static uint16_t post_captured = 0;
+static uint16_t trigger_seq = 0;
+
+/* Dump state (main loop) */
+static uint16_t dump_first = 0;
+static uint16_t dump_total = 0;
+static uint16_t dump_sent = 0;
+static bool dump_header_sent = false;
+
+/**
+ * @brief Slots available for a given ROI length
+ */
+uint16_t pretrig_capacity(uint16_t roi_length)
+{
+    uint32_t size = PRETRIG_HEADER_SIZE + CCD_PACKED12_SIZE(roi_length) + PRETRIG_CRC_SIZE;
+    return (uint16_t)(PRETRIG_POOL_SIZE / PAD4(size));
+}
+
+/**
+ * @brief Arm the ring
+ */
+bool pretrig_arm(uint16_t pre, uint16_t post, uint16_t roi_start, uint16_t roi_length)
+{
+    if (post == 0 || roi_length == 0 ||
+        (uint32_t)roi_start + roi_length > CCD_PIXEL_COUNT ||
+        (uint32_t)pre + post > pretrig_capacity(roi_length)) {
+        return false;
+    }
+
+    // Stop capture before touching the layout
+    state = PRETRIG_STATE_IDLE;
+
+    cfg_pre = pre;
+    cfg_post = post;
+    cfg_roi_start = roi_start;
+    cfg_roi_length = roi_length;
+
+    packet_size = PRETRIG_HEADER_SIZE + CCD_PACKED12_SIZE(roi_length) + PRETRIG_CRC_SIZE;
+    slot_stride = PAD4(packet_size);
+    slot_count = pretrig_capacity(roi_length);
+
+    head = 0;
+    stored = 0;
+    pre_available = 0;
+    post_captured = 0;
+    trigger_pending = false;
+
+    state = PRETRIG_STATE_ARMED;
+    return true;
+}
+
+/**
+ * @brief Disarm and discard the ring
+ */
+void pretrig_disarm(void)
+{
+    state = PRETRIG_STATE_IDLE;
+    trigger_pending = false;
+}
+
+/**
+ * @brief Trigger the ring
+ */
+bool pretrig_trigger(Pretrig_Source_t source)
+{
+    if (state != PRETRIG_STATE_ARMED || trigger_pending) {
+        return false;
+    }
+
+    trigger_source = source;
+    trigger_pending = true;
+    return true;
+}
+
+/**
+ * @brief Store a processed readout
+ */
+void pretrig_capture(const CCD_Frame_t* frame)
+{
+    Pretrig_State_t current = state;
+    uint16_t flags = 0;
+
+    if (current != PRETRIG_STATE_ARMED && current != PRETRIG_STATE_POST) {
+        return;
+    }
+
+    // The first readout completed after the trigger is the trigger frame
+    if (current == PRETRIG_STATE_ARMED && trigger_pending) {
+        trigger_pending = false;
+        pre_available = (stored < cfg_pre) ? stored : cfg_pre;
+        post_captured = 0;
+        trigger_seq = frame->frame_counter;
+        flags = PRETRIG_FLAG_POST | PRETRIG_FLAG_TRIGGER;
+        state = current = PRETRIG_STATE_POST;
+    }
+    else if (current == PRETRIG_STATE_POST) {
+        flags = PRETRIG_FLAG_POST;
+    }
+
+    if (ccd_data_layer_get_frame_bits() != 12) {
+        flags |= (uint16_t)(ccd_data_layer_get_frame_bits() << PRETRIG_FLAG_BITS_SHIFT);
+    }
+    if (ccd_data_layer_get_frame_flags() & CCD_FRAME_FLAG_SETTLING) {
+        flags |= PRETRIG_FLAG_SETTLING;
+    }
+
+    // Build the packet in place
+    uint8_t* slot = &pool[(uint32_t)head * slot_stride];
+    uint16_t header[4] = { frame->frame_counter, cfg_roi_start, cfg_roi_length, flags };
+
+    memcpy(slot, PRETRIG_MARKER, 4);
+    memcpy(&slot[4], header, sizeof(header));
+
+    // pixel_data sits at a half-word aligned offset of the (packed) frame
+    const uint16_t* pixels = (const uint16_t*)((const uint8_t*)frame + FRAME_HEADER_SIZE);
+    ccd_data_layer_pack12(&pixels[cfg_roi_start], cfg_roi_length, &slot[PRETRIG_HEADER_SIZE]);
+
+    uint16_t crc = ccd_data_layer_calculate_crc16(slot, packet_size - PRETRIG_CRC_SIZE);
+    memcpy(&slot[packet_size - PRETRIG_CRC_SIZE], &crc, PRETRIG_CRC_SIZE);
+
+    head = (head + 1 == slot_count) ? 0 : head + 1;
+    if (stored < slot_count) {
+        stored++;
+    }
+
+    if (current == PRETRIG_STATE_POST && ++post_captured == cfg_post) {
+        // Freeze: oldest pre-trigger frame first, last post-trigger frame last
+        dump_total = pre_available + cfg_post;
+        dump_first = (uint16_t)((head + slot_count - dump_total) % slot_count);
+        dump_sent = 0;
+        dump_header_sent = false;
+        state = PRETRIG_STATE_DUMP;
+    }
+}
+
+/**
+ * @brief Send a frozen ring
+ */
+void pretrig_process(void)
+{
+    if (state != PRETRIG_STATE_DUMP) {
+        return;
+    }
+
+    if (!dump_header_sent) {
+        char response[112];
+        Resp_Buffer_t r;
+        resp_init(&r, response, sizeof(response));
+        resp_str(&r, "PRETRIG_DUMP:");
+        resp_kv_u32(&r, "PRE", pre_available);
+        resp_kv_u32(&r, "POST", cfg_post);
+        resp_kv_u32(&r, "TRIG_SEQ", trigger_seq);
+        resp_kv_u32(&r, "ROI", cfg_roi_start);
+        resp_char(&r, ',');
+        resp_u32(&r, cfg_roi_length);
+        resp_kv_str(&r, "SOURCE", (trigger_source == PRETRIG_SOURCE_GPIO) ? "GPIO" : "SW");
+        usb_transport_write_string(resp_end(&r));
+        dump_header_sent = true;
+        return;
+    }
+
+    // Frames go out directly; wait until queued responses have drained so
+    // the info line stays in front of the packets
+    if (!usb_transport_tx_idle()) {
+        return;
+    }
+
+    if (dump_sent < dump_total) {
+        uint16_t slot = (uint16_t)((dump_first + dump_sent) % slot_count);
+        if (usb_transport_send_direct(&pool[(uint32_t)slot * slot_stride], packet_size)) {
+            dump_sent++;
+        }
+        return;
+    }
+
+    usb_transport_write_string("OK:PRETRIG_DONE\n");
+    state = PRETRIG_STATE_IDLE;
+}
+
+/**
+ * @brief Current ring state
+ */
+Pretrig_State_t pretrig_get_state(void)
+{
+    return state;
+}
+
+/**
+ * @brief Lend the slot pool while the ring is idle
+ */
+uint8_t* pretrig_borrow_pool(void)
+{
+    return (state == PRETRIG_STATE_IDLE) ? pool : NULL;
+}
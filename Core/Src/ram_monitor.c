@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ * @file    ram_monitor.c
+ * @brief   Stack painting and RAM high-water telemetry implementation
+ ******************************************************************************
+ * @attention
+ *
+ * RAM layout (see sysmem.c):
+ *
+ *   _sdata | .data | .bss | heap -> ...painted...   <- MSP | _estack
+ *
+ * Painting stops PAINT_MARGIN bytes below the live stack pointer so the
+ * painting function never overwrites its own frame. Repainting from the
+ * main loop is safe: an interrupt taken meanwhile uses stack below the
+ * main loop's frame and has returned before painting continues.
+ *
+ ******************************************************************************
+ */
+
+#include "ram_monitor.h"
+#include "main.h"
+#include <stddef.h>
+
+#define PAINT_PATTERN   0xA5C3A5C3UL
+#define PAINT_MARGIN    64U     // Bytes left unpainted below the live SP
+
+/* Linker script symbols */
+extern uint8_t _sdata;
+extern uint8_t _end;
+extern uint8_t _estack;
+extern uint32_t _Min_Stack_Size;
+
+/* newlib heap (sysmem.c) */
+extern void* _sbrk(ptrdiff_t incr);
+
+/* Private variables */
+static uint32_t* paint_bottom = NULL;
+static volatile uint32_t isr_min_sp = 0xFFFFFFFFUL;
+
+/**
+ * @brief Current heap end, word aligned up
+ */
+static uint32_t* heap_end(void)
+{
+    return (uint32_t*)(((uint32_t)_sbrk(0) + 3U) & ~3U);
+}
+
+/**
+ * @brief Fill everything between the heap end and the live stack
+ */
+static void paint(void)
+{
+    uint32_t* p = heap_end();
+    uint32_t* top = (uint32_t*)((__get_MSP() - PAINT_MARGIN) & ~3U);
+
+    paint_bottom = p;
+    while (p < top) {
+        *p++ = PAINT_PATTERN;
+    }
+}
+
+/**
+ * @brief Paint the unused stack area
+ */
+void ram_monitor_init(void)
+{
+    paint();
+}
+
+/**
+ * @brief Sample the stack pointer at ADC callback entry
+ */
+void ram_monitor_sample_isr(void)
+{
+    uint32_t sp = __get_MSP();
+
+    if (sp < isr_min_sp) {
+        isr_min_sp = sp;
+    }
+}
+
+/**
+ * @brief Measure current RAM usage
+ */
+void ram_monitor_get_stats(ram_monitor_stats_t* stats)
+{
+    uint32_t* heap = heap_end();
+    uint32_t* p = (paint_bottom != NULL && paint_bottom > heap) ? paint_bottom : heap;
+    uint32_t* top = (uint32_t*)&_estack;
+
+    // The first overwritten word above the heap is the deepest stack use
+    while (p < top && *p == PAINT_PATTERN) {
+        p++;
+    }
+
+    stats->stack_peak = (uint32_t)top - (uint32_t)p;
+    stats->stack_reserved = (uint32_t)&_Min_Stack_Size;
+    stats->stack_free = (uint32_t)p - (uint32_t)heap;
+    stats->isr_entry_peak = (isr_min_sp == 0xFFFFFFFFUL) ? 0 : (uint32_t)top - isr_min_sp;
+    stats->heap_used = (uint32_t)heap - (uint32_t)&_end;
+    stats->static_ram = (uint32_t)&_end - (uint32_t)&_sdata;
+}
+
+/**
+ * @brief Repaint the unused stack area and clear the high-water marks
+ */
+void ram_monitor_reset(void)
+{
+    isr_min_sp = 0xFFFFFFFFUL;
+    paint();
+}
@@ -0,0 +1,145 @@
+/**
+ ******************************************************************************
+ * @file    resp_format.c
+ * @brief   Fixed-buffer response formatter implementation
+ ******************************************************************************
+ */
+
+#include "resp_format.h"
+
+static const char HEX_DIGITS[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+/**
+ * @brief Start a response in buf
+ */
+void resp_init(Resp_Buffer_t* r, char* buf, uint16_t size)
+{
+    r->buf = buf;
+    r->size = size;
+    r->len = 0;
+    r->overflow = (size == 0);
+    if (size > 0) {
+        buf[0] = '\0';
+    }
+}
+
+/**
+ * @brief Append one character
+ */
+void resp_char(Resp_Buffer_t* r, char c)
+{
+    // Keep one byte for the NUL and one for resp_end's '\n'
+    if (r->len + 2U >= r->size) {
+        r->overflow = true;
+        return;
+    }
+    r->buf[r->len++] = c;
+    r->buf[r->len] = '\0';
+}
+
+/**
+ * @brief Append a NUL-terminated string
+ */
+void resp_str(Resp_Buffer_t* r, const char* s)
+{
+    while (*s != '\0') {
+        if (r->len + 2U >= r->size) {
+            r->overflow = true;
+            return;
+        }
+        r->buf[r->len++] = *s++;
+    }
+    if (r->size > 0) {
+        r->buf[r->len] = '\0';
+    }
+}
+
+/**
+ * @brief Append an unsigned decimal number
+ */
+void resp_u32(Resp_Buffer_t* r, uint32_t value)
+{
+    char digits[10];
+    uint8_t n = 0;
+
+    // Least significant first; at most 10 divisions (UDIV, 2-12 cycles each)
+    do {
+        digits[n++] = (char)('0' + value % 10U);
+        value /= 10U;
+    } while (value != 0);
+
+    while (n > 0) {
+        resp_char(r, digits[--n]);
+    }
+}
+
+/**
+ * @brief Append a signed decimal number
+ */
+void resp_i32(Resp_Buffer_t* r, int32_t value)
+{
+    if (value < 0) {
+        resp_char(r, '-');
+        resp_u32(r, 0U - (uint32_t)value);
+    } else {
+        resp_u32(r, (uint32_t)value);
+    }
+}
+
+/**
+ * @brief Append a 16-bit value as four upper-case hex digits
+ */
+void resp_hex16(Resp_Buffer_t* r, uint16_t value)
+{
+    resp_char(r, HEX_DIGITS[(value >> 12) & 0xF]);
+    resp_char(r, HEX_DIGITS[(value >> 8) & 0xF]);
+    resp_char(r, HEX_DIGITS[(value >> 4) & 0xF]);
+    resp_char(r, HEX_DIGITS[value & 0xF]);
+}
+
+/**
+ * @brief Separator before a key/value pair
+ */
+static void kv_separator(Resp_Buffer_t* r)
+{
+    if (r->len > 0 && r->buf[r->len - 1] != ':') {
+        resp_char(r, ',');
+    }
+}
+
+/**
+ * @brief Append "KEY:value"
+ */
+void resp_kv_u32(Resp_Buffer_t* r, const char* key, uint32_t value)
+{
+    kv_separator(r);
+    resp_str(r, key);
+    resp_char(r, ':');
+    resp_u32(r, value);
+}
+
+/**
+ * @brief Append "KEY:text"
+ */
+void resp_kv_str(Resp_Buffer_t* r, const char* key, const char* text)
+{
+    kv_separator(r);
+    resp_str(r, key);
+    resp_char(r, ':');
+    resp_str(r, text);
+}
+
+/**
+ * @brief Terminate the line with '\n'
+ */
+const char* resp_end(Resp_Buffer_t* r)
+{
+    if (r->size >= 2) {
+        r->buf[r->len++] = '\n';
+        r->buf[r->len] = '\0';
+    }
+    return r->buf;
+}
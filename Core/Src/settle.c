@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ * @file    settle.c
+ * @brief   Settling readout tracking implementation
+ ******************************************************************************
+ */
+
+#include "settle.h"
+#include "hotpath.h"
+
+/* Private variables */
+static volatile uint8_t settle_frames = SETTLE_DEFAULT_FRAMES;
+static volatile Settle_Mode_t settle_mode = SETTLE_MODE_DROP;
+static volatile uint8_t remaining = 0;          // Written by both sides, single byte
+static volatile uint32_t dropped_count = 0;
+
+/**
+ * @brief Set the number of settling readouts per change and their handling
+ */
+bool settle_configure(uint8_t frames, Settle_Mode_t mode)
+{
+    if (frames > SETTLE_MAX_FRAMES || (mode != SETTLE_MODE_DROP && mode != SETTLE_MODE_FLAG)) {
+        return false;
+    }
+
+    settle_mode = mode;
+    settle_frames = frames;
+    if (remaining > frames) {
+        remaining = frames;
+    }
+    return true;
+}
+
+/**
+ * @brief Settling readouts per change
+ */
+uint8_t settle_get_frames(void)
+{
+    return settle_frames;
+}
+
+/**
+ * @brief Handling of settling readouts
+ */
+Settle_Mode_t settle_get_mode(void)
+{
+    return settle_mode;
+}
+
+/**
+ * @brief Report a configuration change
+ */
+void settle_mark_change(void)
+{
+    remaining = settle_frames;
+}
+
+/**
+ * @brief Account for a completed readout
+ */
+HOTPATH_FUNC Settle_Readout_t settle_on_readout(bool can_flag)
+{
+    if (remaining == 0) {
+        return SETTLE_READOUT_NORMAL;
+    }
+
+    remaining--;
+    if (settle_mode == SETTLE_MODE_FLAG && can_flag) {
+        return SETTLE_READOUT_FLAG;
+    }
+    dropped_count++;
+    return SETTLE_READOUT_DROP;
+}
+
+/**
+ * @brief Settling readouts dropped since startup
+ */
+uint32_t settle_get_dropped_count(void)
+{
+    return dropped_count;
+}
@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ * @file    snap.c
+ * @brief   Single-shot SNAP implementation
+ ******************************************************************************
+ */
+
+#include "snap.h"
+#include "usb_transport.h"
+#include "cycle_counter.h"
+#include "resp_format.h"
+#include "main.h"
+#include "hotpath.h"
+
+/* Private variables */
+static volatile Snap_State_t state = SNAP_STATE_IDLE;
+static volatile Snap_Source_t snap_source = SNAP_SOURCE_SW;
+static volatile uint32_t trigger_cycles = 0;
+static volatile uint32_t trigger_tick = 0;
+
+// Info line; stays untouched while queued for USB
+static char snap_line[96];
+
+/**
+ * @brief Trigger a snap now
+ */
+bool snap_request(void)
+{
+    if (state != SNAP_STATE_IDLE || usb_transport_is_queued((const uint8_t*)snap_line)) {
+        return false;
+    }
+
+    snap_source = SNAP_SOURCE_SW;
+    trigger_tick = HAL_GetTick();
+    trigger_cycles = cycle_counter_now();
+    state = SNAP_STATE_PENDING;
+    return true;
+}
+
+/**
+ * @brief Arm a snap on the next trigger input edge
+ */
+bool snap_arm_gpio(void)
+{
+    if (state != SNAP_STATE_IDLE || usb_transport_is_queued((const uint8_t*)snap_line)) {
+        return false;
+    }
+
+    state = SNAP_STATE_WAIT_EDGE;
+    return true;
+}
+
+/**
+ * @brief Cancel an armed or pending snap
+ */
+void snap_cancel(void)
+{
+    state = SNAP_STATE_IDLE;
+}
+
+/**
+ * @brief Trigger input edge
+ */
+void snap_trigger_input(uint32_t edge_cycles)
+{
+    if (state != SNAP_STATE_WAIT_EDGE) {
+        return;
+    }
+
+    snap_source = SNAP_SOURCE_GPIO;
+    trigger_tick = HAL_GetTick();
+    trigger_cycles = edge_cycles;
+    state = SNAP_STATE_PENDING;
+}
+
+/**
+ * @brief Deliver a pending snap
+ */
+HOTPATH_FUNC bool snap_on_readout(const CCD_Frame_t* frame, uint16_t frame_size,
+                                  uint32_t readout_cycles)
+{
+    if (state != SNAP_STATE_PENDING) {
+        return false;
+    }
+
+    // Line and frame must go out back to back; otherwise try the next readout
+    if (usb_transport_queue_space() < 2) {
+        return false;
+    }
+
+    uint32_t now = cycle_counter_now();
+    Resp_Buffer_t r;
+
+    resp_init(&r, snap_line, sizeof(snap_line));
+    resp_str(&r, "SNAP:");
+    resp_kv_u32(&r, "SEQ", frame->frame_counter);
+    resp_kv_str(&r, "SOURCE", (snap_source == SNAP_SOURCE_GPIO) ? "GPIO" : "SW");
+    resp_kv_u32(&r, "TRIG_MS", trigger_tick);
+    resp_kv_u32(&r, "LATENCY_US", cycle_counter_to_us(readout_cycles - trigger_cycles));
+    resp_kv_u32(&r, "PROC_US", cycle_counter_to_us(now - readout_cycles));
+    resp_end(&r);
+
+    usb_transport_queue_direct((const uint8_t*)snap_line, resp_len(&r));
+    usb_transport_queue_direct((const uint8_t*)frame, frame_size);
+
+    state = SNAP_STATE_IDLE;
+    return true;
+}
+
+/**
+ * @brief Current snap state
+ */
+Snap_State_t snap_get_state(void)
+{
+    return state;
+}
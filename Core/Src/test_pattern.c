@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ * @file    test_pattern.c
+ * @brief   Synthetic pixel data implementation
+ ******************************************************************************
+ */
+
+#include "test_pattern.h"
+#include "ccd_data_layer.h"
+#include "hotpath.h"
+
+/* Private variables */
+static volatile Test_Pattern_t current_pattern = TEST_PATTERN_OFF;
+static volatile uint16_t const_value = TEST_PATTERN_CONST_DEFAULT;
+
+static const char* const pattern_names[TEST_PATTERN_COUNT] = {
+    "OFF", "RAMP", "CONST", "PRBS", "COUNTER"
+};
+
+/**
+ * @brief 32-bit integer hash (lowbias32)
+ */
+static inline uint32_t lowbias32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352DUL;
+    x ^= x >> 15;
+    x *= 0x846CA68BUL;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Select a pattern
+ */
+void test_pattern_set(Test_Pattern_t pattern, uint16_t value)
+{
+    if (pattern >= TEST_PATTERN_COUNT) {
+        return;
+    }
+    const_value = value;
+    current_pattern = pattern;
+}
+
+/**
+ * @brief Pattern in use
+ */
+Test_Pattern_t test_pattern_get(void)
+{
+    return current_pattern;
+}
+
+/**
+ * @brief Name of a pattern
+ */
+const char* test_pattern_name(Test_Pattern_t pattern)
+{
+    return (pattern < TEST_PATTERN_COUNT) ? pattern_names[pattern] : "?";
+}
+
+/**
+ * @brief Look up a pattern by name (case-insensitive)
+ */
+bool test_pattern_from_name(const char* name, Test_Pattern_t* pattern)
+{
+    for (uint32_t p = 0; p < TEST_PATTERN_COUNT; p++) {
+        const char* a = name;
+        const char* b = pattern_names[p];
+
+        while (*a != '\0' && (*a & ~0x20) == *b) {
+            a++;
+            b++;
+        }
+        if (*a == '\0' && *b == '\0') {
+            *pattern = (Test_Pattern_t)p;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Overwrite the ADC buffer with the pattern
+ */
+HOTPATH_FUNC void test_pattern_fill(volatile uint16_t* buffer, uint16_t seq, uint8_t bits)
+{
+    Test_Pattern_t pattern = current_pattern;
+    uint16_t mask = (uint16_t)((1U << bits) - 1U);
+    uint32_t i;
+
+    switch (pattern) {
+        case TEST_PATTERN_RAMP:
+            for (i = 0; i < CCD_PIXEL_COUNT; i++) {
+                buffer[i] = (uint16_t)((i + seq) & 0x0FFF & mask);
+            }
+            break;
+
+        case TEST_PATTERN_CONST: {
+            uint16_t value = const_value & mask;
+            for (i = 0; i < CCD_PIXEL_COUNT; i++) {
+                buffer[i] = value;
+            }
+            break;
+        }
+
+        case TEST_PATTERN_PRBS: {
+            uint32_t base = (uint32_t)seq * 0x9E3779B1UL;
+            for (i = 0; i < CCD_PIXEL_COUNT; i++) {
+                buffer[i] = (uint16_t)((lowbias32(base + i) >> 20) & mask);
+            }
+            break;
+        }
+
+        case TEST_PATTERN_COUNTER: {
+            uint32_t base = (uint32_t)seq * CCD_PIXEL_COUNT;
+            for (i = 0; i < CCD_PIXEL_COUNT; i++) {
+                buffer[i] = (uint16_t)((base + i) & 0x0FFF & mask);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ * @file    trace.c
+ * @brief   Readout latency trace implementation
+ ******************************************************************************
+ * @attention
+ *
+ * Packets are double-buffered like the band packets: a buffer still queued
+ * for USB is never rewritten; if both are queued the packet is dropped.
+ *
+ ******************************************************************************
+ */
+
+#include "trace.h"
+#include "usb_transport.h"
+#include "cycle_counter.h"
+#include "main.h"
+#include "hotpath.h"
+#include <string.h>
+
+extern TIM_HandleTypeDef htim2;
+
+static const uint8_t TRACE_MARKER[4] = {'T', 'R', 'C', 'E'};
+
+/* Packet buffers (written by the ADC callback) */
+static uint8_t packets[2][TRACE_PACKET_SIZE] __attribute__((aligned(4)));
+static uint8_t packet_next = 0;
+static volatile bool enabled = false;
+static volatile uint32_t dropped_count = 0;
+
+/**
+ * @brief Cycle count of the last ICG edge at or before a given cycle count
+ */
+HOTPATH_FUNC static uint32_t last_icg_edge(uint32_t before_cycles)
+{
+    TIM_TypeDef* tim = htim2.Instance;
+    uint32_t now = cycle_counter_now();
+    uint32_t count = tim->CNT;
+    uint32_t period = tim->ARR + 1U;
+    uint32_t scale = tim->PSC + 1U;
+
+    // PWM1: ICG is high from the update event until the counter reaches CCR1
+    uint32_t edge = tim->CCR1;
+    uint32_t since = (count >= edge) ? (count - edge) : (count + period - edge);
+    uint32_t icg = now - since * scale;
+
+    // An edge after the DMA completed belongs to the next readout
+    if ((int32_t)(icg - before_cycles) > 0) {
+        icg -= period * scale;
+    }
+    return icg;
+}
+
+/**
+ * @brief Enable or disable trace packets
+ */
+void trace_set_enabled(bool on)
+{
+    enabled = on;
+}
+
+/**
+ * @brief Check whether trace packets are enabled
+ */
+bool trace_is_enabled(void)
+{
+    return enabled;
+}
+
+/**
+ * @brief Queue the trace packet for a processed readout
+ */
+HOTPATH_FUNC void trace_on_readout(const CCD_Frame_t* frame, uint32_t dma_cycles,
+                                   uint32_t ready_cycles, uint32_t submit_cycles, bool sent)
+{
+    if (!enabled) {
+        return;
+    }
+
+    uint8_t index = packet_next;
+    if (usb_transport_is_queued(packets[index])) {
+        index ^= 1;
+        if (usb_transport_is_queued(packets[index])) {
+            dropped_count++;
+            return;
+        }
+    }
+
+    uint8_t* packet = packets[index];
+    uint32_t stamps[5];
+
+    stamps[0] = HAL_GetTick();
+    stamps[1] = last_icg_edge(dma_cycles);
+    stamps[2] = dma_cycles;
+    stamps[3] = ready_cycles;
+    stamps[4] = sent ? submit_cycles : 0;
+
+    memcpy(packet, TRACE_MARKER, 4);
+    memcpy(&packet[4], (const void*)&frame->frame_counter, 2);
+    packet[6] = sent ? TRACE_FLAG_SENT : 0;
+    packet[7] = (uint8_t)(SystemCoreClock / 1000000U);
+    memcpy(&packet[8], stamps, sizeof(stamps));
+
+    uint16_t crc = ccd_data_layer_calculate_crc16(packet, TRACE_PACKET_SIZE - 2);
+    memcpy(&packet[TRACE_PACKET_SIZE - 2], &crc, 2);
+
+    if (usb_transport_queue_direct(packet, TRACE_PACKET_SIZE)) {
+        packet_next = index ^ 1;
+    } else {
+        dropped_count++;
+    }
+}
+
+/**
+ * @brief Trace packets that could not be queued
+ */
+uint32_t trace_get_dropped_count(void)
+{
+    return dropped_count;
+}
@@ -8,8 +8,14 @@
 #include "usb_transport.h"
 #include "ring_buffer.h"
 #include "usbd_cdc_if.h"
+#include "usb_device.h"
+#include "cycle_counter.h"
+#include "hotpath.h"
 #include <string.h>
 
+/* How long to wait for the profile-change response to drain before re-init */
+#define USB_REINIT_FLUSH_TIMEOUT_MS  100
+
 /* Private variables */
 static volatile uint8_t rx_buffer_storage[USB_RX_BUFFER_SIZE];
 static volatile uint8_t tx_buffer_storage[USB_TX_BUFFER_SIZE];
@@ -18,11 +24,69 @@ static ring_buffer_t rx_ring_buffer;
 static ring_buffer_t tx_ring_buffer;
 
 static volatile bool tx_in_progress = false;
+static volatile bool rx_paused = false;     // OUT endpoint left un-armed (ring full)
+static volatile uint32_t tx_start_tick = 0; // When the in-flight transfer was submitted
+static volatile uint16_t tx_active_length = 0;  // Bytes in the in-flight transfer
+static volatile bool tx_active_text = false;    // In-flight transfer is response text
+static bool tx_line_open = false;           // ... and stops short of a line end
+static bool tx_line_cut = false;            // Next response chunk starts with '\n'
+
+/* Host presence (control endpoint callbacks) */
+static volatile bool host_configured = false;
+static volatile bool host_dtr = false;
+static volatile bool host_dtr_seen = false;
+static volatile bool host_closed_pending = false;   // DTR dropped; main loop cleans up
 
 static usb_transport_stats_t stats = {0};
 
+/* Binary transfer queue (filled from ISRs and the main loop) */
+typedef struct {
+    const uint8_t *data;
+    uint16_t length;
+} tx_desc_t;
+
+static tx_desc_t tx_queue[USB_TX_QUEUE_DEPTH];
+static volatile uint8_t txq_head = 0;       // Next transfer to start
+static volatile uint8_t txq_tail = 0;       // Next free entry
+static const uint8_t * volatile txq_active = NULL;   // Queued buffer in flight
+
+/* Throughput test state */
+typedef enum {
+    TPUT_IDLE = 0,
+    TPUT_RUNNING,
+    TPUT_DONE
+} tput_state_t;
+
+static uint8_t tput_pattern[USB_TPUT_MAX_CHUNK + 256];   // byte i = i & 0xFF
+static volatile tput_state_t tput_state = TPUT_IDLE;
+static uint32_t tput_total = 0;
+static uint32_t tput_sent = 0;
+static uint16_t tput_chunk = 0;
+static uint16_t tput_inflight = 0;
+static uint32_t tput_t_start = 0;
+static uint32_t tput_t_submit = 0;
+static uint32_t tput_t_complete = 0;
+static uint32_t tput_xfer_min = 0;
+static uint32_t tput_xfer_max = 0;
+static uint32_t tput_gap_min = 0;
+static uint32_t tput_gap_max = 0;
+static uint64_t tput_gap_sum = 0;
+static usb_throughput_result_t tput_result;
+
+/* Deferred re-initialisation (FIFO profile change) */
+static volatile bool reinit_pending = false;
+static uint32_t reinit_request_tick = 0;
+
 /* Private function prototypes */
 static void tx_flush(void);
+static uint32_t tx_abort(void);
+static void tx_cut_line(void);
+static void txq_start_next(void);
+static inline uint32_t irq_lock(void);
+static inline void irq_unlock(uint32_t primask);
+static void rx_try_resume(void);
+static bool tput_submit_next(void);
+static void tput_on_complete(void);
 
 /**
  * @brief Initialize the USB transport layer
@@ -34,6 +98,13 @@ void usb_transport_init(void)
     ring_buffer_init(&tx_ring_buffer, tx_buffer_storage, USB_TX_BUFFER_SIZE);
 
     tx_in_progress = false;
+    rx_paused = false;
+
+    // Throughput test pattern: stream byte n always carries (n & 0xFF)
+    for (uint32_t i = 0; i < sizeof(tput_pattern); i++) {
+        tput_pattern[i] = (uint8_t)i;
+    }
+    tput_state = TPUT_IDLE;
 
     // Reset statistics
     usb_transport_reset_stats();
@@ -44,9 +115,86 @@ void usb_transport_init(void)
  */
 void usb_transport_process(void)
 {
-    // Try to flush TX buffer if not already transmitting
-    if (!tx_in_progress && !ring_buffer_is_empty(&tx_ring_buffer)) {
-        tx_flush();
+    // Apply a pending FIFO profile change once the response has gone out
+    if (reinit_pending) {
+        bool drained = !tx_in_progress && ring_buffer_is_empty(&tx_ring_buffer);
+        if (drained || (HAL_GetTick() - reinit_request_tick) > USB_REINIT_FLUSH_TIMEOUT_MS) {
+            reinit_pending = false;
+            MX_USB_DEVICE_Reinit();
+            ring_buffer_clear(&rx_ring_buffer);
+            ring_buffer_clear(&tx_ring_buffer);
+            txq_head = txq_tail = 0;
+            txq_active = NULL;
+            tx_in_progress = false;
+            rx_paused = false;   // Class init arms the OUT endpoint again
+        }
+        return;
+    }
+
+    // Host closed the port: whatever is queued or in flight is for nobody
+    if (host_closed_pending) {
+        host_closed_pending = false;
+        tx_abort();
+        ring_buffer_clear(&tx_ring_buffer);
+        tx_line_cut = false;
+        stats.host_closes++;
+    }
+
+    // A transfer the host never collects would hold TxState busy forever
+    if (tx_in_progress && (HAL_GetTick() - tx_start_tick) > USB_TX_TIMEOUT_MS) {
+        // IN packets are 64 bytes, like OUT packets
+        uint32_t packets = (tx_active_length + USB_RX_PACKET_SIZE - 1U) / USB_RX_PACKET_SIZE;
+        bool text = tx_active_text;
+        uint32_t unsent = tx_abort();
+
+        stats.tx_timeouts++;
+        // Part of it already reached the host, which now holds a cut frame,
+        // packet or line; frames and packets resync on their markers
+        if (unsent > 0 && unsent < packets) {
+            stats.tx_truncated++;
+        }
+        if (text && unsent > 0) {
+            tx_cut_line();
+        }
+    }
+
+    // Nothing goes out without a host; commands are still accepted
+    if (!usb_transport_host_present()) {
+        rx_try_resume();
+        return;
+    }
+
+    // Throughput test owns the IN endpoint while running; the completion
+    // callback chains transfers, this only (re)starts the chain. Responses
+    // queued before the test (e.g. "OK:USB_TPUT") go out first.
+    if (tput_state == TPUT_RUNNING) {
+        if (!tx_in_progress) {
+            bool started = (tput_result.transfers > 0);
+            if (!started && !ring_buffer_is_empty(&tx_ring_buffer)) {
+                tx_flush();
+            } else {
+                tput_submit_next();
+            }
+        }
+        return;
+    }
+
+    // Re-arm the OUT endpoint if the consumer has made room
+    rx_try_resume();
+
+    // Buffered responses go first and are sent whole: the completion
+    // interrupt only chains queued frames once the ring is empty, so a
+    // reply is neither split by frames nor held back while they keep
+    // arriving. The check-and-start must not be split by an ISR queueing
+    // a frame.
+    if (!tx_in_progress) {
+        uint32_t primask = irq_lock();
+        if (!ring_buffer_is_empty(&tx_ring_buffer)) {
+            tx_flush();
+        } else if (txq_head != txq_tail) {
+            txq_start_next();
+        }
+        irq_unlock(primask);
     }
 }
 
@@ -63,7 +211,9 @@ uint16_t usb_transport_available(void)
  */
 bool usb_transport_read_byte(uint8_t *data)
 {
-    return ring_buffer_read(&rx_ring_buffer, data);
+    bool success = ring_buffer_read(&rx_ring_buffer, data);
+    rx_try_resume();
+    return success;
 }
 
 /**
@@ -71,7 +221,9 @@ bool usb_transport_read_byte(uint8_t *data)
  */
 uint16_t usb_transport_read(uint8_t *buffer, uint16_t length)
 {
-    return ring_buffer_read_multiple(&rx_ring_buffer, buffer, length);
+    uint16_t read_count = ring_buffer_read_multiple(&rx_ring_buffer, buffer, length);
+    rx_try_resume();
+    return read_count;
 }
 
 /**
@@ -103,6 +255,7 @@ uint16_t usb_transport_read_line(char *buffer, uint16_t max_length)
 
             // Add null terminator
             buffer[count] = '\0';
+            rx_try_resume();
             return count;
         }
 
@@ -161,26 +314,89 @@ uint16_t usb_transport_write_string(const char *str)
  */
 bool usb_transport_send_direct(const uint8_t *buffer, uint16_t length)
 {
-    if (tx_in_progress) {
-        return false;  // USB busy
+    bool sent = false;
+    uint32_t primask = irq_lock();
+
+    // Queued transfers keep their order, buffered responses go first
+    if (!tx_in_progress && txq_head == txq_tail && ring_buffer_is_empty(&tx_ring_buffer)) {
+        if (CDC_Transmit_FS((uint8_t*)buffer, length) == USBD_OK) {
+            tx_in_progress = true;
+            tx_start_tick = HAL_GetTick();
+            tx_active_length = length;
+            tx_active_text = false;
+            stats.tx_bytes_total += length;
+            sent = true;
+        }
     }
 
-    // Send directly via USB CDC
-    uint8_t result = CDC_Transmit_FS((uint8_t*)buffer, length);
+    irq_unlock(primask);
+    return sent;
+}
 
-    if (result == USBD_OK) {
-        tx_in_progress = true;
-        stats.tx_bytes_total += length;
-        return true;
+/**
+ * @brief Queue a binary transfer
+ */
+HOTPATH_FUNC bool usb_transport_queue_direct(const uint8_t *buffer, uint16_t length)
+{
+    uint32_t primask = irq_lock();
+    uint8_t next = (uint8_t)((txq_tail + 1) % USB_TX_QUEUE_DEPTH);
+
+    // No host: refuse quietly, this is not a congestion drop
+    if (!usb_transport_host_present()) {
+        irq_unlock(primask);
+        return false;
+    }
+
+    if (next == txq_head) {
+        stats.tx_queue_drops++;
+        irq_unlock(primask);
+        return false;
+    }
+
+    tx_queue[txq_tail].data = buffer;
+    tx_queue[txq_tail].length = length;
+    txq_tail = next;
+
+    if (!tx_in_progress) {
+        txq_start_next();
+    }
+
+    irq_unlock(primask);
+    return true;
+}
+
+/**
+ * @brief Free entries in the binary transfer queue
+ */
+uint8_t usb_transport_queue_space(void)
+{
+    uint8_t used = (uint8_t)((txq_tail + USB_TX_QUEUE_DEPTH - txq_head) % USB_TX_QUEUE_DEPTH);
+    return (uint8_t)(USB_TX_QUEUE_DEPTH - 1 - used);
+}
+
+/**
+ * @brief Check whether a buffer is still queued or being transmitted
+ */
+HOTPATH_FUNC bool usb_transport_is_queued(const uint8_t *buffer)
+{
+    bool queued = false;
+    uint32_t primask = irq_lock();
+
+    if (txq_active == buffer) {
+        queued = true;
+    }
+    for (uint8_t i = txq_head; i != txq_tail && !queued; i = (uint8_t)((i + 1) % USB_TX_QUEUE_DEPTH)) {
+        queued = (tx_queue[i].data == buffer);
     }
 
-    return false;
+    irq_unlock(primask);
+    return queued;
 }
 
 /**
  * @brief Called by USB CDC receive callback
  */
-void usb_transport_rx_callback(uint8_t *buffer, uint32_t length)
+bool usb_transport_rx_callback(uint8_t *buffer, uint32_t length)
 {
     // Write received data to ring buffer
     uint16_t written = ring_buffer_write_multiple(&rx_ring_buffer, buffer, (uint16_t)length);
@@ -188,7 +404,32 @@ void usb_transport_rx_callback(uint8_t *buffer, uint32_t length)
     stats.rx_bytes_total += written;
 
     if (written < length) {
-        stats.rx_overflow_count++;
+        stats.rx_overflow_count++;  // Cannot happen while flow control holds
+    }
+
+    // Only accept another packet if it is guaranteed to fit; otherwise leave
+    // the endpoint un-armed so the host is NAKed until we catch up
+    if (ring_buffer_free_space(&rx_ring_buffer) < USB_RX_PACKET_SIZE) {
+        rx_paused = true;
+        stats.rx_pause_count++;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Re-arm the OUT endpoint once a full packet fits again (private)
+ */
+static void rx_try_resume(void)
+{
+    if (!rx_paused) {
+        return;
+    }
+
+    if (ring_buffer_free_space(&rx_ring_buffer) >= USB_RX_PACKET_SIZE) {
+        rx_paused = false;
+        CDC_ResumeReceive_FS();
     }
 }
 
@@ -200,6 +441,14 @@ bool usb_transport_is_tx_busy(void)
     return tx_in_progress;
 }
 
+/**
+ * @brief Check that no transfer is in flight and no response is queued
+ */
+bool usb_transport_tx_idle(void)
+{
+    return !tx_in_progress && ring_buffer_is_empty(&tx_ring_buffer);
+}
+
 /**
  * @brief Flush TX buffer to USB (private function)
  */
@@ -217,15 +466,29 @@ static void tx_flush(void)
     }
 
     // Limit to reasonable packet size (USB CDC typically uses 64 byte packets)
-    uint16_t to_send = (available > 64) ? 64 : available;
+    static uint8_t temp_buffer[64];
+    uint16_t offset = 0;
+
+    // End a line the watchdog cut, so the host does not join it to this one
+    if (tx_line_cut) {
+        temp_buffer[offset++] = '\n';
+    }
+    uint16_t to_send = (available > sizeof(temp_buffer) - offset) ?
+                       (uint16_t)(sizeof(temp_buffer) - offset) : available;
 
     // Copy data from ring buffer to temporary buffer
-    static uint8_t temp_buffer[64];
-    uint16_t read_count = ring_buffer_read_multiple(&tx_ring_buffer, temp_buffer, to_send);
+    uint16_t read_count = offset + ring_buffer_read_multiple(&tx_ring_buffer, &temp_buffer[offset], to_send);
 
     // Send via USB CDC
     if (CDC_Transmit_FS(temp_buffer, read_count) == USBD_OK) {
         tx_in_progress = true;
+        tx_start_tick = HAL_GetTick();
+        tx_active_length = read_count;
+        tx_active_text = true;
+        tx_line_open = (temp_buffer[read_count - 1] != '\n');
+        tx_line_cut = false;
+    } else if (offset > 0) {
+        ring_buffer_write_multiple(&tx_ring_buffer, &temp_buffer[offset], read_count - offset);
     } else {
         // Failed to send - put data back in ring buffer
         // (This is a simplification - in production might want better error handling)
@@ -233,12 +496,297 @@ static void tx_flush(void)
     }
 }
 
+/**
+ * @brief Start the oldest queued transfer (ISR context or IRQs locked)
+ */
+HOTPATH_FUNC static void txq_start_next(void)
+{
+    // The throughput test and a pending re-init own the endpoint
+    if (txq_head == txq_tail || tput_state == TPUT_RUNNING || reinit_pending ||
+        !usb_transport_host_present()) {
+        return;
+    }
+
+    tx_desc_t *desc = &tx_queue[txq_head];
+
+    if (CDC_Transmit_FS((uint8_t*)desc->data, desc->length) == USBD_OK) {
+        txq_active = desc->data;
+        txq_head = (uint8_t)((txq_head + 1) % USB_TX_QUEUE_DEPTH);
+        tx_in_progress = true;
+        tx_start_tick = HAL_GetTick();
+        tx_active_length = desc->length;
+        tx_active_text = false;
+        stats.tx_bytes_total += desc->length;
+    }
+}
+
+/**
+ * @brief Abort the in-flight transfer and drop queued ones (main loop)
+ *
+ * Queued buffers are released (usb_transport_is_queued() turns false) so
+ * their owners can reuse them. A running throughput test is abandoned.
+ * Returns the packets of the in-flight transfer that never went out.
+ */
+static uint32_t tx_abort(void)
+{
+    uint32_t unsent = 0;
+    uint32_t primask = irq_lock();
+
+    if (tx_in_progress) {
+        unsent = CDC_AbortTransmit_FS();
+    }
+    tx_in_progress = false;
+    tx_active_text = false;
+    txq_head = txq_tail = 0;
+    txq_active = NULL;
+
+    if (tput_state == TPUT_RUNNING) {
+        tput_inflight = 0;
+        tput_state = TPUT_IDLE;
+    }
+
+    irq_unlock(primask);
+    return unsent;
+}
+
+/**
+ * @brief Resync the response stream after a response chunk was cut (main loop)
+ *
+ * The host splits responses on '\n'. The rest of the cut line is dropped and
+ * the next chunk starts with a line end, so the following response arrives
+ * on a line of its own.
+ */
+static void tx_cut_line(void)
+{
+    uint8_t c = 0;
+
+    if (tx_line_open) {
+        while (c != '\n' && ring_buffer_read(&tx_ring_buffer, &c)) {
+        }
+    }
+    tx_line_open = false;
+    tx_line_cut = true;
+}
+
+static inline uint32_t irq_lock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void irq_unlock(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
 /**
  * @brief Transmission complete callback (to be called from USB CDC)
  */
-void usb_transport_tx_complete_callback(void)
+HOTPATH_FUNC void usb_transport_tx_complete_callback(void)
 {
     tx_in_progress = false;
+    txq_active = NULL;
+
+    if (tput_state == TPUT_RUNNING && tput_inflight > 0) {
+        tput_on_complete();
+        return;
+    }
+
+    // The rest of a buffered response goes out from the main loop before
+    // any frame; otherwise chain the next queued frame straight from here
+    if (!ring_buffer_is_empty(&tx_ring_buffer)) {
+        return;
+    }
+    txq_start_next();
+}
+
+/**
+ * @brief CDC SET_CONTROL_LINE_STATE (control endpoint interrupt)
+ */
+void usb_transport_line_state_callback(uint16_t line_state)
+{
+    bool dtr = (line_state & 0x0001U) != 0;
+
+    if (host_dtr && !dtr) {
+        host_closed_pending = true;
+    }
+    if (dtr) {
+        host_dtr_seen = true;
+    }
+    host_dtr = dtr;
+}
+
+/**
+ * @brief CDC class init / de-init (USB interrupt)
+ */
+void usb_transport_class_state_callback(bool configured)
+{
+    host_configured = configured;
+
+    // A new enumeration is a new host session: DTR handling starts over
+    host_dtr = false;
+    host_dtr_seen = false;
+
+    if (!configured && !reinit_pending) {
+        // Reset or unplug: an in-flight transfer will never complete
+        host_closed_pending = tx_in_progress || (txq_head != txq_tail);
+    }
+}
+
+/**
+ * @brief Check whether a host is there to receive data
+ */
+bool usb_transport_host_present(void)
+{
+    return host_configured && (host_dtr || !host_dtr_seen);
+}
+
+/**
+ * @brief Start a device-side bulk IN throughput test
+ */
+bool usb_transport_throughput_start(uint32_t total_bytes, uint16_t chunk)
+{
+    if (tput_state == TPUT_RUNNING || total_bytes == 0 ||
+        chunk == 0 || chunk > USB_TPUT_MAX_CHUNK) {
+        return false;
+    }
+
+    tput_total = total_bytes;
+    tput_sent = 0;
+    tput_chunk = chunk;
+    tput_inflight = 0;
+    tput_xfer_min = UINT32_MAX;
+    tput_xfer_max = 0;
+    tput_gap_min = UINT32_MAX;
+    tput_gap_max = 0;
+    tput_gap_sum = 0;
+
+    memset(&tput_result, 0, sizeof(tput_result));
+    tput_result.fifo_profile = USBD_LL_GetFifoProfile();
+    tput_result.chunk = chunk;
+
+    // First transfer is submitted from usb_transport_process() once any
+    // pending response bytes have left the endpoint
+    tput_state = TPUT_RUNNING;
+    return true;
+}
+
+/**
+ * @brief Fetch the result of a finished throughput test
+ */
+bool usb_transport_throughput_get_result(usb_throughput_result_t *result)
+{
+    if (tput_state != TPUT_DONE) {
+        return false;
+    }
+
+    *result = tput_result;
+    tput_state = TPUT_IDLE;
+    return true;
+}
+
+/**
+ * @brief Submit the next throughput test transfer (main loop or USB ISR)
+ */
+static bool tput_submit_next(void)
+{
+    uint32_t remaining = tput_total - tput_sent;
+    uint16_t len = (remaining > tput_chunk) ? tput_chunk : (uint16_t)remaining;
+
+    // The completion interrupt can fire before CDC_Transmit_FS() returns:
+    // mark the transfer in flight first, with the interrupt held off
+    uint32_t primask = irq_lock();
+    uint32_t now = cycle_counter_now();
+    tput_inflight = len;
+    tx_in_progress = true;
+    tx_active_length = len;
+    tx_active_text = false;
+
+    if (CDC_Transmit_FS(&tput_pattern[tput_sent & 0xFF], len) != USBD_OK) {
+        tput_inflight = 0;
+        tx_in_progress = false;
+        irq_unlock(primask);
+        return false;  // Retried from usb_transport_process()
+    }
+
+    if (tput_result.transfers == 0) {
+        tput_t_start = now;
+    } else {
+        uint32_t gap = now - tput_t_complete;
+        if (gap < tput_gap_min) tput_gap_min = gap;
+        if (gap > tput_gap_max) tput_gap_max = gap;
+        tput_gap_sum += gap;
+    }
+
+    tput_t_submit = now;
+    tx_start_tick = HAL_GetTick();
+    stats.tx_bytes_total += len;
+    irq_unlock(primask);
+    return true;
+}
+
+/**
+ * @brief Account for a completed throughput transfer and chain the next one
+ */
+static void tput_on_complete(void)
+{
+    uint32_t now = cycle_counter_now();
+    uint32_t xfer = now - tput_t_submit;
+
+    if (xfer < tput_xfer_min) tput_xfer_min = xfer;
+    if (xfer > tput_xfer_max) tput_xfer_max = xfer;
+
+    tput_sent += tput_inflight;
+    tput_inflight = 0;
+    tput_result.transfers++;
+    tput_t_complete = now;
+
+    if (tput_sent < tput_total) {
+        // Resubmit straight from the completion interrupt to keep the IN
+        // endpoint busy; a failure here is retried from the main loop
+        tput_submit_next();
+        return;
+    }
+
+    uint32_t elapsed_us = cycle_counter_to_us(now - tput_t_start);
+    uint32_t gaps = tput_result.transfers - 1;
+
+    tput_result.bytes = tput_sent;
+    tput_result.elapsed_us = elapsed_us;
+    tput_result.bytes_per_sec = (elapsed_us > 0) ?
+        (uint32_t)(((uint64_t)tput_sent * 1000000U) / elapsed_us) : 0;
+    tput_result.xfer_min_us = cycle_counter_to_us(tput_xfer_min);
+    tput_result.xfer_max_us = cycle_counter_to_us(tput_xfer_max);
+    tput_result.gap_min_us = (gaps > 0) ? cycle_counter_to_us(tput_gap_min) : 0;
+    tput_result.gap_max_us = cycle_counter_to_us(tput_gap_max);
+    tput_result.gap_avg_us = (gaps > 0) ?
+        cycle_counter_to_us((uint32_t)(tput_gap_sum / gaps)) : 0;
+
+    tput_state = TPUT_DONE;
+}
+
+/**
+ * @brief Select an OTG FIFO profile and re-enumerate
+ */
+bool usb_transport_set_fifo_profile(uint8_t profile)
+{
+    if (profile >= USBD_FIFO_PROFILE_COUNT || tput_state == TPUT_RUNNING) {
+        return false;
+    }
+
+    USBD_LL_SetFifoProfile(profile);
+    reinit_request_tick = HAL_GetTick();
+    reinit_pending = true;
+    return true;
+}
+
+/**
+ * @brief Get the OTG FIFO profile in use
+ */
+uint8_t usb_transport_get_fifo_profile(void)
+{
+    return USBD_LL_GetFifoProfile();
 }
 
 /**
@@ -250,6 +798,11 @@ void usb_transport_get_stats(usb_transport_stats_t *stats_out)
     stats_out->tx_bytes_total = stats.tx_bytes_total;
     stats_out->rx_overflow_count = stats.rx_overflow_count;
     stats_out->tx_overflow_count = stats.tx_overflow_count;
+    stats_out->rx_pause_count = stats.rx_pause_count;
+    stats_out->tx_queue_drops = stats.tx_queue_drops;
+    stats_out->tx_timeouts = stats.tx_timeouts;
+    stats_out->tx_truncated = stats.tx_truncated;
+    stats_out->host_closes = stats.host_closes;
 }
 
 /**
@@ -261,4 +814,9 @@ void usb_transport_reset_stats(void)
     stats.tx_bytes_total = 0;
     stats.rx_overflow_count = 0;
     stats.tx_overflow_count = 0;
+    stats.rx_pause_count = 0;
+    stats.tx_queue_drops = 0;
+    stats.tx_timeouts = 0;
+    stats.tx_truncated = 0;
+    stats.host_closes = 0;
 }
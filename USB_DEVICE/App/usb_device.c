@@ -37,6 +37,7 @@
 
 /* USER CODE BEGIN PFP */
 /* Private function prototypes -----------------------------------------------*/
+void USBD_LL_ApplyFifoProfile(USBD_HandleTypeDef *pdev);   // usbd_conf.c
 
 /* USER CODE END PFP */
 
@@ -55,6 +56,18 @@ USBD_HandleTypeDef hUsbDeviceFS;
  */
 /* USER CODE BEGIN 1 */
 
+/**
+  * Stop the device, tear down the stack and start it again. The host sees a
+  * disconnect/re-enumeration; used to apply a new OTG FIFO profile.
+  * @retval None
+  */
+void MX_USB_DEVICE_Reinit(void)
+{
+  USBD_Stop(&hUsbDeviceFS);
+  USBD_DeInit(&hUsbDeviceFS);
+  MX_USB_DEVICE_Init();
+}
+
 /* USER CODE END 1 */
 
 /**
@@ -86,6 +99,7 @@ void MX_USB_DEVICE_Init(void)
   }
 
   /* USER CODE BEGIN USB_DEVICE_Init_PostTreatment */
+  USBD_LL_ApplyFifoProfile(&hUsbDeviceFS);
 
   /* USER CODE END USB_DEVICE_Init_PostTreatment */
 }
@@ -81,7 +81,7 @@ void MX_USB_DEVICE_Init(void);
  * -- Insert functions declaration here --
  */
 /* USER CODE BEGIN FD */
-
+void MX_USB_DEVICE_Reinit(void);
 /* USER CODE END FD */
 /**
   * @}
@@ -62,6 +62,8 @@
   */
 
 /* USER CODE BEGIN PRIVATE_DEFINES */
+/* Polls of DIEPINT for EPDISD before giving up (as HAL USB_EPStopXfer) */
+#define CDC_EP_DISABLE_TIMEOUT  10000U
 /* USER CODE END PRIVATE_DEFINES */
 
 /**
@@ -155,6 +157,7 @@ static int8_t CDC_Init_FS(void)
   /* Set Application Buffers */
   USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, 0);
   USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  usb_transport_class_state_callback(true);
   return (USBD_OK);
   /* USER CODE END 3 */
 }
@@ -166,6 +169,7 @@ static int8_t CDC_Init_FS(void)
 static int8_t CDC_DeInit_FS(void)
 {
   /* USER CODE BEGIN 4 */
+  usb_transport_class_state_callback(false);
   return (USBD_OK);
   /* USER CODE END 4 */
 }
@@ -228,7 +232,8 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
     break;
 
     case CDC_SET_CONTROL_LINE_STATE:
-
+      /* No data stage: pbuf is the setup request, wValue bit 0 = DTR, bit 1 = RTS */
+      usb_transport_line_state_callback(((USBD_SetupReqTypedef *)pbuf)->wValue);
     break;
 
     case CDC_SEND_BREAK:
@@ -261,10 +266,12 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
   /* USER CODE BEGIN 6 */
-	usb_transport_rx_callback(Buf, *Len);  // ← ADDED
-
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  // Hand the packet to the transport; if its ring is nearly full the OUT
+  // endpoint stays un-armed (host gets NAKs) until CDC_ResumeReceive_FS()
+  if (usb_transport_rx_callback(Buf, *Len)) {
+    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
+    USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  }
   return (USBD_OK);
   /* USER CODE END 6 */
 }
@@ -285,6 +292,9 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
   uint8_t result = USBD_OK;
   /* USER CODE BEGIN 7 */
   USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
+  if (hcdc == NULL){
+    return USBD_FAIL;   /* Not configured (unplugged or re-enumerating) */
+  }
   if (hcdc->TxState != 0){
     return USBD_BUSY;
   }
@@ -322,6 +332,61 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+/**
+  * @brief  CDC_ResumeReceive_FS
+  *         Re-arm the OUT endpoint after CDC_Receive_FS left it un-armed.
+  *         Called from the main loop, so the OTG interrupt is masked while
+  *         the endpoint registers are touched.
+  * @retval None
+  */
+void CDC_ResumeReceive_FS(void)
+{
+  HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+}
+
+/**
+  * @brief  CDC_AbortTransmit_FS
+  *         Drop an IN transfer the host never collected: NAK and disable
+  *         the IN endpoint, flush its FIFO, then release TxState so the
+  *         next CDC_Transmit_FS is accepted. Flushing an enabled endpoint
+  *         would let the core keep fetching the old transfer into the FIFO.
+  *         Called from the main loop with the OTG interrupt masked.
+  * @retval Packets of the transfer that were never sent
+  */
+uint32_t CDC_AbortTransmit_FS(void)
+{
+  USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
+  PCD_HandleTypeDef *hpcd = (PCD_HandleTypeDef*)hUsbDeviceFS.pData;
+  uint32_t USBx_BASE = (uint32_t)hpcd->Instance;
+  uint32_t epnum = CDC_IN_EP & EP_ADDR_MSK;
+  uint32_t count = 0U;
+  uint32_t unsent = 0U;
+
+  HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+  if ((USBx_INEP(epnum)->DIEPCTL & USB_OTG_DIEPCTL_EPENA) == USB_OTG_DIEPCTL_EPENA)
+  {
+    USBx_INEP(epnum)->DIEPCTL |= USB_OTG_DIEPCTL_SNAK;
+    USBx_INEP(epnum)->DIEPCTL |= USB_OTG_DIEPCTL_EPDIS;
+    while (((USBx_INEP(epnum)->DIEPINT & USB_OTG_DIEPINT_EPDISD) == 0U) &&
+           (++count < CDC_EP_DISABLE_TIMEOUT))
+    {
+    }
+    USBx_INEP(epnum)->DIEPINT = USB_OTG_DIEPINT_EPDISD;   /* Handled here, not in the IRQ */
+    unsent = (USBx_INEP(epnum)->DIEPTSIZ & USB_OTG_DIEPTSIZ_PKTCNT) >> USB_OTG_DIEPTSIZ_PKTCNT_Pos;
+  }
+  USBD_LL_FlushEP(&hUsbDeviceFS, CDC_IN_EP);
+  if (hcdc != NULL)
+  {
+    hcdc->TxState = 0;
+  }
+  HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+
+  return unsent;
+}
+
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
 /**
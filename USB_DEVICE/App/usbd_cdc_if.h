@@ -56,7 +56,7 @@
 
 /* USER CODE BEGIN EXPORTED_DEFINES */
 #define APP_RX_DATA_SIZE  2048 // modified to handle the #define CCDBuffer 6000
-#define APP_TX_DATA_SIZE  16384
+#define APP_TX_DATA_SIZE  64     // Frames and responses are sent from their own buffers
 /* USER CODE END EXPORTED_DEFINES */
 
 /**
@@ -113,7 +113,8 @@ extern USBD_CDC_ItfTypeDef USBD_Interface_fops_FS;
 uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
-
+void CDC_ResumeReceive_FS(void);
+uint32_t CDC_AbortTransmit_FS(void);
 /* USER CODE END EXPORTED_FUNCTIONS */
 
 /**
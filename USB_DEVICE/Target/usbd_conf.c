@@ -37,6 +37,23 @@
 /* USER CODE BEGIN PV */
 /* Private variables ---------------------------------------------------------*/
 
+/* FIFO sizes in 32-bit words for each profile. RX + TX0 + TX1 + TX2 <= 320.
+ * RX minimum for one bulk OUT EP: (4*1 + 6) + (64/4 + 1) + (2*2) + 1 = 32 words.
+ * TX minimum per IN EP is 16 words. TX2 is the CDC notification EP (8 bytes). */
+typedef struct {
+  uint16_t rx;
+  uint16_t tx0;
+  uint16_t tx1;
+  uint16_t tx2;
+} USBD_FifoProfileTypeDef;
+
+static const USBD_FifoProfileTypeDef fifo_profiles[USBD_FIFO_PROFILE_COUNT] = {
+  /* DEFAULT  */ { 0x80, 0x40, 0x80, 0x00 },
+  /* BULK_IN  */ { 0x40, 0x10, 0xE0, 0x10 },
+  /* BALANCED */ { 0x70, 0x20, 0xA0, 0x10 },
+};
+
+static uint8_t fifo_profile = USBD_FIFO_PROFILE;
 /* USER CODE END PV */
 
 PCD_HandleTypeDef hpcd_USB_OTG_FS;
@@ -58,7 +75,63 @@ USBD_StatusTypeDef USBD_Get_USB_Status(HAL_StatusTypeDef hal_status);
 /* Private functions ---------------------------------------------------------*/
 
 /* USER CODE BEGIN 1 */
+/* USBD_static_malloc() (generated, outside the USER CODE sections) hands
+ * out one fixed block sized for the CDC class handle, the only class on this
+ * device. Allocations cannot be counted without editing generated code, so
+ * only the block's size is reported. */
 
+/**
+  * @brief  Size of the static class allocation block.
+  * @retval Bytes reserved by USBD_static_malloc()
+  */
+uint32_t USBD_static_get_capacity(void)
+{
+  return ((sizeof(USBD_CDC_HandleTypeDef) / 4U) + 1U) * 4U;   /* As in USBD_static_malloc() */
+}
+
+/**
+  * @brief  Select the FIFO profile applied by the next USBD_LL_ApplyFifoProfile().
+  * @param  profile: USBD_FIFO_PROFILE_xxx
+  * @retval None
+  */
+void USBD_LL_SetFifoProfile(uint8_t profile)
+{
+  if (profile < USBD_FIFO_PROFILE_COUNT)
+  {
+    fifo_profile = profile;
+  }
+}
+
+/**
+  * @brief  Returns the FIFO profile currently selected.
+  * @retval USBD_FIFO_PROFILE_xxx
+  */
+uint8_t USBD_LL_GetFifoProfile(void)
+{
+  return fifo_profile;
+}
+
+/**
+  * @brief  Replace the generated FIFO split with the selected profile.
+  * @note   Called right after USBD_Start(): the core is soft-disconnected
+  *         while the FIFOs are resized, long before a host could have
+  *         debounced the first connect.
+  * @param  pdev: Device handle
+  * @retval None
+  */
+void USBD_LL_ApplyFifoProfile(USBD_HandleTypeDef *pdev)
+{
+  PCD_HandleTypeDef *hpcd = (PCD_HandleTypeDef *)pdev->pData;
+  const USBD_FifoProfileTypeDef *prof = &fifo_profiles[fifo_profile];
+
+  HAL_PCD_Stop(hpcd);
+  HAL_PCDEx_SetRxFiFo(hpcd, prof->rx);
+  HAL_PCDEx_SetTxFiFo(hpcd, 0, prof->tx0);
+  HAL_PCDEx_SetTxFiFo(hpcd, 1, prof->tx1);
+  /* Always written: a size of 0 clears what the previous profile left in DIEPTXF2 */
+  HAL_PCDEx_SetTxFiFo(hpcd, 2, prof->tx2);
+  HAL_PCD_Start(hpcd);
+}
 /* USER CODE END 1 */
 
 /*******************************************************************************
@@ -35,7 +35,25 @@
 #include "stm32f4xx_hal.h"
 
 /* USER CODE BEGIN INCLUDE */
+/* OTG FS FIFO profiles - the F401 has 320 words (1.25 KB) of FIFO RAM shared
+ * between the RX FIFO and the per-endpoint TX FIFOs. The profile is applied once
+ * after USBD_Start() (USBD_LL_ApplyFifoProfile() in usbd_conf.c), so changing
+ * it at runtime requires a USB re-initialisation. */
+#define USBD_FIFO_PROFILE_DEFAULT    0U   // CubeMX layout: RX 0x80, TX0 0x40, TX1 0x80
+#define USBD_FIFO_PROFILE_BULK_IN    1U   // Minimum RX/EP0, everything else to the data IN EP
+#define USBD_FIFO_PROFILE_BALANCED   2U   // Deeper RX for uploads, data IN EP still 10 packets
+#define USBD_FIFO_PROFILE_COUNT      3U
+
+#ifndef USBD_FIFO_PROFILE
+#define USBD_FIFO_PROFILE  USBD_FIFO_PROFILE_DEFAULT   // Boot-time profile; measure before changing
+#endif
+
+/* FIFO profile selection */
+void USBD_LL_SetFifoProfile(uint8_t profile);
+uint8_t USBD_LL_GetFifoProfile(void);
 
+/* Size of the USBD_static_malloc() block (STATS) */
+uint32_t USBD_static_get_capacity(void);
 /* USER CODE END INCLUDE */
 
 /** @addtogroup USBD_OTG_DRIVER
@@ -0,0 +1,299 @@
+/**
+ ******************************************************************************
+ * @file    tcd1304_device.h
+ * @brief   C++ host SDK for the TCD1304 firmware (Tcd1304Device)
+ ******************************************************************************
+ * @attention
+ *
+ * One place for what every host script re-implements: port discovery,
+ * START/STOP and the other commands, and stream parsing.
+ *
+ *   - A background reader thread reads the tty (raw, VMIN=0/VTIME=1) into a
+ *     preallocated buffer, splits the stream into FRME/FRMX frames, skips
+ *     BAND/TRCE/MARK/PTRG packets and hands text lines to the command path.
+ *   - Frames land in a fixed FramePool. Slots are handed out through a
+ *     lock-free free list and reference counted (FrameRef); the last
+ *     reference returns the slot. Nothing is allocated per frame.
+ *   - Frames are delivered either to a callback (on the reader thread) or
+ *     to a bounded lock-free queue read with next_frame().
+ *   - When no slot is free or the queue is full the frame is dropped and
+ *     counted; the reader never blocks on the consumer.
+ *
+ * POSIX only (Linux, macOS). The C API at the end is what python/
+ * tcd1304_sdk.py loads with ctypes; it exposes pool buffers to Python
+ * without copying.
+ *
+ ******************************************************************************
+ */
+
+#ifndef TCD1304_DEVICE_H
+#define TCD1304_DEVICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tcd1304 {
+
+/* Wire format (Core/Inc/ccd_data_layer.h) */
+constexpr uint32_t kPixelCount = 3694;
+constexpr uint32_t kFrameHeaderSize = 8;
+constexpr uint32_t kFrameXHeaderSize = 12;
+constexpr uint32_t kFrameFooterSize = 6;
+constexpr uint32_t kFrameMaxSize = kFrameHeaderSize + kPixelCount * 2 + kFrameFooterSize;  // 7402
+constexpr uint8_t kFrameFlagSettling = 0x01;
+
+/**
+ * @brief One frame in the pool: bytes as received plus decoded pixels
+ */
+struct Frame {
+    uint16_t seq;                       // Frame counter
+    uint8_t bits;                       // 12 (FRME) or 10/8 (FRMX)
+    uint8_t flags;                      // FRMX flags (kFrameFlagSettling)
+    bool crc_ok;
+    uint64_t host_time_ns;              // CLOCK_MONOTONIC when the frame was complete
+    uint32_t size;                      // Bytes in raw
+    alignas(64) uint8_t raw[kFrameMaxSize];
+    alignas(64) uint16_t pixels[kPixelCount];  // Scaled to 12 bits
+
+    /* Pool bookkeeping */
+    uint32_t index;
+    std::atomic<uint32_t> refs;
+    std::atomic<uint32_t> next_free;
+};
+
+/**
+ * @brief Fixed set of frames with a lock-free free list
+ */
+class FramePool {
+public:
+    explicit FramePool(uint32_t count);
+
+    Frame* acquire();                   // nullptr when all frames are in use
+    void add_ref(Frame* frame);
+    void release(Frame* frame);
+
+    uint32_t size() const { return count_; }
+    Frame* at(uint32_t index) { return &frames_[index]; }
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    uint32_t count_;
+    std::unique_ptr<Frame[]> frames_;
+    std::atomic<uint64_t> head_;        // ABA tag << 32 | index
+};
+
+/**
+ * @brief Counted reference to a pool frame
+ */
+class FrameRef {
+public:
+    FrameRef() : frame_(nullptr), pool_(nullptr) {}
+    FrameRef(Frame* frame, FramePool* pool) : frame_(frame), pool_(pool) {}   // Adopts one reference
+    FrameRef(const FrameRef& other);
+    FrameRef(FrameRef&& other) noexcept;
+    FrameRef& operator=(FrameRef other) noexcept;
+    ~FrameRef();
+
+    const Frame* operator->() const { return frame_; }
+    const Frame& operator*() const { return *frame_; }
+    explicit operator bool() const { return frame_ != nullptr; }
+
+    Frame* detach();                    // Give up ownership without releasing
+
+private:
+    Frame* frame_;
+    FramePool* pool_;
+};
+
+/**
+ * @brief Bounded single-producer / single-consumer queue of frames
+ */
+class FrameQueue {
+public:
+    explicit FrameQueue(uint32_t capacity);
+
+    bool push(Frame* frame);            // false when full
+    Frame* pop();                       // nullptr when empty
+
+private:
+    uint32_t mask_;
+    std::unique_ptr<std::atomic<Frame*>[]> slots_;
+    std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> tail_;
+};
+
+/**
+ * @brief Stream counters
+ */
+struct Stats {
+    uint64_t bytes;
+    uint64_t reads;
+    uint64_t frames;                    // Delivered to the callback or queue
+    uint64_t pool_drops;                // No free frame
+    uint64_t queue_drops;               // Queue full
+    uint64_t seq_gaps;                  // Readouts missing between delivered frames
+    uint64_t crc_errors;
+    uint64_t packets_skipped;           // BAND/TRCE/MARK/PTRG
+};
+
+/**
+ * @brief Connection to one TCD1304 board
+ */
+class Tcd1304Device {
+public:
+    using FrameCallback = std::function<void(const FrameRef&)>;
+
+    struct Options {
+        uint32_t pool_frames = 16;
+        uint32_t command_timeout_ms = 1000;
+    };
+
+    /**
+     * @brief Ports that look like the board (STM32 VID 0483 / usbmodem)
+     */
+    static std::vector<std::string> find_ports();
+
+    Tcd1304Device();
+    explicit Tcd1304Device(const Options& options);
+    ~Tcd1304Device();
+
+    Tcd1304Device(const Tcd1304Device&) = delete;
+    Tcd1304Device& operator=(const Tcd1304Device&) = delete;
+
+    /**
+     * @brief Open a port (first find_ports() match if empty) and start the reader
+     * @return false with last_error() set on failure
+     */
+    bool open(const std::string& port = "");
+    void close();
+    bool is_open() const { return fd_ >= 0; }
+    const std::string& last_error() const { return last_error_; }
+
+    /**
+     * @brief Send a command line and wait for its reply line
+     * @param expect Reply prefix that answers it ("ERROR:" always does)
+     * @note The command is preceded by SYNC:<n>; only lines after OK:SYNC:<n>
+     *       can answer it, so a stale reply is never taken for this one
+     * @return false on timeout or an ERROR reply (reply holds the line)
+     */
+    bool command(const std::string& text, const std::string& expect, std::string* reply = nullptr);
+
+    /* Typed commands */
+    bool start();
+    bool stop();
+    bool status(std::string* reply);
+    bool stats(std::string* reply);
+    bool set_integration_time(uint32_t microseconds);
+    bool set_adc_bits(uint32_t bits);
+    bool set_clock(const std::string& profile);          // "2MHZ" / "4MHZ"
+    bool set_settle(uint32_t frames, bool flag_mode);
+    bool set_adapt(bool on);
+    bool mark(uint32_t id);
+
+    /**
+     * @brief Deliver frames to a callback on the reader thread (empty: use the queue)
+     * @note Set before open(); the callback must not block for long
+     */
+    void set_frame_callback(FrameCallback callback);
+
+    /**
+     * @brief Next queued frame (one consumer thread)
+     * @return false if none arrived within timeout_ms
+     */
+    bool next_frame(FrameRef* frame, uint32_t timeout_ms);
+
+    Stats get_stats() const;
+    FramePool& pool() { return pool_; }
+
+private:
+    void reader_loop();
+    size_t parse(const uint8_t* data, size_t length);
+    void deliver_frame(const uint8_t* data, uint32_t size, uint64_t now_ns);
+    void handle_line(const char* line, size_t length);
+
+    Options options_;
+    int fd_;
+    std::string last_error_;
+
+    FramePool pool_;
+    FrameQueue queue_;
+    FrameCallback callback_;
+
+    std::thread reader_;
+    std::atomic<bool> running_;
+    std::vector<uint8_t> rx_;           // Preallocated receive buffer
+    size_t rx_start_;
+    size_t rx_end_;
+
+    /* Wake-ups for next_frame() */
+    std::mutex frame_mutex_;
+    std::condition_variable frame_ready_;
+
+    /* Command replies */
+    std::mutex command_mutex_;          // One command at a time
+    std::mutex reply_mutex_;
+    std::condition_variable reply_ready_;
+    std::string expect_;
+    std::string reply_;
+    bool reply_done_;
+    std::string sync_;                  // Echo still to come before replies count
+    uint32_t sync_count_;
+
+    /* Counters (reader thread writes, anyone reads) */
+    std::atomic<uint64_t> bytes_, reads_, frames_, pool_drops_, queue_drops_;
+    std::atomic<uint64_t> seq_gaps_, crc_errors_, packets_skipped_;
+    int32_t last_seq_;
+};
+
+}  // namespace tcd1304
+
+extern "C" {
+#endif /* __cplusplus */
+
+/* ----------------------------------------------------------------------------
+ * C API (python/tcd1304_sdk.py)
+ * ------------------------------------------------------------------------- */
+
+typedef struct tcd_device tcd_device;
+
+typedef struct {
+    uint32_t slot;                      // Pass to tcd_release()
+    uint16_t seq;
+    uint8_t bits;
+    uint8_t flags;
+    uint8_t crc_ok;
+    uint64_t host_time_ns;
+    uint32_t size;
+    const uint8_t* raw;                 // Pool memory, valid until released
+    const uint16_t* pixels;
+    uint32_t pixel_count;
+} tcd_frame_info;
+
+tcd_device* tcd_open(const char* port, uint32_t pool_frames);  // Check tcd_is_open()
+int tcd_is_open(tcd_device* device);
+void tcd_close(tcd_device* device);
+const char* tcd_last_error(tcd_device* device);
+int tcd_find_ports(char* buffer, uint32_t size);     // Newline-separated, returns count
+int tcd_command(tcd_device* device, const char* text, const char* expect,
+                char* reply, uint32_t reply_size);   // 1 = OK
+int tcd_next_frame(tcd_device* device, uint32_t timeout_ms, tcd_frame_info* info);
+void tcd_release(tcd_device* device, uint32_t slot);
+void tcd_get_stats(tcd_device* device, uint64_t* values, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TCD1304_DEVICE_H */
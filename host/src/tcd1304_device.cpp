@@ -0,0 +1,752 @@
+/**
+ ******************************************************************************
+ * @file    tcd1304_device.cpp
+ * @brief   C++ host SDK implementation
+ ******************************************************************************
+ */
+
+#include "tcd1304_device.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+
+namespace tcd1304 {
+
+namespace {
+
+constexpr uint32_t kRxBufferFrames = 4;
+constexpr size_t kMaxLineLength = 512;
+
+/* CRC16-CCITT (0x1021, init 0xFFFF), as ccd_data_layer_calculate_crc16 */
+struct Crc16Table {
+    uint16_t values[256];
+    Crc16Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint16_t crc = (uint16_t)(i << 8);
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+            }
+            values[i] = crc;
+        }
+    }
+};
+
+const Crc16Table kCrc16;
+
+uint16_t crc16(const uint8_t* data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc = (uint16_t)((crc << 8) ^ kCrc16.values[((crc >> 8) ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+inline uint16_t read_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool starts_with(const char* text, size_t length, const std::string& prefix)
+{
+    return length >= prefix.size() && memcmp(text, prefix.data(), prefix.size()) == 0;
+}
+
+/* Stream packets (markers as sent by the firmware) */
+enum class Packet { None, Frame, FrameX, Band, Trace, Mark, Pretrig };
+
+Packet packet_at(const uint8_t* p)
+{
+    if (p[0] == 'F' && p[1] == 'R' && p[2] == 'M') {
+        return p[3] == 'E' ? Packet::Frame : (p[3] == 'X' ? Packet::FrameX : Packet::None);
+    }
+    if (memcmp(p, "BAND", 4) == 0) return Packet::Band;
+    if (memcmp(p, "TRCE", 4) == 0) return Packet::Trace;
+    if (memcmp(p, "MARK", 4) == 0) return Packet::Mark;
+    if (memcmp(p, "PTRG", 4) == 0) return Packet::Pretrig;
+    return Packet::None;
+}
+
+/**
+ * @brief Size of the packet at p from its header
+ * @return bytes, 0 if the header is not complete yet, SIZE_MAX if it is not a packet
+ */
+size_t packet_size(Packet type, const uint8_t* p, size_t available)
+{
+    switch (type) {
+        case Packet::Frame:
+            return kFrameMaxSize;
+        case Packet::FrameX: {
+            if (available < kFrameXHeaderSize) return 0;
+            size_t size = kFrameXHeaderSize + read_u16(&p[10]) + kFrameFooterSize;
+            return size <= kFrameMaxSize ? size : SIZE_MAX;
+        }
+        case Packet::Band: {
+            if (available < 8) return 0;
+            return p[6] <= 8 ? 8u + p[6] * 8u + 2u : SIZE_MAX;
+        }
+        case Packet::Trace:
+            return 30;
+        case Packet::Mark:
+            return 16;
+        case Packet::Pretrig: {
+            if (available < 12) return 0;
+            uint32_t count = read_u16(&p[8]);
+            return count <= kPixelCount ? 12u + ((count + 1) / 2) * 3 + 2 : SIZE_MAX;
+        }
+        default:
+            return SIZE_MAX;
+    }
+}
+
+}  // namespace
+
+/* ----------------------------------------------------------------------------
+ * FramePool
+ * ------------------------------------------------------------------------- */
+
+FramePool::FramePool(uint32_t count)
+    : count_(count ? count : 1), frames_(new Frame[count ? count : 1]), head_(0)
+{
+    for (uint32_t i = 0; i < count_; i++) {
+        frames_[i].index = i;
+        frames_[i].refs.store(0, std::memory_order_relaxed);
+        frames_[i].next_free.store(i + 1 < count_ ? i + 1 : kNone, std::memory_order_relaxed);
+    }
+    head_.store(0, std::memory_order_release);
+}
+
+Frame* FramePool::acquire()
+{
+    uint64_t head = head_.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t index = (uint32_t)head;
+        if (index == kNone) {
+            return nullptr;
+        }
+        uint32_t next = frames_[index].next_free.load(std::memory_order_relaxed);
+        uint64_t tagged = (((head >> 32) + 1) << 32) | next;
+        if (head_.compare_exchange_weak(head, tagged, std::memory_order_acq_rel,
+                                        std::memory_order_acquire)) {
+            frames_[index].refs.store(1, std::memory_order_relaxed);
+            return &frames_[index];
+        }
+    }
+}
+
+void FramePool::add_ref(Frame* frame)
+{
+    frame->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FramePool::release(Frame* frame)
+{
+    if (frame->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tagged;
+    do {
+        frame->next_free.store((uint32_t)head, std::memory_order_relaxed);
+        tagged = (((head >> 32) + 1) << 32) | frame->index;
+    } while (!head_.compare_exchange_weak(head, tagged, std::memory_order_release,
+                                          std::memory_order_relaxed));
+}
+
+/* ----------------------------------------------------------------------------
+ * FrameRef
+ * ------------------------------------------------------------------------- */
+
+FrameRef::FrameRef(const FrameRef& other) : frame_(other.frame_), pool_(other.pool_)
+{
+    if (frame_) {
+        pool_->add_ref(frame_);
+    }
+}
+
+FrameRef::FrameRef(FrameRef&& other) noexcept : frame_(other.frame_), pool_(other.pool_)
+{
+    other.frame_ = nullptr;
+}
+
+FrameRef& FrameRef::operator=(FrameRef other) noexcept
+{
+    std::swap(frame_, other.frame_);
+    std::swap(pool_, other.pool_);
+    return *this;
+}
+
+FrameRef::~FrameRef()
+{
+    if (frame_) {
+        pool_->release(frame_);
+    }
+}
+
+Frame* FrameRef::detach()
+{
+    Frame* frame = frame_;
+    frame_ = nullptr;
+    return frame;
+}
+
+/* ----------------------------------------------------------------------------
+ * FrameQueue
+ * ------------------------------------------------------------------------- */
+
+FrameQueue::FrameQueue(uint32_t capacity) : head_(0), tail_(0)
+{
+    uint32_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_.reset(new std::atomic<Frame*>[size]);
+}
+
+bool FrameQueue::push(Frame* frame)
+{
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+        return false;
+    }
+    slots_[tail & mask_].store(frame, std::memory_order_relaxed);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+Frame* FrameQueue::pop()
+{
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    Frame* frame = slots_[head & mask_].load(std::memory_order_relaxed);
+    head_.store(head + 1, std::memory_order_release);
+    return frame;
+}
+
+/* ----------------------------------------------------------------------------
+ * Tcd1304Device
+ * ------------------------------------------------------------------------- */
+
+std::vector<std::string> Tcd1304Device::find_ports()
+{
+    std::vector<std::string> ports;
+
+    // Linux: cdc-acm ttys whose USB device has the STM32 vendor id
+    if (DIR* dir = opendir("/sys/class/tty")) {
+        while (struct dirent* entry = readdir(dir)) {
+            if (strncmp(entry->d_name, "ttyACM", 6) != 0) {
+                continue;
+            }
+            std::ifstream vendor(std::string("/sys/class/tty/") + entry->d_name +
+                                 "/device/../idVendor");
+            std::string id;
+            if (vendor >> id && id == "0483") {
+                ports.push_back(std::string("/dev/") + entry->d_name);
+            }
+        }
+        closedir(dir);
+    }
+
+    // macOS: CDC devices show up as usbmodem
+    if (ports.empty()) {
+        if (DIR* dir = opendir("/dev")) {
+            while (struct dirent* entry = readdir(dir)) {
+                if (strncmp(entry->d_name, "cu.usbmodem", 11) == 0) {
+                    ports.push_back(std::string("/dev/") + entry->d_name);
+                }
+            }
+            closedir(dir);
+        }
+    }
+    return ports;
+}
+
+Tcd1304Device::Tcd1304Device() : Tcd1304Device(Options()) {}
+
+Tcd1304Device::Tcd1304Device(const Options& options)
+    : options_(options), fd_(-1), pool_(options.pool_frames), queue_(options.pool_frames),
+      running_(false), rx_(kRxBufferFrames * kFrameMaxSize), rx_start_(0), rx_end_(0),
+      reply_done_(false), sync_count_(0), bytes_(0), reads_(0), frames_(0), pool_drops_(0), queue_drops_(0),
+      seq_gaps_(0), crc_errors_(0), packets_skipped_(0), last_seq_(-1)
+{
+}
+
+Tcd1304Device::~Tcd1304Device()
+{
+    close();
+}
+
+bool Tcd1304Device::open(const std::string& port)
+{
+    close();
+
+    std::string path = port;
+    if (path.empty()) {
+        std::vector<std::string> ports = find_ports();
+        if (ports.empty()) {
+            last_error_ = "no TCD1304 port found";
+            return false;
+        }
+        path = ports.front();
+    }
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (fd_ < 0) {
+        last_error_ = path + ": " + strerror(errno);
+        return false;
+    }
+
+    // Raw; a read returns with any data, or after 100 ms without
+    struct termios tio;
+    if (tcgetattr(fd_, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 1;
+        tcsetattr(fd_, TCSANOW, &tio);
+    }
+    tcflush(fd_, TCIFLUSH);
+
+    rx_start_ = rx_end_ = 0;
+    last_seq_ = -1;
+    running_.store(true);
+    reader_ = std::thread(&Tcd1304Device::reader_loop, this);
+    return true;
+}
+
+void Tcd1304Device::close()
+{
+    if (reader_.joinable()) {
+        running_.store(false);
+        reader_.join();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    // Frames still queued go back to the pool
+    while (Frame* frame = queue_.pop()) {
+        pool_.release(frame);
+    }
+    frame_ready_.notify_all();
+}
+
+/* --- Commands -------------------------------------------------------------- */
+
+bool Tcd1304Device::command(const std::string& text, const std::string& expect, std::string* reply)
+{
+    if (fd_ < 0) {
+        last_error_ = "not open";
+        return false;
+    }
+    std::lock_guard<std::mutex> serialize(command_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(reply_mutex_);
+        expect_ = expect;
+        sync_ = "OK:SYNC:" + std::to_string(++sync_count_);
+        reply_.clear();
+        reply_done_ = false;
+    }
+
+    // SYNC goes first: lines before its echo answer something sent earlier
+    // (a command that timed out, an unsolicited ERROR:) and are skipped
+    std::string line = "SYNC:" + std::to_string(sync_count_) + "\n" + text + "\n";
+    if (::write(fd_, line.data(), line.size()) != (ssize_t)line.size()) {
+        last_error_ = std::string("write: ") + strerror(errno);
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(reply_mutex_);
+    bool answered = reply_ready_.wait_for(lock, std::chrono::milliseconds(options_.command_timeout_ms),
+                                          [this] { return reply_done_; });
+    expect_.clear();
+    sync_.clear();
+    if (reply) {
+        *reply = reply_;
+    }
+    if (!answered) {
+        last_error_ = text + ": no reply";
+        return false;
+    }
+    if (reply_.compare(0, 6, "ERROR:") == 0) {
+        last_error_ = text + ": " + reply_;
+        return false;
+    }
+    return true;
+}
+
+bool Tcd1304Device::start() { return command("START", "OK:STARTED"); }
+bool Tcd1304Device::stop() { return command("STOP", "OK:STOPPED"); }
+bool Tcd1304Device::status(std::string* reply) { return command("STATUS", "STATUS:", reply); }
+bool Tcd1304Device::stats(std::string* reply) { return command("STATS", "STATS:", reply); }
+
+bool Tcd1304Device::set_integration_time(uint32_t microseconds)
+{
+    return command("SET_INT_TIME:" + std::to_string(microseconds), "OK:INT_TIME_SET");
+}
+
+bool Tcd1304Device::set_adc_bits(uint32_t bits)
+{
+    return command("ADC_BITS:" + std::to_string(bits), "OK:ADC_BITS:");
+}
+
+bool Tcd1304Device::set_clock(const std::string& profile)
+{
+    return command("CLOCK:" + profile, "OK:CLOCK:");
+}
+
+bool Tcd1304Device::set_settle(uint32_t frames, bool flag_mode)
+{
+    return command("SETTLE:" + std::to_string(frames) + (flag_mode ? ",FLAG" : ",DROP"), "OK:SETTLE:");
+}
+
+bool Tcd1304Device::set_adapt(bool on)
+{
+    return command(on ? "ADAPT:ON" : "ADAPT:OFF", "OK:ADAPT:");
+}
+
+bool Tcd1304Device::mark(uint32_t id)
+{
+    return command("MARK:" + std::to_string(id), "OK:MARK:");
+}
+
+void Tcd1304Device::handle_line(const char* line, size_t length)
+{
+    std::lock_guard<std::mutex> lock(reply_mutex_);
+    if (expect_.empty() || reply_done_) {
+        return;
+    }
+    if (!sync_.empty()) {
+        if (length == sync_.size() && starts_with(line, length, sync_)) {
+            sync_.clear();
+        }
+        return;
+    }
+    if (starts_with(line, length, expect_) || starts_with(line, length, "ERROR:")) {
+        reply_.assign(line, length);
+        reply_done_ = true;
+        reply_ready_.notify_all();
+    }
+}
+
+/* --- Frames ---------------------------------------------------------------- */
+
+void Tcd1304Device::set_frame_callback(FrameCallback callback)
+{
+    callback_ = std::move(callback);
+}
+
+bool Tcd1304Device::next_frame(FrameRef* frame, uint32_t timeout_ms)
+{
+    Frame* next = queue_.pop();
+    if (!next) {
+        std::unique_lock<std::mutex> lock(frame_mutex_);
+        frame_ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] {
+            return (next = queue_.pop()) != nullptr || !running_.load();
+        });
+    }
+    if (!next) {
+        return false;
+    }
+    *frame = FrameRef(next, &pool_);
+    return true;
+}
+
+void Tcd1304Device::deliver_frame(const uint8_t* data, uint32_t size, uint64_t now_ns)
+{
+    uint16_t seq = read_u16(&data[4]);
+    if (last_seq_ >= 0) {
+        seq_gaps_.fetch_add((uint16_t)(seq - (uint16_t)last_seq_ - 1), std::memory_order_relaxed);
+    }
+    last_seq_ = seq;
+
+    Frame* frame = pool_.acquire();
+    if (!frame) {
+        pool_drops_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    memcpy(frame->raw, data, size);
+    frame->size = size;
+    frame->seq = seq;
+    frame->host_time_ns = now_ns;
+    frame->crc_ok = crc16(data, size - 2) == read_u16(&data[size - 2]);
+    if (!frame->crc_ok) {
+        crc_errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Pixels on the 12-bit scale
+    if (data[3] == 'E') {
+        frame->bits = 12;
+        frame->flags = 0;
+        const uint8_t* p = &data[kFrameHeaderSize];
+        for (uint32_t i = 0; i < kPixelCount; i++) {
+            frame->pixels[i] = read_u16(&p[2 * i]);
+        }
+    } else {
+        frame->bits = data[8];
+        frame->flags = data[9];
+        const uint8_t* p = &data[kFrameXHeaderSize];
+        uint32_t payload = read_u16(&data[10]);
+        if (frame->bits == 8 && payload >= kPixelCount) {
+            for (uint32_t i = 0; i < kPixelCount; i++) {
+                frame->pixels[i] = (uint16_t)(p[i] << 4);
+            }
+        } else if (frame->bits == 10 && payload >= ((kPixelCount + 3) / 4) * 5) {
+            for (uint32_t i = 0; i < kPixelCount; i += 4, p += 5) {
+                uint64_t group = (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+                                 ((uint64_t)p[3] << 24) | ((uint64_t)p[4] << 32);
+                for (uint32_t k = 0; k < 4 && i + k < kPixelCount; k++) {
+                    frame->pixels[i + k] = (uint16_t)(((group >> (10 * k)) & 0x3FF) << 2);
+                }
+            }
+        } else {
+            memset(frame->pixels, 0, sizeof(frame->pixels));
+            frame->crc_ok = false;
+        }
+    }
+
+    if (callback_) {
+        FrameRef ref(frame, &pool_);
+        frames_.fetch_add(1, std::memory_order_relaxed);
+        callback_(ref);
+        return;
+    }
+
+    if (!queue_.push(frame)) {
+        queue_drops_.fetch_add(1, std::memory_order_relaxed);
+        pool_.release(frame);
+        return;
+    }
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex_);
+    }
+    frame_ready_.notify_one();
+}
+
+size_t Tcd1304Device::parse(const uint8_t* data, size_t length)
+{
+    size_t pos = 0;
+    size_t line_start = 0;
+    uint64_t now_ns = monotonic_ns();
+
+    while (pos < length) {
+        // Fewer than 4 bytes left: only line ends; a partial marker is kept below
+        Packet type = (pos + 4 <= length) ? packet_at(&data[pos]) : Packet::None;
+        if (type == Packet::None) {
+            if (data[pos] == '\n' || data[pos] == '\r') {
+                if (pos > line_start) {
+                    handle_line((const char*)&data[line_start], pos - line_start);
+                }
+                line_start = pos + 1;
+            }
+            pos++;
+            continue;
+        }
+
+        size_t size = packet_size(type, &data[pos], length - pos);
+        if (size == SIZE_MAX) {
+            pos++;                      // Marker bytes inside other data
+            continue;
+        }
+        if (size == 0 || length - pos < size) {
+            return pos;                 // Wait for the rest
+        }
+
+        if (type == Packet::Frame || type == Packet::FrameX) {
+            if (memcmp(&data[pos + size - 6], "ENDF", 4) != 0) {
+                pos++;
+                continue;
+            }
+            deliver_frame(&data[pos], (uint32_t)size, now_ns);
+        } else {
+            packets_skipped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        pos += size;
+        line_start = pos;
+    }
+
+    // Keep an unfinished line (or a possible partial marker)
+    size_t tail = length < 3 ? 0 : length - 3;
+    return (pos - line_start < kMaxLineLength) ? line_start : tail;
+}
+
+void Tcd1304Device::reader_loop()
+{
+    while (running_.load(std::memory_order_relaxed)) {
+        if (rx_end_ == rx_.size()) {
+            if (rx_start_ == 0) {
+                rx_start_ = rx_end_ = 0;        // Nothing parseable in a full buffer
+            } else {
+                memmove(rx_.data(), &rx_[rx_start_], rx_end_ - rx_start_);
+                rx_end_ -= rx_start_;
+                rx_start_ = 0;
+            }
+        }
+
+        ssize_t n = ::read(fd_, &rx_[rx_end_], rx_.size() - rx_end_);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            break;                              // Device gone
+        }
+        if (n == 0) {
+            continue;                           // VTIME timeout
+        }
+        reads_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add((uint64_t)n, std::memory_order_relaxed);
+        rx_end_ += (size_t)n;
+
+        rx_start_ += parse(&rx_[rx_start_], rx_end_ - rx_start_);
+        if (rx_start_ == rx_end_) {
+            rx_start_ = rx_end_ = 0;
+        }
+    }
+    running_.store(false);
+    frame_ready_.notify_all();
+}
+
+Stats Tcd1304Device::get_stats() const
+{
+    Stats s;
+    s.bytes = bytes_.load();
+    s.reads = reads_.load();
+    s.frames = frames_.load();
+    s.pool_drops = pool_drops_.load();
+    s.queue_drops = queue_drops_.load();
+    s.seq_gaps = seq_gaps_.load();
+    s.crc_errors = crc_errors_.load();
+    s.packets_skipped = packets_skipped_.load();
+    return s;
+}
+
+}  // namespace tcd1304
+
+/* ----------------------------------------------------------------------------
+ * C API
+ * ------------------------------------------------------------------------- */
+
+using tcd1304::Tcd1304Device;
+
+struct tcd_device {
+    Tcd1304Device device;
+    explicit tcd_device(const Tcd1304Device::Options& options) : device(options) {}
+};
+
+extern "C" {
+
+tcd_device* tcd_open(const char* port, uint32_t pool_frames)
+{
+    Tcd1304Device::Options options;
+    if (pool_frames) {
+        options.pool_frames = pool_frames;
+    }
+    tcd_device* handle = new tcd_device(options);
+    handle->device.open(port ? port : "");
+    return handle;
+}
+
+int tcd_is_open(tcd_device* device)
+{
+    return device->device.is_open() ? 1 : 0;
+}
+
+void tcd_close(tcd_device* device)
+{
+    delete device;
+}
+
+const char* tcd_last_error(tcd_device* device)
+{
+    return device->device.last_error().c_str();
+}
+
+int tcd_find_ports(char* buffer, uint32_t size)
+{
+    std::vector<std::string> ports = Tcd1304Device::find_ports();
+    std::string joined;
+    for (const std::string& port : ports) {
+        joined += port + "\n";
+    }
+    if (size) {
+        size_t n = joined.size() < size - 1 ? joined.size() : size - 1;
+        memcpy(buffer, joined.data(), n);
+        buffer[n] = '\0';
+    }
+    return (int)ports.size();
+}
+
+int tcd_command(tcd_device* device, const char* text, const char* expect,
+                char* reply, uint32_t reply_size)
+{
+    std::string line;
+    bool ok = device->device.command(text, expect, &line);
+    if (reply && reply_size) {
+        size_t n = line.size() < reply_size - 1 ? line.size() : reply_size - 1;
+        memcpy(reply, line.data(), n);
+        reply[n] = '\0';
+    }
+    return ok ? 1 : 0;
+}
+
+int tcd_next_frame(tcd_device* device, uint32_t timeout_ms, tcd_frame_info* info)
+{
+    tcd1304::FrameRef ref;
+    if (!device->device.next_frame(&ref, timeout_ms)) {
+        return 0;
+    }
+    // The reference moves to the caller until tcd_release()
+    tcd1304::Frame* frame = ref.detach();
+    info->slot = frame->index;
+    info->seq = frame->seq;
+    info->bits = frame->bits;
+    info->flags = frame->flags;
+    info->crc_ok = frame->crc_ok ? 1 : 0;
+    info->host_time_ns = frame->host_time_ns;
+    info->size = frame->size;
+    info->raw = frame->raw;
+    info->pixels = frame->pixels;
+    info->pixel_count = tcd1304::kPixelCount;
+    return 1;
+}
+
+void tcd_release(tcd_device* device, uint32_t slot)
+{
+    tcd1304::FramePool& pool = device->device.pool();
+    if (slot < pool.size()) {
+        pool.release(pool.at(slot));
+    }
+}
+
+void tcd_get_stats(tcd_device* device, uint64_t* values, uint32_t count)
+{
+    tcd1304::Stats s = device->device.get_stats();
+    const uint64_t all[] = {s.bytes, s.reads, s.frames, s.pool_drops, s.queue_drops,
+                            s.seq_gaps, s.crc_errors, s.packets_skipped};
+    for (uint32_t i = 0; i < count && i < sizeof(all) / sizeof(all[0]); i++) {
+        values[i] = all[i];
+    }
+}
+
+}  /* extern "C" */
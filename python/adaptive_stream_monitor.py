@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+Adaptive Stream Monitor
+Streams with ADAPT:ON and shows, second by second, how many frames arrived
+at each encoding (12-bit FRME, 10/8-bit FRMX), the frame rate and the seq
+gaps (dropped readouts). At the end the device's ADAPT_DOWN / ADAPT_UP step
+counters and DROPPED are read from STATS.
+
+Decoding needs nothing beyond parse_frame_info(): each frame carries its
+own format and pixels come back scaled to 12 bits. Frames are read with
+SerialIngest (tcd1304_ingest.py).
+
+Usage:
+    python adaptive_stream_monitor.py [port] --seconds 30
+    python adaptive_stream_monitor.py [port] --seconds 30 --fixed   # ADAPT:OFF baseline
+"""
+
+import argparse
+import sys
+import time
+
+import serial
+
+from tcd1304_protocol import find_stm32_port, parse_frame_info
+from tcd1304_ingest import SerialIngest
+
+
+def command(ser, text):
+    ser.write(text.encode('ascii') + b'\n')
+    time.sleep(0.1)
+
+
+def read_stats(ser):
+    ser.reset_input_buffer()
+    ser.write(b'STATS\n')
+    deadline = time.time() + 1.0
+    while time.time() < deadline:
+        line = ser.readline().decode('ascii', errors='ignore').strip()
+        if line.startswith('STATS:'):
+            return dict(item.split(':', 1) for item in line[6:].split(',') if ':' in item)
+    return {}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 adaptive frame format monitor')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--seconds', type=float, default=10.0, help='Streaming time')
+    parser.add_argument('--fixed', action='store_true', help='Stream with ADAPT:OFF for comparison')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.05)
+    time.sleep(0.3)
+    command(ser, 'STOP')
+    before = read_stats(ser)
+    command(ser, 'ADAPT:OFF' if args.fixed else 'ADAPT:ON')
+    ser.reset_input_buffer()
+    ser.write(b'START\n')
+
+    print(f"{'s':>4} {'fps':>6} {'12b':>5} {'10b':>5} {'8b':>5} {'gaps':>5} {'MB/s':>6}")
+    ingest = SerialIngest(ser)
+    totals = {12: 0, 10: 0, 8: 0}
+    gaps_total = crc_errors = 0
+    last_seq = None
+    start = time.time()
+    second = {12: 0, 10: 0, 8: 0, 'gaps': 0, 'bytes': 0}
+    next_report = start + 1.0
+    try:
+        for frame in ingest.frames(args.seconds):
+            info = parse_frame_info(frame)
+            if info is None:
+                continue
+            crc_errors += 0 if info['crc_ok'] else 1
+            second[info['bits']] = second.get(info['bits'], 0) + 1
+            second['bytes'] += len(frame)
+            if last_seq is not None:
+                second['gaps'] += (info['seq'] - last_seq - 1) & 0xFFFF
+            last_seq = info['seq']
+
+            now = time.time()
+            if now >= next_report:
+                frames = second[12] + second[10] + second[8]
+                print(f"{int(now - start):>4} {frames:>6} {second[12]:>5} {second[10]:>5} "
+                      f"{second[8]:>5} {second['gaps']:>5} {second['bytes'] / 1e6:>6.2f}")
+                for bits in totals:
+                    totals[bits] += second[bits]
+                gaps_total += second['gaps']
+                second = {12: 0, 10: 0, 8: 0, 'gaps': 0, 'bytes': 0}
+                next_report += 1.0
+    finally:
+        command(ser, 'STOP')
+        after = read_stats(ser)
+        ser.close()
+
+    def delta(key):
+        try:
+            return int(after[key]) - int(before.get(key, 0))
+        except (KeyError, ValueError):
+            return '?'
+
+    print(f"📊 frames 12b {totals[12]}, 10b {totals[10]}, 8b {totals[8]}; "
+          f"seq gaps {gaps_total}, CRC errors {crc_errors}")
+    print(f"   device: DROPPED +{delta('DROPPED')}, ADAPT_DOWN +{delta('ADAPT_DOWN')}, "
+          f"ADAPT_UP +{delta('ADAPT_UP')}")
+    print(f"   host: {ingest.stats()['reads_per_frame']:.2f} reads per frame")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""
+Band Monitor
+Configures the firmware's band integrator and logs the per-readout band sums
+and centroids. Full frames sent alongside (BAND_FRAMES) are counted and
+skipped. Optionally writes the time series as CSV.
+
+The firmware integrates light (full_scale - ADC count, as the sensor output
+drops with light), so a sum rises and a centroid moves toward the lit
+pixels; no host-side inversion is needed. Sums of 10/8-bit readouts are
+scaled to 12 bits by parse_band_packet().
+
+Usage:
+    python band_monitor.py [port] --bands 500,40,1800,40,3000,100 --seconds 10
+    python band_monitor.py [port] --bands 1000,200 --frames 100 --csv bands.csv
+"""
+
+import argparse
+import csv
+import sys
+import time
+
+import serial
+
+from tcd1304_protocol import (find_stm32_port, parse_band_packet, BAND_MARKER,
+                              find_frame_start, frame_size)
+
+
+def command(ser, text, expect):
+    ser.write(text.encode('ascii') + b'\n')
+    response = ser.readline().decode('ascii', errors='ignore').strip()
+    if not response.startswith(expect):
+        raise RuntimeError(f'{text} rejected: {response}')
+    return response
+
+
+def read_stream(ser, seconds):
+    """Yield ('band', packet) and ('frame', None) items for the given time"""
+    data = bytearray()
+    deadline = time.time() + seconds
+    while time.time() < deadline:
+        data.extend(ser.read(max(1, ser.in_waiting)))
+        while True:
+            band_at = data.find(BAND_MARKER)
+            frame_at = find_frame_start(data)
+            starts = [i for i in (band_at, frame_at) if i >= 0]
+            if not starts:
+                # Keep a possible partial marker
+                del data[:max(0, len(data) - 3)]
+                break
+            start = min(starts)
+            del data[:start]
+            if start == frame_at:
+                size = frame_size(data)
+                if size is None or len(data) < size:
+                    break
+                del data[:size]
+                yield 'frame', None
+            else:
+                packet, used = parse_band_packet(data)
+                if packet is None:
+                    break
+                del data[:used]
+                yield 'band', packet
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 band integrator monitor')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--bands', required=True,
+                        help='start,length pairs, ascending and non-overlapping')
+    parser.add_argument('--frames', type=int, default=0,
+                        help='Also send a full frame every N readouts (0 = never)')
+    parser.add_argument('--seconds', type=float, default=10.0, help='Logging time')
+    parser.add_argument('--csv', help='Save the time series to this CSV file')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.1)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    rows = []
+    frames = crc_errors = gaps = 0
+    try:
+        print(f"📐 {command(ser, f'BANDS:{args.bands}', 'OK:BANDS')}")
+        command(ser, f'BAND_FRAMES:{args.frames}', 'OK:BAND_FRAMES')
+        command(ser, 'START', 'OK')
+
+        start = time.time()
+        previous = None
+        for kind, packet in read_stream(ser, args.seconds):
+            if kind == 'frame':
+                frames += 1
+                continue
+            if not packet['crc_ok']:
+                crc_errors += 1
+                continue
+            if previous is not None and packet['seq'] != (previous + 1) & 0xFFFF:
+                gaps += 1
+            previous = packet['seq']
+            rows.append([time.time() - start, packet['seq']] +
+                        [v for pair in zip(packet['sums'], packet['centroids']) for v in pair])
+            if len(rows) % 50 == 1:
+                summary = '  '.join(f"{s:9d}@{'-' if c is None else f'{c:7.2f}'}"
+                                    for s, c in zip(packet['sums'], packet['centroids']))
+                print(f"  seq {packet['seq']:5d}  {summary}")
+    finally:
+        ser.write(b'STOP\n')
+        ser.write(b'BANDS_OFF\n')
+        ser.close()
+
+    elapsed = max(args.seconds, 1e-6)
+    print(f"\n📊 {len(rows)} band packets ({len(rows) / elapsed:.1f}/s), {frames} full frames, "
+          f"{gaps} sequence gaps, {crc_errors} CRC errors")
+
+    if args.csv and rows:
+        band_count = (len(rows[0]) - 2) // 2
+        with open(args.csv, 'w', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(['time_s', 'seq'] +
+                            [f'{name}{i}' for i in range(band_count) for name in ('light', 'centroid')])
+            writer.writerows(rows)
+        print(f"💾 Saved {len(rows)} rows to {args.csv}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""
+Chunked Bulk Upload
+Sends a calibration table, defect map or sequence program to the firmware's
+UPLOAD channel: offset-addressed chunks with a CRC each, several chunks in
+flight, go-back on NAK, and a closing chunk carrying the whole-image CRC.
+
+Usage:
+    python bulk_upload.py [port] --type CAL --file cal.bin [--target FLASH]
+    python bulk_upload.py [port] --type SEQ --synthetic 1024
+    python bulk_upload.py [port] --info CAL
+    python bulk_upload.py [port] --erase
+"""
+
+import argparse
+import binascii
+import os
+import struct
+import sys
+import time
+
+import serial
+import serial.tools.list_ports
+
+CHUNK_MARKER = b'UPCK'
+DEFAULT_CHUNK = 512
+DEFAULT_WINDOW = 4
+ERASE_TIMEOUT_S = 5.0
+
+
+def find_stm32_port():
+    """Find the STM32 USB CDC port"""
+    for port in serial.tools.list_ports.comports():
+        if any(keyword in port.description.lower()
+               for keyword in ['stm32', 'stmicroelectronics', 'usb serial']):
+            return port.device
+    return None
+
+
+def crc16(data):
+    """CRC16-CCITT (init 0xFFFF), same as the frame checksum"""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def make_chunk(offset, payload, crc=None):
+    if crc is None:
+        crc = crc16(payload)
+    return CHUNK_MARKER + struct.pack('<IHH', offset, len(payload), crc) + payload
+
+
+def read_line(ser):
+    line = ser.readline().decode('ascii', errors='ignore').strip()
+    if not line:
+        raise RuntimeError('Timeout waiting for device response')
+    return line
+
+
+def send_command(ser, command):
+    """Send a command and return the first response line"""
+    ser.write(command.encode('ascii') + b'\n')
+    return read_line(ser)
+
+
+def upload(ser, type_name, data, target='RAM', chunk=DEFAULT_CHUNK,
+           window=DEFAULT_WINDOW, corrupt_offset=None, progress=None):
+    """
+    Upload one image; returns (committed line, nak count).
+
+    Chunks are answered in order, so after a NAK every chunk still in flight
+    is answered with NAK ORDER - those answers are drained and sending
+    resumes from the offset the device expects.
+    """
+    response = send_command(ser, f'UPLOAD:{type_name},{len(data)},{target}')
+    if not response.startswith('OK:UPLOAD_READY'):
+        raise RuntimeError(f'UPLOAD rejected: {response}')
+    max_chunk = int(response.rsplit(',', 1)[1])
+    chunk = min(chunk, max_chunk)
+
+    next_offset = 0
+    in_flight = []
+    naks = 0
+
+    while True:
+        while len(in_flight) < window and next_offset < len(data):
+            payload = data[next_offset:next_offset + chunk]
+            crc = None
+            if next_offset == corrupt_offset:
+                crc = crc16(payload) ^ 0xFFFF
+                corrupt_offset = None
+            ser.write(make_chunk(next_offset, payload, crc))
+            in_flight.append(next_offset)
+            next_offset += len(payload)
+
+        if not in_flight:
+            break
+
+        line = read_line(ser)
+        if line.startswith('ERROR:'):
+            raise RuntimeError(f'Upload aborted: {line}')
+
+        in_flight.pop(0)
+        fields = line.split(':', 1)[1].split(',')
+        if line.startswith('UPLOAD_ACK:'):
+            if progress:
+                progress(int(fields[1]), int(fields[2]))
+        elif line.startswith('UPLOAD_NAK:'):
+            naks += 1
+            print(f"  ↩️  NAK at {fields[0]} ({fields[1]}), resending from {fields[2]}")
+            # Drain the answers to the chunks sent before the rewind
+            for _ in in_flight:
+                read_line(ser)
+            in_flight.clear()
+            next_offset = int(fields[2])
+        else:
+            raise RuntimeError(f'Unexpected response: {line}')
+
+    ser.write(make_chunk(0, b'', crc16(data)))
+    committed = read_line(ser)
+    if not committed.startswith('OK:UPLOAD_COMMITTED'):
+        raise RuntimeError(f'Commit failed: {committed}')
+    return committed, naks
+
+
+def synthetic_image(size):
+    """Deterministic test image"""
+    return bytes((i * 7 + (i >> 8)) & 0xFF for i in range(size))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 chunked bulk upload')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--type', default='CAL', choices=['CAL', 'DEFECT', 'SEQ'])
+    parser.add_argument('--target', default='RAM', choices=['RAM', 'FLASH'])
+    parser.add_argument('--file', help='Image file to upload')
+    parser.add_argument('--synthetic', type=int, help='Upload a generated test image of N bytes')
+    parser.add_argument('--chunk', type=int, default=DEFAULT_CHUNK, help='Chunk payload size')
+    parser.add_argument('--window', type=int, default=DEFAULT_WINDOW, help='Chunks in flight')
+    parser.add_argument('--inject-error', action='store_true',
+                        help='Corrupt the CRC of the second chunk once (tests NAK recovery)')
+    parser.add_argument('--info', metavar='TYPE', help='Query the stored image of TYPE')
+    parser.add_argument('--erase', action='store_true', help='Erase the flash image store')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=2)
+    time.sleep(0.3)
+    send_command(ser, 'STOP')
+    time.sleep(0.1)
+    ser.reset_input_buffer()
+
+    try:
+        if args.erase:
+            ser.timeout = ERASE_TIMEOUT_S
+            print(f"🧹 {send_command(ser, 'UPLOAD_ERASE')}")
+            ser.timeout = 2
+        if args.info:
+            print(f"ℹ️  {send_command(ser, f'UPLOAD_INFO:{args.info}')}")
+        if not (args.file or args.synthetic):
+            return
+
+        if args.file:
+            with open(args.file, 'rb') as f:
+                data = f.read()
+            name = os.path.basename(args.file)
+        else:
+            data = synthetic_image(args.synthetic)
+            name = f'synthetic {args.synthetic} bytes'
+
+        print(f"📤 Uploading {name} as {args.type} -> {args.target} "
+              f"({len(data)} bytes, chunk {args.chunk}, window {args.window})")
+
+        def show(received, total):
+            print(f"\r  {received:7d}/{total} bytes ({100 * received / total:5.1f}%)",
+                  end='', flush=True)
+
+        start = time.perf_counter()
+        committed, naks = upload(ser, args.type, data, args.target, args.chunk, args.window,
+                                 corrupt_offset=args.chunk if args.inject_error else None,
+                                 progress=show)
+        elapsed = time.perf_counter() - start
+        print()
+
+        print(f"✅ {committed}")
+        print(f"   {len(data) / elapsed / 1e3:.1f} kB/s, {elapsed * 1e3:.1f} ms, {naks} NAK(s)")
+        print(f"ℹ️  {send_command(ser, f'UPLOAD_INFO:{args.type}')}")
+    finally:
+        ser.close()
+
+
+if __name__ == "__main__":
+    main()
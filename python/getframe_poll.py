@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""
+GETFRAME Poll
+Pull-mode readout for closed-loop control: with streaming stopped, each
+GETFRAME returns the most recent complete frame at once, with its age.
+Polls at a fixed rate (or as fast as possible) and reports the frame age at
+the device, the host round trip, and how many polls saw a frame again or
+skipped readouts.
+
+get_latest() is the building block for a control loop.
+
+Usage:
+    python getframe_poll.py [port] --count 200
+    python getframe_poll.py [port] --count 1000 --rate 50
+"""
+
+import argparse
+import re
+import statistics
+import sys
+import time
+
+import serial
+
+from tcd1304_protocol import find_stm32_port, parse_frame, frame_size, find_frame_start
+
+GETFRAME_LINE = re.compile(rb'GETFRAME:SEQ:(\d+),AGE_US:(\d+),BITS:(\d+)(,SETTLING:1)?\n')
+GETFRAME_ERROR = re.compile(rb'ERROR:(NO_FRAME|GETFRAME_BUSY|MUST_STOP_FIRST)')
+
+
+def get_latest(ser, timeout=1.0):
+    """Pull the latest frame; returns (info dict, frame tuple, host round trip in ms)"""
+    ser.write(b'GETFRAME\n')
+    sent = time.perf_counter()
+
+    deadline = time.time() + timeout
+    data = bytearray()
+    info = None
+    while True:
+        if time.time() > deadline:
+            raise RuntimeError('GETFRAME timed out')
+        data.extend(ser.read(max(1, ser.in_waiting)))
+
+        if info is None:
+            error = GETFRAME_ERROR.search(data)
+            if error:
+                raise RuntimeError(error.group(0).decode())
+            match = GETFRAME_LINE.search(data)
+            if not match:
+                continue
+            info = {'SEQ': int(match.group(1)), 'AGE_US': int(match.group(2)),
+                    'BITS': int(match.group(3)), 'SETTLING': match.group(4) is not None}
+            del data[:match.end()]
+
+        start = find_frame_start(data)
+        size = frame_size(data, start) if start >= 0 else None
+        if size is not None and len(data) - start >= size:
+            received = time.perf_counter()
+            frame = parse_frame(bytes(data[start:start + size]))
+            if frame is None or frame[0] != info['SEQ']:
+                raise RuntimeError(f"Frame does not match GETFRAME seq {info['SEQ']}")
+            return info, frame, (received - sent) * 1000.0
+
+
+def summary(name, values, unit):
+    values = sorted(values)
+    p95 = values[min(len(values) - 1, int(round(0.95 * (len(values) - 1))))]
+    print(f"  {name:<18} min {values[0]:9.2f}  median {statistics.median(values):9.2f}  "
+          f"p95 {p95:9.2f}  max {values[-1]:9.2f} {unit}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 GETFRAME pull-mode latency')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--count', type=int, default=200, help='Number of polls')
+    parser.add_argument('--rate', type=float, default=0.0,
+                        help='Polls per second (0 = back to back)')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.1)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    ages, host, fresh = [], [], []
+    repeats = skipped = crc_errors = 0
+    last_seq = None
+    period = 1.0 / args.rate if args.rate > 0 else 0.0
+    next_poll = time.perf_counter()
+    try:
+        for _ in range(args.count):
+            if period:
+                time.sleep(max(0.0, next_poll - time.perf_counter()))
+                next_poll += period
+            info, frame, round_trip = get_latest(ser)
+            ages.append(info['AGE_US'] / 1000.0)
+            host.append(round_trip)
+            # Data age when the host has it: device age + the return half
+            fresh.append(info['AGE_US'] / 1000.0 + round_trip / 2.0)
+            crc_errors += 0 if frame[2] else 1
+            if last_seq is not None:
+                step = (info['SEQ'] - last_seq) & 0xFFFF
+                repeats += 1 if step == 0 else 0
+                skipped += max(0, step - 1)
+            last_seq = info['SEQ']
+    finally:
+        ser.close()
+
+    print(f"📊 {len(ages)} polls, {repeats} repeated frames, {skipped} readouts skipped, "
+          f"{crc_errors} CRC errors")
+    summary('age at device', ages, 'ms')
+    summary('host round trip', host, 'ms')
+    summary('age at host (est)', fresh, 'ms')
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Hot Path Cycles per Frame
+Measures the readout hot path (ADC callback entry to DMA restart, PERF) with
+the ART accelerator on and off, streaming frames for a few seconds each, and
+prints cycles per frame for the build on the device.
+
+The code placement is a build option, so a full before/after comparison takes
+two builds:
+
+    python hotpath_perf.py [port] --save flash.json    (-DCCD_HOTPATH_IN_FLASH)
+    (reflash the default build, hot path in SRAM)
+    python hotpath_perf.py [port] --compare flash.json
+
+"Before" the SRAM placement is HOTPATH:FLASH ART:ON (HAL_Init enables the
+ART with the default stm32f4xx_hal_conf.h); "after" is HOTPATH:RAM ART:ON.
+
+Usage:
+    python hotpath_perf.py [port] [--seconds 5]
+"""
+
+import argparse
+import json
+import sys
+import time
+
+import serial
+
+from tcd1304_protocol import find_stm32_port
+
+ART_STATES = ('ON', 'OFF')
+
+
+def parse_perf(line):
+    """'PERF:FRAMES:n,CYC_MIN:c,...,ART:ON,HOTPATH:RAM' -> dict"""
+    fields = dict(item.split(':', 1) for item in line[len('PERF:'):].split(','))
+    return {k: (v if k in ('ART', 'HOTPATH') else int(v)) for k, v in fields.items()}
+
+
+def command(ser, text, prefix):
+    """Send a command and return the first reply line starting with prefix"""
+    ser.write(f'{text}\n'.encode('ascii'))
+    deadline = time.time() + 3
+    while time.time() < deadline:
+        line = ser.readline().decode('ascii', errors='ignore').strip()
+        if line.startswith(prefix) or line.startswith('ERROR'):
+            return line
+    raise RuntimeError(f'No reply to {text}')
+
+
+def stop_and_drain(ser):
+    ser.write(b'STOP\n')
+    time.sleep(0.3)
+    ser.reset_input_buffer()
+
+
+def measure(ser, art, seconds):
+    """Stream for the given time with ART on/off, then read PERF"""
+    stop_and_drain(ser)
+    command(ser, f'ART:{art}', f'OK:ART:{art}')     # Also clears PERF
+    command(ser, 'START', 'OK:STARTED')
+
+    # Keep reading, so frames are collected at the normal rate
+    end = time.time() + seconds
+    while time.time() < end:
+        ser.read(ser.in_waiting or 1)
+
+    stop_and_drain(ser)
+    line = command(ser, 'PERF', 'PERF:')
+    if not line.startswith('PERF:'):
+        raise RuntimeError(f'PERF failed: {line!r}')
+    return parse_perf(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 hot path cycles per frame')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--seconds', type=float, default=5.0, help='Streaming time per state')
+    parser.add_argument('--save', help='Write the results to a JSON file')
+    parser.add_argument('--compare', help='Compare with a saved JSON file (other build)')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.5)
+    time.sleep(0.3)
+    try:
+        results = [measure(ser, art, args.seconds) for art in ART_STATES]
+        command(ser, 'ART:ON', 'OK:ART:ON')
+    finally:
+        ser.close()
+
+    rows = list(results)
+    if args.compare:
+        with open(args.compare) as f:
+            rows += json.load(f)
+
+    print(f"{'hot path':<10}{'ART':<5}{'frames':>8}{'cyc min':>10}{'cyc avg':>10}"
+          f"{'cyc max':>10}{'jitter':>10}{'us avg':>8}")
+    for r in rows:
+        print(f"{r['HOTPATH']:<10}{r['ART']:<5}{r['FRAMES']:>8}{r['CYC_MIN']:>10}"
+              f"{r['CYC_AVG']:>10}{r['CYC_MAX']:>10}{r['CYC_MAX'] - r['CYC_MIN']:>10}"
+              f"{r['US_AVG']:>8}")
+
+    if args.compare:
+        before = next((r for r in rows if r['HOTPATH'] == 'FLASH' and r['ART'] == 'ON'), None)
+        after = next((r for r in rows if r['HOTPATH'] == 'RAM' and r['ART'] == 'ON'), None)
+        if before and after and before['CYC_AVG']:
+            change = 100.0 * (after['CYC_AVG'] - before['CYC_AVG']) / before['CYC_AVG']
+            print(f"FLASH -> RAM (ART on): {before['CYC_AVG']} -> {after['CYC_AVG']} cycles "
+                  f"avg ({change:+.1f}%), jitter {before['CYC_MAX'] - before['CYC_MIN']} -> "
+                  f"{after['CYC_MAX'] - after['CYC_MIN']}")
+
+    if args.save:
+        with open(args.save, 'w') as f:
+            json.dump(results, f, indent=2)
+        print(f"💾 {args.save}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""
+Kernel Benchmark
+Runs BENCH on the device (readout kernels on full-size buffers, CPU cycles
+per call) and the same kernels on the host with numpy, on buffers of the
+same size, and prints them side by side.
+
+Results can be saved and compared with an earlier build:
+
+    python kernel_bench.py [port] --save o2_ram.json
+    (rebuild / reflash with other flags)
+    python kernel_bench.py [port] --compare o2_ram.json
+
+Kernels (see Core/Inc/kernel_bench.h):
+  COPY    readout copy, 3694 pixels      BANDS   copy + 8 bands of 400 pixels
+  CRC16   CRC16-CCITT over 7400 bytes    PACK12  12-bit packing of a readout
+  PACK10  FRMX 10-bit encoding + CRC     PACK8   FRMX 8-bit encoding + CRC
+
+Usage:
+    python kernel_bench.py [port] [--runs 200] [--host-only]
+"""
+
+import argparse
+import binascii
+import json
+import sys
+import time
+
+import numpy as np
+
+from tcd1304_protocol import CCD_PIXEL_COUNT, FRAME_TOTAL_SIZE
+
+KERNELS = ('COPY', 'BANDS', 'CRC16', 'PACK12', 'PACK10', 'PACK8')
+BANDS = [(32 + b * 450, 400) for b in range(8)]
+
+
+def _crc(data):
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def _pack12(pixels):
+    p = np.append(pixels, 0) if len(pixels) % 2 else pixels
+    p0, p1 = p[0::2] & 0x0FFF, p[1::2] & 0x0FFF
+    out = np.empty((len(p0), 3), dtype=np.uint8)
+    out[:, 0] = p0 & 0xFF
+    out[:, 1] = (p0 >> 8) | ((p1 & 0x0F) << 4)
+    out[:, 2] = p1 >> 4
+    return out.tobytes()
+
+
+def _pack10(pixels):
+    pad = (-len(pixels)) % 4
+    p = (np.append(pixels, np.zeros(pad, dtype=pixels.dtype)) & 0x03FF).astype(np.uint64)
+    groups = p[0::4] | (p[1::4] << 10) | (p[2::4] << 20) | (p[3::4] << 30)
+    return groups.astype('<u8').view(np.uint8).reshape(-1, 8)[:, :5].tobytes()
+
+
+def _bands(pixels):
+    sums = []
+    for start, length in BANDS:
+        band = pixels[start:start + length].astype(np.uint32)
+        sums.append((int(band.sum()), int(np.dot(np.arange(length, dtype=np.uint64), band))))
+    return sums
+
+
+def host_kernels():
+    """Host equivalents, each a callable on a representative buffer"""
+    rng = np.random.default_rng(1)
+    adc = rng.integers(0, 4096, CCD_PIXEL_COUNT, dtype=np.uint16)
+    dst = np.empty_like(adc)
+    frame = rng.integers(0, 256, FRAME_TOTAL_SIZE - 2, dtype=np.uint8).tobytes()
+
+    def bands():
+        np.copyto(dst, adc)
+        return _bands(dst)
+
+    return {
+        'COPY': lambda: np.copyto(dst, adc),
+        'BANDS': bands,
+        'CRC16': lambda: _crc(frame),
+        'PACK12': lambda: _pack12(adc),
+        'PACK10': lambda: _crc(_pack10(adc)),
+        'PACK8': lambda: _crc((adc & 0xFF).astype(np.uint8).tobytes()),
+    }
+
+
+def run_host(runs):
+    """Minimum time per call in microseconds"""
+    results = {}
+    for name, kernel in host_kernels().items():
+        best = None
+        for _ in range(runs):
+            start = time.perf_counter_ns()
+            kernel()
+            elapsed = time.perf_counter_ns() - start
+            best = elapsed if best is None else min(best, elapsed)
+        results[name] = best / 1000.0
+    return results
+
+
+def run_device(port_name):
+    import serial
+    from usb_throughput_test import parse_kv
+
+    ser = serial.Serial(port_name, 115200, timeout=3)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+    ser.write(b'BENCH\n')
+    line = ser.readline().decode('ascii', errors='ignore').strip()
+    ser.close()
+    if not line.startswith('BENCH:'):
+        raise RuntimeError(f'BENCH failed: {line!r}')
+
+    fields = dict(item.split(':', 1) for item in line[len('BENCH:'):].split(','))
+    return {
+        'mhz': int(fields['MHZ']),
+        'art': fields['ART'],
+        'hotpath': fields['HOTPATH'],
+        'runs': int(fields['RUNS']),
+        'cycles': {k: int(fields[k]) for k in KERNELS},
+        'cycles_max': {k: int(fields[f'{k}_MAX']) for k in KERNELS},
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 device/host kernel benchmark')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--runs', type=int, default=200, help='Host calls per kernel')
+    parser.add_argument('--host-only', action='store_true', help='Skip the device')
+    parser.add_argument('--save', help='Write the results to a JSON file')
+    parser.add_argument('--compare', help='Compare device cycles with a saved JSON file')
+    args = parser.parse_args()
+
+    device = None
+    if not args.host_only:
+        from tcd1304_protocol import find_stm32_port
+        port_name = args.port or find_stm32_port()
+        if not port_name:
+            print("❌ No STM32 device found (use --host-only)")
+            sys.exit(1)
+        device = run_device(port_name)
+
+    host = run_host(args.runs)
+    baseline = None
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f).get('device')
+
+    if device:
+        print(f"Device: {device['mhz']} MHz, ART {device['art']}, hot path in "
+              f"{device['hotpath']}, {device['runs']} runs (min / max cycles)")
+    print(f"{'kernel':<8}{'cycles':>10}{'max':>10}{'dev us':>10}{'host us':>10}{'dev/host':>10}"
+          f"{'vs base':>10}")
+    for name in KERNELS:
+        row = f"{name:<8}"
+        if device:
+            cycles = device['cycles'][name]
+            dev_us = cycles / device['mhz']
+            row += f"{cycles:>10}{device['cycles_max'][name]:>10}{dev_us:>10.1f}"
+        else:
+            row += f"{'-':>10}{'-':>10}{'-':>10}"
+        row += f"{host[name]:>10.2f}"
+        row += f"{dev_us / host[name]:>9.0f}x" if device and host[name] > 0 else f"{'-':>10}"
+        if device and baseline and baseline['cycles'].get(name):
+            change = 100.0 * (cycles - baseline['cycles'][name]) / baseline['cycles'][name]
+            row += f"{change:>+9.1f}%"
+        print(row)
+
+    if args.save:
+        with open(args.save, 'w') as f:
+            json.dump({'device': device, 'host_us': host}, f, indent=2)
+        print(f"💾 {args.save}")
+
+
+if __name__ == '__main__':
+    main()
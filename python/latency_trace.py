@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+End-to-End Latency Trace
+Streams with TRACE:ON and combines the device stage timestamps of every
+frame (TRCE packets) with host timestamps taken while the same frame is
+read, deframed, processed and (optionally) rendered:
+
+  icg -> dma         end of integration to ADC DMA complete
+  dma -> ready       copy, CRC and encoding in the ADC callback
+  ready -> submit    queued for USB
+  submit -> read     USB transfer + host driver (see below)
+  read -> deframe    parse_frame_info
+  deframe -> process numpy conversion, dark offset, peak search
+  process -> render  matplotlib redraw (--render)
+
+Device and host clocks are not synchronised. submit -> read is measured
+against the fastest transfer seen in a sliding window (clock offset =
+window minimum), so it shows the queueing/jitter above the fastest case;
+--floor-us adds an assumed minimum transfer time (e.g. frame bytes divided
+by the link_benchmark.py source rate) to make the total absolute.
+
+Usage:
+    python latency_trace.py [port] --seconds 20 [--render] [--csv trace.csv]
+"""
+
+import argparse
+import csv
+import sys
+import time
+
+import numpy as np
+import serial
+
+from tcd1304_protocol import (find_stm32_port, frame_size, parse_frame_info,
+                              parse_trace_packet, FRAME_START_MARKER,
+                              FRAMEX_START_MARKER, TRACE_MARKER)
+
+MARKERS = (FRAME_START_MARKER, FRAMEX_START_MARKER, TRACE_MARKER)
+STAGES = [('icg', 'dma'), ('dma', 'ready'), ('ready', 'submit'), ('submit', 'read'),
+          ('read', 'deframe'), ('deframe', 'process'), ('process', 'render')]
+
+
+def next_marker(data):
+    hits = [i for i in (data.find(m) for m in MARKERS) if i >= 0]
+    return min(hits) if hits else -1
+
+
+def process(pixels):
+    """Stand-in for the application's processing of a frame"""
+    values = np.asarray(pixels, dtype=np.float32)
+    values -= values[:16].mean()
+    return int(np.argmax(values[32:3680])) + 32
+
+
+def collect(ser, seconds, render):
+    """Stream and time-stamp; returns a list of per-frame records (host us)"""
+    host = {}       # seq -> host stamps of the most recent frame with that seq
+    traces = {}     # seq -> trace packet
+    records = []
+    data = bytearray()
+    plot = None
+
+    if render:
+        import matplotlib.pyplot as plt
+        plt.ion()
+        fig, ax = plt.subplots()
+        line, = ax.plot(np.zeros(3694))
+        ax.set_ylim(0, 4096)
+        plot = (fig, line)
+
+    end = time.time() + seconds
+    while time.time() < end:
+        data.extend(ser.read(max(1, ser.in_waiting)))
+        t_read = time.perf_counter() * 1e6
+        while True:
+            at = next_marker(data)
+            if at < 0:
+                del data[:max(0, len(data) - 3)]
+                break
+            del data[:at]
+
+            if data[:4] == TRACE_MARKER:
+                packet, used = parse_trace_packet(data)
+                if packet is None:
+                    break
+                del data[:used]
+                if packet['crc_ok']:
+                    traces[packet['seq']] = packet
+            else:
+                size = frame_size(data)
+                if size is None or len(data) < size:
+                    break
+                info = parse_frame_info(bytes(data[:size]))
+                if info is None:
+                    del data[:1]
+                    continue
+                del data[:size]
+                stamps = {'read': t_read, 'deframe': time.perf_counter() * 1e6}
+                process(info['pixels'])
+                stamps['process'] = time.perf_counter() * 1e6
+                if plot:
+                    plot[1].set_ydata(info['pixels'])
+                    plot[0].canvas.draw()
+                    plot[0].canvas.flush_events()
+                    stamps['render'] = time.perf_counter() * 1e6
+                host[info['seq']] = stamps
+
+            # The trace packet follows its frame; pair them up
+            for seq in [s for s in traces if s in host]:
+                packet = traces.pop(seq)
+                if packet['sent']:
+                    records.append(dict(packet['us'], seq=seq, **host.pop(seq)))
+
+        # Unpaired leftovers (dropped frames or packets) must not pile up
+        if len(traces) > 64:
+            traces.clear()
+        if len(host) > 64:
+            host.clear()
+    return records
+
+
+def align(records, window_us, floor_us):
+    """Put device stamps on the host clock (per-window minimum offset)"""
+    if not records:
+        return
+    start = records[0]['read']
+    windows = {}
+    for rec in records:
+        key = int((rec['read'] - start) // window_us)
+        offset = rec['read'] - rec['submit']
+        windows[key] = min(windows.get(key, offset), offset)
+    for rec in records:
+        offset = windows[int((rec['read'] - start) // window_us)] - floor_us
+        for stage in ('icg', 'dma', 'ready', 'submit'):
+            rec[stage] += offset
+
+
+def report(records, render):
+    stages = STAGES if render else STAGES[:-1]
+    last = stages[-1][1]
+    print(f"\n📊 {len(records)} traced frames (ms)")
+    print(f"  {'stage':<20}{'min':>9}{'p50':>9}{'p90':>9}{'p99':>9}{'max':>9}")
+    for a, b in stages + [('icg', last)]:
+        values = np.array([rec[b] - rec[a] for rec in records]) / 1000.0
+        name = f"{a} -> {b}" if (a, b) != ('icg', last) else f"TOTAL icg -> {last}"
+        p50, p90, p99 = np.percentile(values, [50, 90, 99])
+        print(f"  {name:<20}{values.min():9.3f}{p50:9.3f}{p90:9.3f}{p99:9.3f}{values.max():9.3f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 end-to-end latency trace')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--seconds', type=float, default=10.0, help='Streaming time')
+    parser.add_argument('--render', action='store_true', help='Redraw a plot per frame')
+    parser.add_argument('--window', type=float, default=2.0,
+                        help='Clock offset window in seconds')
+    parser.add_argument('--floor-us', type=float, default=0.0,
+                        help='Assumed minimum USB transfer time per frame')
+    parser.add_argument('--csv', help='Write per-frame stamps (host clock, us)')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.05)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    try:
+        ser.write(b'TRACE:ON\n')
+        ser.write(b'START\n')
+        records = collect(ser, args.seconds, args.render)
+    finally:
+        ser.write(b'STOP\n')
+        time.sleep(0.2)
+        ser.write(b'TRACE:OFF\n')
+        ser.close()
+
+    if not records:
+        print("❌ No traced frames received")
+        sys.exit(1)
+
+    align(records, args.window * 1e6, args.floor_us)
+    report(records, args.render)
+
+    if args.csv:
+        fields = ['seq', 'icg', 'dma', 'ready', 'submit', 'read', 'deframe', 'process'] + \
+                 (['render'] if args.render else [])
+        with open(args.csv, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=fields, extrasaction='ignore')
+            writer.writeheader()
+            writer.writerows(records)
+        print(f"💾 {args.csv}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+USB Link Benchmark
+Characterises the raw CDC link with the firmware's link test modes, without
+any frame processing involved:
+
+  latency    LOOPBACK round trips of small packets -> percentiles
+  loopback   bulk OUT -> echo -> bulk IN at full rate, data verified
+  sink       bulk OUT only (device discards)
+  source     bulk IN only (SOURCE = USB_TPUT, pattern verified)
+
+If these numbers are fine but frames are lost, the limit is in the firmware
+(see STATS / PERF), not in the link.
+
+Usage:
+    python link_benchmark.py [port] [--bytes 1048576] [--pings 1000] [--ping-size 64]
+"""
+
+import argparse
+import os
+import statistics
+import sys
+import threading
+import time
+
+import serial
+
+from tcd1304_protocol import find_stm32_port
+from usb_throughput_test import parse_kv, run_throughput
+
+WRITE_BLOCK = 4096
+
+
+def command(ser, text, expect):
+    ser.write(text.encode('ascii') + b'\n')
+    response = ser.readline().decode('ascii', errors='ignore').strip()
+    if not response.startswith(expect):
+        raise RuntimeError(f'{text} rejected: {response}')
+    return response
+
+
+def read_exact(ser, count):
+    data = bytearray()
+    while len(data) < count:
+        block = ser.read(count - len(data))
+        if not block:
+            raise RuntimeError(f'Timeout after {len(data)} of {count} bytes')
+        data.extend(block)
+    return bytes(data)
+
+
+def result_line(ser, prefix):
+    line = ser.readline().decode('ascii', errors='ignore').strip()
+    if not line.startswith(prefix):
+        raise RuntimeError(f'Missing {prefix} result, got: {line!r}')
+    return parse_kv(line)
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, max(0, round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def run_latency(ser, pings, size):
+    """Round trip of one packet at a time; returns a list of ms values"""
+    command(ser, f'LOOPBACK:{pings * size}', 'OK:LOOPBACK')
+    times = []
+    for _ in range(pings):
+        payload = os.urandom(size)
+        start = time.perf_counter()
+        ser.write(payload)
+        echo = read_exact(ser, size)
+        times.append((time.perf_counter() - start) * 1000.0)
+        if echo != payload:
+            raise RuntimeError('Loopback data mismatch during latency test')
+    result_line(ser, 'LOOPBACK:')
+    return times
+
+
+def run_loopback(ser, total):
+    """Full-rate echo; returns (device result, host bytes/s, mismatching bytes)"""
+    payload = os.urandom(total)
+    command(ser, f'LOOPBACK:{total}', 'OK:LOOPBACK')
+
+    def writer():
+        for offset in range(0, total, WRITE_BLOCK):
+            ser.write(payload[offset:offset + WRITE_BLOCK])
+
+    thread = threading.Thread(target=writer, daemon=True)
+    start = time.perf_counter()
+    thread.start()
+    echo = read_exact(ser, total)
+    elapsed = time.perf_counter() - start
+    thread.join()
+
+    errors = sum(1 for a, b in zip(echo, payload) if a != b)
+    return result_line(ser, 'LOOPBACK:'), total / elapsed, errors
+
+
+def run_sink(ser, total):
+    """OUT only; returns (device result, host bytes/s)"""
+    payload = os.urandom(total)
+    command(ser, f'SINK:{total}', 'OK:SINK')
+    start = time.perf_counter()
+    for offset in range(0, total, WRITE_BLOCK):
+        ser.write(payload[offset:offset + WRITE_BLOCK])
+    ser.flush()
+    device = result_line(ser, 'SINK:')
+    return device, total / (time.perf_counter() - start)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 raw USB link benchmark')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--bytes', type=int, default=1 << 20, help='Bytes per throughput test')
+    parser.add_argument('--pings', type=int, default=1000, help='Round trips for latency')
+    parser.add_argument('--ping-size', type=int, default=64, help='Bytes per round trip')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=3)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    print("=" * 70)
+    print("TCD1304 USB LINK BENCHMARK")
+    print("=" * 70)
+
+    times = run_latency(ser, args.pings, args.ping_size)
+    print(f"\nLatency ({args.pings} x {args.ping_size} B round trips):")
+    print(f"  p50 {percentile(times, 50):.3f} ms   p90 {percentile(times, 90):.3f} ms   "
+          f"p99 {percentile(times, 99):.3f} ms   max {max(times):.3f} ms   "
+          f"mean {statistics.mean(times):.3f} ms")
+
+    dev, host_bps, errors = run_loopback(ser, args.bytes)
+    status = "✅" if errors == 0 else f"❌ {errors} bad bytes"
+    print(f"\nLoopback ({args.bytes} B each way):")
+    print(f"  device {dev['BPS'] / 1e3:.1f} kB/s, host {host_bps / 1e3:.1f} kB/s per direction, "
+          f"{dev['XFERS']} IN transfers  {status}")
+
+    dev, host_bps = run_sink(ser, args.bytes)
+    print(f"\nSink (OUT only, {args.bytes} B):")
+    print(f"  device {dev['BPS'] / 1e3:.1f} kB/s, host {host_bps / 1e3:.1f} kB/s")
+
+    dev, host_bps, errors = run_throughput(ser, args.bytes, 2048)
+    status = "✅" if errors == 0 else f"❌ {errors} bad bytes"
+    print(f"\nSource (IN only, {args.bytes} B, 2048 B transfers):")
+    print(f"  device {dev['BPS'] / 1e3:.1f} kB/s, host {host_bps / 1e3:.1f} kB/s  {status}")
+
+    ser.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,252 @@
+/**
+ ******************************************************************************
+ * @file    tcd1304_kernels.c
+ * @brief   Fused host pixel kernels: unpack + invert + dark subtract + float
+ ******************************************************************************
+ * @attention
+ *
+ * Host-side helper for python/tcd1304_kernels.py (loaded with ctypes, built
+ * on first use). One pass from the raw frame bytes to float32:
+ *
+ *     out[i] = (base + sign * pixel[i]) - dark[i]
+ *
+ *     inverted:  base = ADC_MAX_VALUE, sign = -1
+ *     as read:   base = 0,             sign = +1
+ *
+ * The bracket is an exact integer in float, so the result is rounded once,
+ * the same as numpy's float32(ADC_MAX_VALUE - pixels) - dark.
+ *
+ * Sources are raw16 (FRME pixels, little-endian u16) or packed12 (two
+ * pixels in three bytes, as ccd_data_layer_pack12 / PTRG payloads).
+ *
+ * Paths: AVX2, SSE4.1 and scalar, chosen at run time; all three give
+ * bit-identical results (no FMA contraction).
+ *
+ ******************************************************************************
+ */
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TK_X86 1
+#else
+#define TK_X86 0
+#endif
+
+/* SIMD levels */
+#define TK_SCALAR   0
+#define TK_SSE41    1
+#define TK_AVX2     2
+
+/**
+ * @brief Best level this CPU supports
+ */
+int tk_simd_level(void)
+{
+#if TK_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return TK_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return TK_SSE41;
+    }
+#endif
+    return TK_SCALAR;
+}
+
+/* ----------------------------------------------------------------------------
+ * Scalar
+ * ------------------------------------------------------------------------- */
+
+static void raw16_scalar(const uint8_t* src, const float* dark, float base, float sign,
+                         float* out, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t v = (uint16_t)(src[2 * i] | (src[2 * i + 1] << 8));
+        out[i] = (base + sign * (float)v) - dark[i];
+    }
+}
+
+static void packed12_scalar(const uint8_t* src, const float* dark, float base, float sign,
+                            float* out, uint32_t first, uint32_t count)
+{
+    // first is even: pixel pairs start on 3-byte boundaries
+    for (uint32_t i = first; i < count; i += 2) {
+        const uint8_t* b = &src[(i / 2) * 3];
+        uint16_t p0 = (uint16_t)(b[0] | ((b[1] & 0x0F) << 8));
+        out[i] = (base + sign * (float)p0) - dark[i];
+        if (i + 1 < count) {
+            uint16_t p1 = (uint16_t)((b[1] >> 4) | (b[2] << 4));
+            out[i + 1] = (base + sign * (float)p1) - dark[i + 1];
+        }
+    }
+}
+
+#if TK_X86
+
+/* Byte pairs for eight pixels from 12 bytes: lane 2k = [b0 b1], lane 2k+1 = [b1 b2] */
+#define TK_P12_SHUFFLE  0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11
+
+/* ----------------------------------------------------------------------------
+ * SSE4.1
+ * ------------------------------------------------------------------------- */
+
+__attribute__((target("sse4.1")))
+static inline void store4_sse(__m128i v32, const float* dark, __m128 base, __m128 sign,
+                              float* out)
+{
+    __m128 f = _mm_cvtepi32_ps(v32);
+    _mm_storeu_ps(out, _mm_sub_ps(_mm_add_ps(base, _mm_mul_ps(sign, f)), _mm_loadu_ps(dark)));
+}
+
+__attribute__((target("sse4.1")))
+static void raw16_sse41(const uint8_t* src, const float* dark, float base, float sign,
+                        float* out, uint32_t count)
+{
+    __m128 b = _mm_set1_ps(base);
+    __m128 s = _mm_set1_ps(sign);
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&src[2 * i]);
+        store4_sse(_mm_cvtepu16_epi32(v), &dark[i], b, s, &out[i]);
+        store4_sse(_mm_cvtepu16_epi32(_mm_srli_si128(v, 8)), &dark[i + 4], b, s, &out[i + 4]);
+    }
+    raw16_scalar(&src[2 * i], &dark[i], base, sign, &out[i], count - i);
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i unpack12_sse(const uint8_t* src)
+{
+    const __m128i shuffle = _mm_setr_epi8(TK_P12_SHUFFLE);
+    __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), shuffle);
+    __m128i even = _mm_and_si128(v, _mm_set1_epi16(0x0FFF));
+    __m128i odd = _mm_srli_epi16(v, 4);
+    return _mm_blend_epi16(even, odd, 0xAA);
+}
+
+__attribute__((target("sse4.1")))
+static void packed12_sse41(const uint8_t* src, const float* dark, float base, float sign,
+                           float* out, uint32_t count)
+{
+    __m128 b = _mm_set1_ps(base);
+    __m128 s = _mm_set1_ps(sign);
+    uint32_t i = 0;
+
+    // 16-byte loads for 12 bytes of data: stop while 4 spare bytes remain
+    for (; i + 8 <= count && (i / 2) * 3 + 16 <= ((count + 1) / 2) * 3; i += 8) {
+        __m128i v = unpack12_sse(&src[(i / 2) * 3]);
+        store4_sse(_mm_cvtepu16_epi32(v), &dark[i], b, s, &out[i]);
+        store4_sse(_mm_cvtepu16_epi32(_mm_srli_si128(v, 8)), &dark[i + 4], b, s, &out[i + 4]);
+    }
+    packed12_scalar(src, dark, base, sign, out, i, count);
+}
+
+/* ----------------------------------------------------------------------------
+ * AVX2
+ * ------------------------------------------------------------------------- */
+
+__attribute__((target("avx2")))
+static inline void store8_avx2(__m128i v16, const float* dark, __m256 base, __m256 sign,
+                               float* out)
+{
+    __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(v16));
+    _mm256_storeu_ps(out, _mm256_sub_ps(_mm256_add_ps(base, _mm256_mul_ps(sign, f)),
+                                         _mm256_loadu_ps(dark)));
+}
+
+__attribute__((target("avx2")))
+static void raw16_avx2(const uint8_t* src, const float* dark, float base, float sign,
+                       float* out, uint32_t count)
+{
+    __m256 b = _mm256_set1_ps(base);
+    __m256 s = _mm256_set1_ps(sign);
+    uint32_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)&src[2 * i]);
+        store8_avx2(_mm256_castsi256_si128(v), &dark[i], b, s, &out[i]);
+        store8_avx2(_mm256_extracti128_si256(v, 1), &dark[i + 8], b, s, &out[i + 8]);
+    }
+    raw16_scalar(&src[2 * i], &dark[i], base, sign, &out[i], count - i);
+}
+
+__attribute__((target("avx2")))
+static void packed12_avx2(const uint8_t* src, const float* dark, float base, float sign,
+                          float* out, uint32_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(TK_P12_SHUFFLE, TK_P12_SHUFFLE);
+    const __m256i mask = _mm256_set1_epi16(0x0FFF);
+    __m256 b = _mm256_set1_ps(base);
+    __m256 s = _mm256_set1_ps(sign);
+    uint32_t bytes = ((count + 1) / 2) * 3;
+    uint32_t i = 0;
+
+    // 16 pixels from 24 bytes, as two 12-byte halves; the upper load reads
+    // 4 bytes past the data
+    for (; i + 16 <= count && (i / 2) * 3 + 28 <= bytes; i += 16) {
+        const uint8_t* p = &src[(i / 2) * 3];
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)p)),
+            _mm_loadu_si128((const __m128i*)(p + 12)), 1);
+        v = _mm256_shuffle_epi8(v, shuffle);
+        v = _mm256_blend_epi16(_mm256_and_si256(v, mask), _mm256_srli_epi16(v, 4), 0xAA);
+        store8_avx2(_mm256_castsi256_si128(v), &dark[i], b, s, &out[i]);
+        store8_avx2(_mm256_extracti128_si256(v, 1), &dark[i + 8], b, s, &out[i + 8]);
+    }
+    packed12_scalar(src, dark, base, sign, out, i, count);
+}
+
+#endif /* TK_X86 */
+
+/* ----------------------------------------------------------------------------
+ * Entry points
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief raw16 frame pixels to float32
+ * @param src count little-endian u16 pixels
+ * @param dark Per-pixel dark frame (zeros for none)
+ * @param base ADC_MAX_VALUE (inverted) or 0
+ * @param sign -1 (inverted) or +1
+ * @param level TK_* path; above tk_simd_level() is not checked
+ */
+void tk_raw16_to_f32(const uint8_t* src, const float* dark, float base, float sign,
+                     float* out, uint32_t count, int level)
+{
+#if TK_X86
+    if (level >= TK_AVX2) {
+        raw16_avx2(src, dark, base, sign, out, count);
+        return;
+    }
+    if (level >= TK_SSE41) {
+        raw16_sse41(src, dark, base, sign, out, count);
+        return;
+    }
+#endif
+    (void)level;
+    raw16_scalar(src, dark, base, sign, out, count);
+}
+
+/**
+ * @brief packed12 pixels to float32
+ * @param src ((count + 1) / 2) * 3 bytes
+ */
+void tk_packed12_to_f32(const uint8_t* src, const float* dark, float base, float sign,
+                        float* out, uint32_t count, int level)
+{
+#if TK_X86
+    if (level >= TK_AVX2) {
+        packed12_avx2(src, dark, base, sign, out, count);
+        return;
+    }
+    if (level >= TK_SSE41) {
+        packed12_sse41(src, dark, base, sign, out, count);
+        return;
+    }
+#endif
+    (void)level;
+    packed12_scalar(src, dark, base, sign, out, 0, count);
+}
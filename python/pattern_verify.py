@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+Test Pattern Verifier
+Switches the firmware to a synthetic test pattern (PATTERN command), streams
+frames at full rate and checks every pixel bit-exactly against the pattern
+regenerated on the host. Reports sustained throughput, frame gaps, CRC
+errors and the first mismatching pixels.
+
+A mismatch with a good CRC points at the device copy/encoding; a bad CRC at
+the USB link or the host; seq gaps at drops (see STATS DROPPED).
+
+Usage:
+    python pattern_verify.py [port] --pattern prbs --seconds 30
+    python pattern_verify.py [port] --pattern const --value 0x800
+"""
+
+import argparse
+import sys
+import time
+
+import numpy as np
+import serial
+
+from tcd1304_protocol import (find_stm32_port, find_frame_start, frame_size,
+                              parse_frame_info, CCD_PIXEL_COUNT)
+
+PATTERNS = ('ramp', 'const', 'prbs', 'counter')
+CONST_DEFAULT = 0x0A5A
+_PIXEL_INDEX = np.arange(CCD_PIXEL_COUNT, dtype=np.uint32)
+
+
+def _lowbias32(x):
+    x = x ^ (x >> np.uint32(16))
+    x = x * np.uint32(0x7FEB352D)
+    x = x ^ (x >> np.uint32(15))
+    x = x * np.uint32(0x846CA68B)
+    x = x ^ (x >> np.uint32(16))
+    return x
+
+
+def expected_pixels(pattern, seq, bits=12, value=CONST_DEFAULT):
+    """Pixels the firmware generates for a readout (see test_pattern.h)"""
+    mask = (1 << bits) - 1
+    with np.errstate(over='ignore'):
+        if pattern == 'ramp':
+            pixels = (_PIXEL_INDEX + np.uint32(seq)) & np.uint32(0x0FFF)
+        elif pattern == 'const':
+            pixels = np.full(CCD_PIXEL_COUNT, value, dtype=np.uint32)
+        elif pattern == 'prbs':
+            base = np.uint32((seq * 0x9E3779B1) & 0xFFFFFFFF)
+            pixels = _lowbias32(base + _PIXEL_INDEX) >> np.uint32(20)
+        elif pattern == 'counter':
+            pixels = (np.uint32(seq * CCD_PIXEL_COUNT) + _PIXEL_INDEX) & np.uint32(0x0FFF)
+        else:
+            raise ValueError(f'Unknown pattern {pattern}')
+    return (pixels & np.uint32(mask)).astype(np.uint16)
+
+
+def command(ser, text, expect):
+    ser.write(text.encode('ascii') + b'\n')
+    deadline = time.time() + 1.0
+    while time.time() < deadline:
+        response = ser.readline().decode('ascii', errors='ignore').strip()
+        if response.startswith(expect):
+            return response
+        if response.startswith('ERROR'):
+            raise RuntimeError(f'{text} rejected: {response}')
+    raise RuntimeError(f'No reply to {text}')
+
+
+def verify(ser, pattern, value, seconds, show):
+    stats = {'frames': 0, 'bytes': 0, 'crc_errors': 0, 'bad_frames': 0,
+             'bad_pixels': 0, 'missed': 0, 'bits': set()}
+    errors = []
+    data = bytearray()
+    last_seq = None
+    start = None
+    end = time.time() + seconds
+
+    while time.time() < end:
+        data.extend(ser.read(max(1, ser.in_waiting)))
+        while True:
+            at = find_frame_start(data)
+            if at < 0:
+                del data[:max(0, len(data) - 3)]
+                break
+            del data[:at]
+            size = frame_size(data)
+            if size is None or len(data) < size:
+                break
+            info = parse_frame_info(bytes(data[:size]))
+            if info is None:
+                # Marker inside other data: resync one byte on
+                del data[:1]
+                continue
+            del data[:size]
+
+            now = time.perf_counter()
+            if start is None:
+                # Throughput is measured from the first complete frame
+                start = now
+                last_seq = info['seq']
+                stats['first'] = now
+                continue
+
+            stats['frames'] += 1
+            stats['bytes'] += size
+            stats['last'] = now
+            stats['bits'].add(info['bits'])
+            stats['missed'] += (info['seq'] - last_seq - 1) & 0xFFFF
+            last_seq = info['seq']
+
+            if not info['crc_ok']:
+                stats['crc_errors'] += 1
+            expected = expected_pixels(pattern, info['seq'], info['bits'], value)
+            got = np.asarray(info['raw'], dtype=np.uint16)
+            bad = np.nonzero(got != expected)[0]
+            if len(bad):
+                stats['bad_frames'] += 1
+                stats['bad_pixels'] += len(bad)
+                for i in bad[:max(0, show - len(errors))]:
+                    errors.append((info['seq'], int(i), int(expected[i]), int(got[i]),
+                                   info['crc_ok']))
+    return stats, errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 bit-exact test pattern verifier')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--pattern', choices=PATTERNS, default='prbs')
+    parser.add_argument('--value', type=lambda s: int(s, 0), default=CONST_DEFAULT,
+                        help='Pixel value for the const pattern')
+    parser.add_argument('--seconds', type=float, default=10.0, help='Streaming time')
+    parser.add_argument('--show', type=int, default=20, help='Mismatches to list')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.1)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    pattern_cmd = f'PATTERN:{args.pattern.upper()}'
+    if args.pattern == 'const':
+        pattern_cmd += f',{args.value}'
+    command(ser, pattern_cmd, 'OK:PATTERN')
+
+    try:
+        command(ser, 'START', 'OK:STARTED')
+        stats, errors = verify(ser, args.pattern, args.value, args.seconds, args.show)
+    finally:
+        ser.write(b'STOP\n')
+        time.sleep(0.2)
+        ser.write(b'PATTERN:OFF\n')
+        time.sleep(0.1)
+        ser.close()
+
+    frames = stats['frames']
+    elapsed = stats.get('last', 0) - stats.get('first', 0)
+    print(f"Pattern:      {args.pattern}  (ADC bits: {sorted(stats['bits']) or '-'})")
+    print(f"Frames:       {frames}, missed (seq gaps): {stats['missed']}")
+    if frames and elapsed > 0:
+        print(f"Throughput:   {stats['bytes'] / elapsed / 1e6:.3f} MB/s, "
+              f"{frames / elapsed:.1f} frames/s over {elapsed:.1f} s")
+    print(f"CRC errors:   {stats['crc_errors']}")
+    print(f"Bad frames:   {stats['bad_frames']} ({stats['bad_pixels']} pixels)")
+    for seq, pixel, expected, got, crc_ok in errors:
+        print(f"  seq {seq:5d} pixel {pixel:4d}: expected 0x{expected:03X}, got 0x{got:03X}"
+              f"{'' if crc_ok else '  (CRC bad)'}")
+
+    ok = frames > 0 and stats['crc_errors'] == 0 and stats['bad_frames'] == 0
+    print("✅ Bit-exact" if ok else "❌ Errors found")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == '__main__':
+    main()
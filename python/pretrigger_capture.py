@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""
+Pre-trigger Capture
+Arms the firmware's pre-trigger ring, waits for a software or GPIO trigger,
+and collects the K pre-trigger and M post-trigger frames with their sequence
+numbers. Optionally saves the frames as CSV (one row per frame).
+
+Usage:
+    python pretrigger_capture.py [port] --pre 8 --post 4 --roi 1000,512 --sw-trigger 1.0
+    python pretrigger_capture.py [port] --pre 2 --post 1            (wait for PB0 edge)
+"""
+
+import argparse
+import csv
+import re
+import sys
+import time
+
+import serial
+
+from tcd1304_protocol import (find_stm32_port, parse_pretrig_packet,
+                              PRETRIG_FLAG_POST, PRETRIG_FLAG_TRIGGER)
+
+DUMP_LINE = re.compile(r'PRETRIG_DUMP:PRE:(\d+),POST:(\d+),TRIG_SEQ:(\d+),'
+                       r'ROI:(\d+),(\d+),SOURCE:(\w+)')
+
+
+def read_line(ser):
+    return ser.readline().decode('ascii', errors='ignore').strip()
+
+
+def capture(ser, pre, post, roi=None, sw_trigger_delay=None, timeout=30.0):
+    """Arm, trigger (optionally) and return (dump info dict, list of packets)"""
+    command = f'PRETRIG:{pre},{post}'
+    if roi:
+        command += f',{roi[0]},{roi[1]}'
+    ser.write(command.encode('ascii') + b'\n')
+    response = read_line(ser)
+    if not response.startswith('OK:PRETRIG_ARMED'):
+        raise RuntimeError(f'PRETRIG rejected: {response}')
+    print(f"🎯 {response}")
+
+    if sw_trigger_delay is not None:
+        # Let the ring fill with pre-trigger frames first
+        time.sleep(sw_trigger_delay)
+        ser.write(b'TRIGGER\n')
+        response = read_line(ser)
+        if response != 'OK:TRIGGERED':
+            raise RuntimeError(f'TRIGGER rejected: {response}')
+    else:
+        print("⏳ Waiting for trigger input (PB0 rising edge)...")
+
+    deadline = time.time() + timeout
+    info = None
+    while info is None:
+        if time.time() > deadline:
+            raise RuntimeError('No PRETRIG_DUMP received')
+        match = DUMP_LINE.match(read_line(ser))
+        if match:
+            info = dict(zip(['PRE', 'POST', 'TRIG_SEQ', 'ROI_START', 'ROI_LEN', 'SOURCE'],
+                            match.groups()))
+
+    expected = int(info['PRE']) + int(info['POST'])
+    packets = []
+    data = bytearray()
+    while len(packets) < expected:
+        block = ser.read(max(1, ser.in_waiting))
+        if not block and time.time() > deadline:
+            raise RuntimeError(f'Dump incomplete: {len(packets)}/{expected} frames')
+        data.extend(block)
+        while True:
+            packet, used = parse_pretrig_packet(data)
+            if packet is None:
+                break
+            packets.append(packet)
+            del data[:used]
+
+    rest = bytes(data)
+    if not rest.endswith(b'\n'):
+        rest += ser.readline()
+    done = rest.decode('ascii', errors='ignore').strip()
+    if done != 'OK:PRETRIG_DONE':
+        print(f"⚠️  Expected OK:PRETRIG_DONE, got {done!r}")
+    return info, packets
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 pre-trigger capture')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--pre', type=int, default=4, help='Pre-trigger frames (K)')
+    parser.add_argument('--post', type=int, default=2, help='Post-trigger frames (M)')
+    parser.add_argument('--roi', help='start,length of the stored pixel range')
+    parser.add_argument('--sw-trigger', type=float, metavar='SECONDS',
+                        help='Send TRIGGER after this delay instead of waiting for PB0')
+    parser.add_argument('--csv', help='Save frames to this CSV file')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    roi = tuple(int(v) for v in args.roi.split(',')) if args.roi else None
+
+    ser = serial.Serial(port_name, 115200, timeout=1)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    try:
+        info, packets = capture(ser, args.pre, args.post, roi, args.sw_trigger)
+    finally:
+        ser.close()
+
+    print(f"📦 Trigger seq {info['TRIG_SEQ']} via {info['SOURCE']}, "
+          f"{info['PRE']} pre + {info['POST']} post frames, ROI {info['ROI_START']}+{info['ROI_LEN']}")
+    previous = None
+    for p in packets:
+        role = 'TRIGGER' if p['flags'] & PRETRIG_FLAG_TRIGGER else (
+            'post' if p['flags'] & PRETRIG_FLAG_POST else 'pre')
+        gap = '' if previous is None or p['seq'] == (previous + 1) & 0xFFFF else '  ⚠️ gap'
+        crc = '✅' if p['crc_ok'] else '❌ CRC'
+        print(f"  seq {p['seq']:5d}  {role:<7}  mean {sum(p['pixels']) / len(p['pixels']):7.1f}  "
+              f"{crc}{gap}")
+        previous = p['seq']
+
+    if args.csv:
+        with open(args.csv, 'w', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(['seq', 'flags', 'roi_start'] +
+                            [f'px{i}' for i in range(packets[0]['pixel_count'])])
+            for p in packets:
+                writer.writerow([p['seq'], p['flags'], p['roi_start']] + p['pixels'])
+        print(f"💾 Saved {len(packets)} frames to {args.csv}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+SNAP Latency
+Requests single-shot frames with SNAP (or arms SNAP:GPIO and waits for PB0
+edges) and reports the device-side trigger-to-readout and processing times
+from the SNAP info line, plus the host round trip from writing SNAP to
+having the complete frame.
+
+Usage:
+    python snap_latency.py [port] --count 50
+    python snap_latency.py [port] --gpio --count 10     (one PB0 edge per shot)
+"""
+
+import argparse
+import re
+import statistics
+import sys
+import time
+
+import serial
+
+from tcd1304_protocol import find_stm32_port, parse_frame, frame_size, find_frame_start
+
+SNAP_LINE = re.compile(rb'SNAP:SEQ:(\d+),SOURCE:(\w+),TRIG_MS:(\d+),LATENCY_US:(\d+),PROC_US:(\d+)\n')
+
+
+def snap_once(ser, gpio=False, timeout=5.0):
+    """Request one snap; returns (info dict, frame tuple, host round trip in ms)"""
+    ser.reset_input_buffer()
+    if gpio:
+        ser.write(b'SNAP:GPIO\n')
+        response = ser.readline().decode('ascii', errors='ignore').strip()
+        if response != 'OK:SNAP_ARMED':
+            raise RuntimeError(f'SNAP:GPIO rejected: {response}')
+    else:
+        ser.write(b'SNAP\n')
+    sent = time.perf_counter()
+
+    deadline = time.time() + timeout
+    data = bytearray()
+    info = None
+    while True:
+        if time.time() > deadline:
+            if gpio:
+                ser.write(b'SNAP:CANCEL\n')
+            raise RuntimeError('SNAP timed out')
+        data.extend(ser.read(max(1, ser.in_waiting)))
+
+        if info is None:
+            if b'ERROR:SNAP_BUSY' in data:
+                raise RuntimeError('ERROR:SNAP_BUSY')
+            match = SNAP_LINE.search(data)
+            if not match:
+                continue
+            info = dict(zip(['SEQ', 'SOURCE', 'TRIG_MS', 'LATENCY_US', 'PROC_US'],
+                            [int(match.group(1)), match.group(2).decode(),
+                             int(match.group(3)), int(match.group(4)), int(match.group(5))]))
+            del data[:match.end()]
+
+        start = find_frame_start(data)
+        size = frame_size(data, start) if start >= 0 else None
+        if size is not None and len(data) - start >= size:
+            received = time.perf_counter()
+            frame = parse_frame(bytes(data[start:start + size]))
+            if frame is None:
+                raise RuntimeError('Malformed frame after SNAP line')
+            if frame[0] != info['SEQ']:
+                raise RuntimeError(f"Frame {frame[0]} does not match SNAP seq {info['SEQ']}")
+            return info, frame, (received - sent) * 1000.0
+
+
+def summary(name, values, unit):
+    values = sorted(values)
+    p95 = values[min(len(values) - 1, int(round(0.95 * (len(values) - 1))))]
+    print(f"  {name:<18} min {values[0]:9.1f}  median {statistics.median(values):9.1f}  "
+          f"p95 {p95:9.1f}  max {values[-1]:9.1f} {unit}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 SNAP latency measurement')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--count', type=int, default=20, help='Number of snaps')
+    parser.add_argument('--gpio', action='store_true',
+                        help='Arm SNAP:GPIO and wait for a PB0 edge per snap')
+    parser.add_argument('--timeout', type=float, default=5.0, help='Seconds to wait per snap')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.1)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    latency, proc, host, crc_errors = [], [], [], 0
+    try:
+        for i in range(args.count):
+            if args.gpio:
+                print(f"⏳ Snap {i + 1}/{args.count}: waiting for PB0 edge...")
+            info, frame, round_trip = snap_once(ser, args.gpio, args.timeout)
+            latency.append(info['LATENCY_US'])
+            proc.append(info['PROC_US'])
+            host.append(round_trip)
+            crc_errors += 0 if frame[2] else 1
+            print(f"📸 seq {info['SEQ']:5d} {info['SOURCE']:<4}  trigger->readout "
+                  f"{info['LATENCY_US']:7d} us  proc {info['PROC_US']:5d} us  "
+                  f"host {round_trip:7.2f} ms  {'✅' if frame[2] else '❌ CRC'}")
+    finally:
+        ser.close()
+
+    print(f"\n📊 {len(latency)} snaps, {crc_errors} CRC errors")
+    summary('trigger->readout', latency, 'us')
+    summary('processing', proc, 'us')
+    summary('host round trip', host, 'ms')
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Stream Recorder
+Records the raw frame stream to a file and tags it with MARK packets, so a
+long recording splits into segments (stimulus on/off, sample changes, ...)
+by index lookup instead of by host timestamps. Marks are sent every
+--mark-every seconds, and/or typed on stdin as an id per line.
+
+The recording is the byte stream as received. --index scans a recording
+for MARK packets (CRC checked, so pixel bytes that happen to read "MARK"
+are skipped) and prints each segment: id, first readout seq, byte offset.
+A JSON index is written next to every new recording.
+
+Usage:
+    python stream_recorder.py [port] --out run.bin --seconds 60 --mark-every 10
+    python stream_recorder.py [port] --out run.bin --seconds 60 --stdin-marks
+    python stream_recorder.py --index run.bin
+"""
+
+import argparse
+import json
+import os
+import select
+import sys
+import time
+
+import serial
+
+from tcd1304_protocol import find_stm32_port, parse_mark_packet, MARK_MARKER
+
+
+def scan_marks(data):
+    """Return the MARK packets in a recording, with their byte offsets"""
+    marks = []
+    at = data.find(MARK_MARKER)
+    while at >= 0:
+        packet, used = parse_mark_packet(data, at)
+        if packet is not None and packet['crc_ok']:
+            packet['offset'] = at
+            marks.append(packet)
+            at = data.find(MARK_MARKER, at + used)
+        else:
+            at = data.find(MARK_MARKER, at + 1)
+    return marks
+
+
+def print_index(marks, total):
+    if not marks:
+        print("No MARK packets found")
+        return
+    print(f"{'id':>10} {'seq':>6} {'tick_ms':>10} {'offset':>12} {'bytes':>12}")
+    for i, mark in enumerate(marks):
+        end = marks[i + 1]['offset'] if i + 1 < len(marks) else total
+        print(f"{mark['id']:>10} {mark['seq']:>6} {mark['tick_ms']:>10} "
+              f"{mark['offset']:>12} {end - mark['offset']:>12}")
+
+
+def send_mark(ser, mark_id):
+    # Replies come back inside the stream; the recording keeps them too
+    ser.write(f'MARK:{mark_id}\n'.encode('ascii'))
+
+
+def stdin_marks():
+    """Yield ids typed on stdin without blocking (POSIX terminals)"""
+    while select.select([sys.stdin], [], [], 0)[0]:
+        line = sys.stdin.readline().strip()
+        if line.isdigit():
+            yield int(line)
+
+
+def record(args):
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.05)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    next_id = args.first_id
+    total = 0
+    with open(args.out, 'wb') as out:
+        try:
+            # Segment 0 starts with the first recorded readout
+            send_mark(ser, next_id)
+            next_id += 1
+            ser.write(b'START\n')
+            start = time.time()
+            next_mark = start + args.mark_every if args.mark_every > 0 else None
+
+            while time.time() - start < args.seconds:
+                chunk = ser.read(max(1, ser.in_waiting))
+                out.write(chunk)
+                total += len(chunk)
+
+                now = time.time()
+                if next_mark is not None and now >= next_mark:
+                    send_mark(ser, next_id)
+                    next_id += 1
+                    next_mark += args.mark_every
+                if args.stdin_marks:
+                    for mark_id in stdin_marks():
+                        send_mark(ser, mark_id)
+        finally:
+            ser.write(b'STOP\n')
+            time.sleep(0.2)
+            chunk = ser.read(ser.in_waiting)
+            out.write(chunk)
+            total += len(chunk)
+            ser.close()
+
+    with open(args.out, 'rb') as f:
+        marks = scan_marks(f.read())
+    index_path = os.path.splitext(args.out)[0] + '.marks.json'
+    with open(index_path, 'w') as f:
+        json.dump({'recording': os.path.basename(args.out), 'bytes': total, 'marks': marks}, f, indent=1)
+
+    print(f"📼 {total} bytes in {args.out}, {len(marks)} marks (index: {index_path})")
+    print_index(marks, total)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 stream recorder with MARK segmentation')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--out', default='recording.bin', help='Recording file')
+    parser.add_argument('--seconds', type=float, default=10.0, help='Recording length')
+    parser.add_argument('--mark-every', type=float, default=0.0,
+                        help='Send a mark with the next id every n seconds (0 = off)')
+    parser.add_argument('--first-id', type=int, default=0, help='Id of the opening mark')
+    parser.add_argument('--stdin-marks', action='store_true',
+                        help='Send a mark for every id typed on stdin')
+    parser.add_argument('--index', metavar='FILE', help='Print the segments of a recording and exit')
+    args = parser.parse_args()
+
+    if args.index:
+        with open(args.index, 'rb') as f:
+            data = f.read()
+        print_index(scan_marks(data), len(data))
+        return
+
+    record(args)
+
+
+if __name__ == "__main__":
+    main()
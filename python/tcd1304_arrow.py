@@ -0,0 +1,446 @@
+#!/usr/bin/env python3
+"""
+TCD1304 Arrow Export
+Frames plus metadata as Apache Arrow record batches instead of a DataFrame
+or CSV per frame. pandas, polars, DuckDB and notebooks read the result
+directly; the pixel block of each batch is one contiguous uint16 buffer.
+
+Schema (one row per frame):
+    seq        uint16      frame counter
+    host_time  timestamp   when the host had the frame (null when converted)
+    bits       uint8       12 (FRME) or 10/8 (FRMX)
+    settling   bool        SETTLE FLAG mode
+    crc_ok     bool
+    mark       uint32      id of the last MARK before the frame (converted
+                           recordings; null live)
+    pixels     fixed_size_list<uint16>[3694], scaled to 12 bits as read
+               (not inverted)
+
+Outputs:
+    --out run.arrow     Arrow IPC file: memory-map it and read without copying
+    --serve HOST:PORT   Arrow IPC stream over TCP to every client that connects;
+                        each client gets the schema, then the live batches.
+                        Every client has its own writer thread behind a queue
+                        of CLIENT_QUEUE_BATCHES; a client that far behind
+                        loses batches (seq gaps) instead of stalling capture
+
+Batches are written every --batch frames or --flush-ms, whichever comes
+first, so live readers see new data at least that often (a partial batch
+is flushed on time even when frames stop coming).
+
+    table = open_recording('run.arrow')         # memory mapped
+    pixels = pixel_matrix(table)                # (frames, 3694) uint16 view
+    df = table.drop_columns(['pixels']).to_pandas()
+
+    for batch in attach('localhost:5555'):      # live
+        print(batch.num_rows, pixel_matrix(batch).mean())
+
+Usage:
+    python tcd1304_arrow.py [port] --out run.arrow --seconds 60
+    python tcd1304_arrow.py [port] --serve 0.0.0.0:5555 --seconds 0      # until Ctrl-C
+    python tcd1304_arrow.py --convert run.bin [--out run.arrow]          # stream_recorder.py file
+    python tcd1304_arrow.py --attach localhost:5555
+    python tcd1304_arrow.py --info run.arrow
+"""
+
+import argparse
+import os
+import queue
+import socket
+import struct
+import sys
+import threading
+import time
+
+import numpy as np
+import pyarrow as pa
+import serial
+
+from tcd1304_protocol import (find_stm32_port, crc16, frame_size, find_frame_start,
+                              packed10_size, CCD_PIXEL_COUNT, FRAME_START_MARKER,
+                              FRAME_END_MARKER, FRAME_HEADER_SIZE, FRAME_FOOTER_SIZE,
+                              FRAMEX_HEADER_SIZE, FRAME_FLAG_SETTLING, ADC_FULL_SCALE_BITS)
+from tcd1304_ingest import SerialIngest
+
+SCHEMA = pa.schema([
+    ('seq', pa.uint16()),
+    ('host_time', pa.timestamp('ns', tz='UTC')),
+    ('bits', pa.uint8()),
+    ('settling', pa.bool_()),
+    ('crc_ok', pa.bool_()),
+    ('mark', pa.uint32()),
+    ('pixels', pa.list_(pa.uint16(), CCD_PIXEL_COUNT)),
+])
+
+BATCH_FRAMES = 64
+FLUSH_MS = 250
+CLIENT_QUEUE_BATCHES = 8        # Batches a --serve client may fall behind before it loses some
+POLL_S = 0.1                    # Longest ingest window between --flush-ms checks
+
+
+def decode_pixels(frame, out):
+    """
+    Pixels of an FRME / FRMX frame into out (uint16[3694]), scaled to 12 bits.
+    Returns (seq, bits, settling, crc_ok) or None if malformed.
+    """
+    size = frame_size(frame)
+    if size is None or len(frame) != size or frame[size - 6:size - 2] != FRAME_END_MARKER:
+        return None
+    seq, count = struct.unpack_from('<HH', frame, 4)
+    checksum, = struct.unpack_from('<H', frame, size - 2)
+    if count != CCD_PIXEL_COUNT:
+        return None
+
+    settling = False
+    if frame[:4] == FRAME_START_MARKER:
+        bits = ADC_FULL_SCALE_BITS
+        out[:] = np.frombuffer(frame, dtype='<u2', count=count, offset=FRAME_HEADER_SIZE)
+    else:
+        bits = frame[8]
+        settling = bool(frame[9] & FRAME_FLAG_SETTLING)
+        payload = np.frombuffer(frame, dtype=np.uint8, offset=FRAMEX_HEADER_SIZE,
+                                count=size - FRAMEX_HEADER_SIZE - FRAME_FOOTER_SIZE)
+        if bits == 8 and len(payload) == count:
+            out[:] = payload
+        elif bits == 10 and len(payload) == packed10_size(count):
+            # Four pixels per five bytes, LSB-first (tcd1304_protocol.unpack10)
+            groups = payload.reshape(-1, 5).astype(np.uint64)
+            word = groups[:, 0]
+            for k in range(1, 5):
+                word = word | (groups[:, k] << np.uint64(8 * k))
+            shifts = np.arange(4, dtype=np.uint64) * np.uint64(10)
+            out[:] = ((word[:, None] >> shifts) & np.uint64(0x3FF)).ravel()[:count]
+        else:
+            return None
+        out <<= ADC_FULL_SCALE_BITS - bits
+
+    return seq, bits, settling, crc16(frame[:-2]) == checksum
+
+
+class FrameBatcher:
+    """Collects frames into record batches and hands each batch to the sinks"""
+
+    def __init__(self, sinks, batch_frames=BATCH_FRAMES, flush_ms=FLUSH_MS):
+        self.sinks = sinks
+        self.batch_frames = batch_frames
+        self.flush_s = flush_ms / 1000.0
+        self.frames = 0
+        self.batches = 0
+        self.rejected = 0
+        self._new_block()
+
+    def _new_block(self):
+        # One allocation per batch; the batch keeps the arrays, nothing is copied into Arrow
+        n = self.batch_frames
+        self.pixels = np.empty((n, CCD_PIXEL_COUNT), dtype=np.uint16)
+        self.seq = np.empty(n, dtype=np.uint16)
+        self.host_time = np.empty(n, dtype=np.int64)
+        self.bits = np.empty(n, dtype=np.uint8)
+        self.settling = np.empty(n, dtype=bool)
+        self.crc_ok = np.empty(n, dtype=bool)
+        self.mark = np.empty(n, dtype=np.uint32)
+        self.has_time = self.has_mark = False
+        self.rows = 0
+        self.opened = time.monotonic()
+
+    def add(self, frame, host_time_ns=None, mark=None):
+        info = decode_pixels(frame, self.pixels[self.rows])
+        if info is None:
+            self.rejected += 1
+            return
+        i = self.rows
+        self.seq[i], self.bits[i], self.settling[i], self.crc_ok[i] = info
+        self.host_time[i] = host_time_ns if host_time_ns is not None else 0
+        self.mark[i] = mark if mark is not None else 0
+        self.has_time |= host_time_ns is not None
+        self.has_mark |= mark is not None
+        self.rows += 1
+        self.frames += 1
+        if self.rows == self.batch_frames:
+            self.flush()
+        else:
+            self.poll()
+
+    def poll(self):
+        """Flush a partial batch once --flush-ms has passed"""
+        if self.rows and time.monotonic() - self.opened >= self.flush_s:
+            self.flush()
+
+    def flush(self):
+        if not self.rows:
+            return
+        n = self.rows
+        pixels = pa.FixedSizeListArray.from_arrays(pa.array(self.pixels[:n].reshape(-1)),
+                                                   CCD_PIXEL_COUNT)
+        batch = pa.record_batch([
+            pa.array(self.seq[:n]),
+            pa.array(self.host_time[:n], type=pa.timestamp('ns', tz='UTC'))
+            if self.has_time else pa.nulls(n, pa.timestamp('ns', tz='UTC')),
+            pa.array(self.bits[:n]),
+            pa.array(self.settling[:n]),
+            pa.array(self.crc_ok[:n]),
+            pa.array(self.mark[:n]) if self.has_mark else pa.nulls(n, pa.uint32()),
+            pixels,
+        ], schema=self.sinks.schema)
+        self.sinks.write(batch)
+        self.batches += 1
+        self._new_block()
+
+
+class StreamClient:
+    """One --serve connection: a writer thread fed through a bounded queue"""
+
+    def __init__(self, conn, address, schema):
+        self.conn = conn
+        self.address = address
+        self.schema = schema
+        self.queue = queue.Queue(CLIENT_QUEUE_BATCHES)
+        self.dropped = 0
+        self.alive = True
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def offer(self, batch):
+        """Queue a batch without blocking; a full queue drops it"""
+        try:
+            self.queue.put_nowait(batch)
+        except queue.Full:
+            self.dropped += 1
+
+    def _run(self):
+        try:
+            with self.conn.makefile('wb') as sink:
+                writer = pa.ipc.new_stream(sink, self.schema)
+                while True:
+                    batch = self.queue.get()
+                    if batch is None:
+                        writer.close()
+                        break
+                    writer.write_batch(batch)
+                    sink.flush()
+        except (OSError, pa.ArrowException):
+            pass
+        finally:
+            self.alive = False
+            self.conn.close()
+
+    def close(self, timeout=1.0):
+        """End the stream after the queued batches; a stuck client is cut off"""
+        try:
+            self.queue.put(None, timeout=timeout)
+        except queue.Full:
+            try:
+                self.conn.shutdown(socket.SHUT_RDWR)    # Unblocks the writer
+            except OSError:
+                pass
+        self.thread.join(timeout)
+
+
+class Sinks:
+    """IPC file and/or TCP stream clients receiving the same batches"""
+
+    def __init__(self, schema, path=None, serve=None):
+        self.schema = schema
+        self.file_writer = pa.ipc.new_file(path, schema) if path else None
+        self.clients = []
+        self.lock = threading.Lock()
+        self.server = None
+        if serve:
+            host, port = serve.rsplit(':', 1)
+            self.server = socket.create_server((host, int(port)))
+            threading.Thread(target=self._accept, daemon=True).start()
+
+    def _accept(self):
+        while True:
+            try:
+                conn, address = self.server.accept()
+            except OSError:
+                return
+            conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            with self.lock:
+                self.clients.append(StreamClient(conn, address, self.schema))
+            print(f"🔌 client {address[0]}:{address[1]}")
+
+    def write(self, batch):
+        """File write in line; clients only get the batch queued (never blocks)"""
+        if self.file_writer:
+            self.file_writer.write_batch(batch)
+        with self.lock:
+            for client in [c for c in self.clients if not c.alive]:
+                self._report(client)
+                self.clients.remove(client)
+            for client in self.clients:
+                client.offer(batch)
+
+    @staticmethod
+    def _report(client):
+        host, port = client.address[:2]
+        print(f"🔌 client {host}:{port} left ({client.dropped} batches dropped)")
+
+    def close(self):
+        if self.file_writer:
+            self.file_writer.close()
+        if self.server:
+            self.server.close()
+        with self.lock:
+            for client in self.clients:
+                client.close()
+                self._report(client)
+            self.clients = []
+
+
+# --- readers ---------------------------------------------------------------
+
+def open_recording(path):
+    """Arrow IPC file as a Table, memory mapped (no copy)"""
+    return pa.ipc.open_file(pa.memory_map(path)).read_all()
+
+
+def attach(address):
+    """Record batches of a --serve stream, as they arrive"""
+    host, port = address.rsplit(':', 1)
+    conn = socket.create_connection((host, int(port)))
+    with conn, conn.makefile('rb') as source:
+        yield from pa.ipc.open_stream(source)
+
+
+def pixel_matrix(data):
+    """(frames, 3694) uint16 pixels of a RecordBatch or Table; a view when in one chunk"""
+    column = data.column('pixels')
+    if isinstance(column, pa.ChunkedArray):
+        column = column.chunk(0) if column.num_chunks == 1 else column.combine_chunks()
+    return column.flatten().to_numpy(zero_copy_only=False).reshape(-1, CCD_PIXEL_COUNT)
+
+
+# --- commands --------------------------------------------------------------
+
+def schema_with(metadata):
+    return SCHEMA.with_metadata({f'tcd1304.{k}': str(v) for k, v in metadata.items()})
+
+
+def read_status(ser):
+    ser.reset_input_buffer()
+    ser.write(b'STATUS\n')
+    deadline = time.time() + 1.0
+    while time.time() < deadline:
+        line = ser.readline().decode('ascii', errors='ignore').strip()
+        if line.startswith('STATUS:'):
+            return line
+    return ''
+
+
+def export_live(args):
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.05)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    status = read_status(ser)
+
+    sinks = Sinks(schema_with({'source': port_name, 'status': status}), args.out, args.serve)
+    batcher = FrameBatcher(sinks, args.batch, args.flush_ms)
+    ser.reset_input_buffer()
+    ser.write(b'START\n')
+    print(f"📡 {port_name} → " + ', '.join(x for x in (args.out, args.serve and f'tcp {args.serve}') if x))
+
+    ingest = SerialIngest(ser)
+    window = min(POLL_S, batcher.flush_s)
+    deadline = time.monotonic() + args.seconds if args.seconds else None
+    try:
+        # Short ingest windows so a partial batch still goes out on time
+        # when frames stop (STOP on another port, unplugged sensor)
+        while deadline is None or time.monotonic() < deadline:
+            for frame in ingest.frames(window):
+                batcher.add(frame, time.time_ns())
+            batcher.poll()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        ser.write(b'STOP\n')
+        ser.close()
+        batcher.flush()
+        sinks.close()
+    print(f"📊 {batcher.frames} frames in {batcher.batches} batches, {batcher.rejected} malformed")
+
+
+def convert(args):
+    from stream_recorder import scan_marks
+
+    with open(args.convert, 'rb') as f:
+        data = f.read()
+    marks = scan_marks(data)
+    out = args.out or os.path.splitext(args.convert)[0] + '.arrow'
+
+    sinks = Sinks(schema_with({'source': os.path.basename(args.convert)}), out)
+    batcher = FrameBatcher(sinks, args.batch, flush_ms=float('inf'))
+    mark_index = -1
+    at = find_frame_start(data)
+    while at >= 0:
+        size = frame_size(data, at)
+        if size is None or at + size > len(data) or data[at + size - 6:at + size - 2] != FRAME_END_MARKER:
+            at = find_frame_start(data, at + 1)
+            continue
+        while mark_index + 1 < len(marks) and marks[mark_index + 1]['offset'] < at:
+            mark_index += 1
+        batcher.add(data[at:at + size], mark=marks[mark_index]['id'] if mark_index >= 0 else None)
+        at = find_frame_start(data, at + size)
+    batcher.flush()
+    sinks.close()
+    print(f"📦 {batcher.frames} frames, {len(marks)} marks → {out} "
+          f"({os.path.getsize(out) / 1e6:.1f} MB, {batcher.rejected} malformed)")
+
+
+def info(path):
+    table = open_recording(path)
+    print(f"{path}: {table.num_rows} frames, {table['pixels'].num_chunks} batches")
+    for key, value in (table.schema.metadata or {}).items():
+        print(f"   {key.decode()}: {value.decode()}")
+    if table.num_rows:
+        pixels = pixel_matrix(table)
+        seq = table['seq'].to_numpy()
+        gaps = int(((np.diff(seq.astype(np.int64)) - 1) % 0x10000).sum())
+        print(f"   seq {seq[0]}..{seq[-1]} ({gaps} missing), bits "
+              f"{sorted(set(table['bits'].to_pylist()))}, CRC errors "
+              f"{table.num_rows - int(table['crc_ok'].to_numpy().sum())}, mean pixel {pixels.mean():.1f}")
+
+
+def attach_print(address):
+    for batch in attach(address):
+        pixels = pixel_matrix(batch)
+        seq = batch.column('seq').to_numpy()
+        print(f"{batch.num_rows:>4} frames  seq {seq[0]:>5}..{seq[-1]:<5}  mean {pixels.mean():7.1f}  "
+              f"max {pixels.max():>4}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 frames as Arrow record batches')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--out', help='Arrow IPC file to write')
+    parser.add_argument('--serve', metavar='HOST:PORT', help='Serve an Arrow IPC stream over TCP')
+    parser.add_argument('--seconds', type=float, default=10.0, help='Streaming time (0 = until Ctrl-C)')
+    parser.add_argument('--batch', type=int, default=BATCH_FRAMES, help='Frames per record batch')
+    parser.add_argument('--flush-ms', type=float, default=FLUSH_MS,
+                        help='Write a partial batch after this long')
+    parser.add_argument('--convert', metavar='FILE', help='Convert a stream_recorder.py recording')
+    parser.add_argument('--attach', metavar='HOST:PORT', help='Print the batches of a --serve stream')
+    parser.add_argument('--info', metavar='FILE', help='Summarize an Arrow file')
+    args = parser.parse_args()
+
+    if args.info:
+        info(args.info)
+    elif args.attach:
+        attach_print(args.attach)
+    elif args.convert:
+        convert(args)
+    elif args.out or args.serve:
+        export_live(args)
+    else:
+        parser.error('--out and/or --serve (or --convert / --attach / --info) required')
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,481 @@
+#!/usr/bin/env python3
+"""
+TCD1304 Live Dashboard
+A local web page instead of a matplotlib window: any number of browsers can
+watch the sensor, each at its own rate, without slowing acquisition.
+
+    python tcd1304_dashboard.py [port] [--listen 127.0.0.1:8304]
+    open http://127.0.0.1:8304/
+
+  - The acquisition thread (SerialIngest) only keeps the newest frame and a
+    few counters; it never waits for a viewer.
+  - Each viewer negotiates a rate (1..30 Hz) and a width in bins over its
+    WebSocket. At that rate it gets the newest frame, envelope-decimated to
+    min/max per bin, as one binary message (drawn on a canvas).
+  - A decimated frame is computed once per (frame, bins) and shared by all
+    viewers asking for the same width. A viewer that cannot keep up skips
+    frames instead of queueing them.
+  - Listens on 127.0.0.1 unless --listen says otherwise. Read-only: no
+    commands reach the device from the page. WebSocket upgrades from a
+    browser must come from the page itself (Origin equal to Host); on a
+    loopback listen address the Host must be loopback too, so other sites
+    cannot read the stream, not even through DNS rebinding.
+
+Binary frame message, little-endian:
+    u8  type (1)          u8  flags (1 = settling)   u16 seq
+    u16 bins              u8  bits                   u8  reserved
+    f32 fps               f32 link MB/s
+    u32 frames            u32 seq gaps               u32 CRC errors
+    u16 min[bins]         u16 max[bins]              (12-bit scale, as read)
+Text messages: the viewer sends {"rate": hz, "bins": n}; the server replies
+{"type": "config", ...} with the values in use and the device STATUS line.
+
+WebSocket (RFC 6455) is implemented here on asyncio; no extra packages.
+"""
+
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import struct
+import sys
+import threading
+import time
+import urllib.parse
+
+import numpy as np
+import serial
+
+from tcd1304_protocol import find_stm32_port, parse_frame_info, crc16, CCD_PIXEL_COUNT
+from tcd1304_ingest import SerialIngest
+
+MIN_RATE = 1
+MAX_RATE = 30
+MIN_BINS = 64
+DEFAULT_RATE = 10
+DEFAULT_BINS = 1024
+SEND_BUFFER_LIMIT = 256 * 1024      # Skip frames for a viewer with this much unsent
+
+MSG_FRAME = 1
+FRAME_MSG_HEADER = struct.Struct('<BBHHBBffIII')
+
+WS_GUID = b'258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+LOOPBACK_HOSTS = ('127.0.0.1', 'localhost', '::1')
+
+
+# --- acquisition -------------------------------------------------------------
+
+class Acquisition:
+    """Reader thread: newest frame plus counters, nothing per viewer"""
+
+    def __init__(self, ser):
+        self.ser = ser
+        self.lock = threading.Lock()
+        self.latest = None              # (frame id, frame bytes)
+        self.frame_id = 0
+        self.frames = 0
+        self.seq_gaps = 0
+        self.crc_errors = 0
+        self.fps = 0.0
+        self.mbps = 0.0
+        self.running = True
+        self.ingest = SerialIngest(ser)
+        self.thread = threading.Thread(target=self._run, daemon=True)
+
+    def start(self):
+        self.thread.start()
+
+    def stop(self):
+        self.running = False
+        self.thread.join(timeout=2.0)
+
+    def _run(self):
+        last_seq = None
+        window_start = time.monotonic()
+        window_frames = window_bytes = 0
+        while self.running:
+            for frame in self.ingest.frames(0.5):
+                seq, = struct.unpack_from('<H', frame, 4)
+                bad = crc16(frame[:-2]) != struct.unpack_from('<H', frame, len(frame) - 2)[0]
+                gap = (seq - last_seq - 1) & 0xFFFF if last_seq is not None else 0
+                last_seq = seq
+                window_frames += 1
+                window_bytes += len(frame)
+                with self.lock:
+                    self.frame_id += 1
+                    self.latest = (self.frame_id, bytes(frame))   # The view is reused
+                    self.frames += 1
+                    self.seq_gaps += gap
+                    self.crc_errors += bad
+                now = time.monotonic()
+                if now - window_start >= 1.0:
+                    with self.lock:
+                        self.fps = window_frames / (now - window_start)
+                        self.mbps = window_bytes / (now - window_start) / 1e6
+                    window_start, window_frames, window_bytes = now, 0, 0
+                if not self.running:
+                    return
+
+    def snapshot(self):
+        with self.lock:
+            return (self.latest, self.frames, self.seq_gaps, self.crc_errors, self.fps, self.mbps)
+
+
+# --- decimation --------------------------------------------------------------
+
+def envelope(pixels, bins):
+    """Min and max of bins near-equal slices of the pixels (bins <= pixel count)"""
+    starts = np.arange(bins) * len(pixels) // bins
+    return np.minimum.reduceat(pixels, starts), np.maximum.reduceat(pixels, starts)
+
+
+class FrameCache:
+    """Decimated messages of the newest frame, one per bin count"""
+
+    def __init__(self, acquisition):
+        self.acquisition = acquisition
+        self.frame_id = None
+        self.info = None
+        self.messages = {}
+
+    def message(self, bins):
+        """(frame id, binary message) for the newest frame, or (None, None)"""
+        latest, frames, gaps, crc_errors, fps, mbps = self.acquisition.snapshot()
+        if latest is None:
+            return None, None
+        frame_id, frame = latest
+        if frame_id != self.frame_id:
+            self.frame_id = frame_id
+            self.info = parse_frame_info(frame)
+            self.messages = {}
+        if self.info is None:
+            return frame_id, None
+        if bins not in self.messages:
+            low, high = envelope(np.asarray(self.info['pixels'], dtype=np.uint16), bins)
+            header = FRAME_MSG_HEADER.pack(MSG_FRAME, 1 if self.info['settling'] else 0,
+                                           self.info['seq'], bins, self.info['bits'], 0,
+                                           fps, mbps, frames, gaps, crc_errors)
+            self.messages[bins] = header + low.astype('<u2').tobytes() + high.astype('<u2').tobytes()
+        return frame_id, self.messages[bins]
+
+
+# --- WebSocket ---------------------------------------------------------------
+
+class WebSocket:
+    """Server side of one RFC 6455 connection (no extensions, no fragmentation on send)"""
+
+    def __init__(self, reader, writer):
+        self.reader = reader
+        self.writer = writer
+        self.closed = False
+
+    async def send(self, payload, binary=True):
+        header = bytearray([0x80 | (0x2 if binary else 0x1)])
+        n = len(payload)
+        if n < 126:
+            header.append(n)
+        elif n < 0x10000:
+            header += bytes([126]) + struct.pack('>H', n)
+        else:
+            header += bytes([127]) + struct.pack('>Q', n)
+        self.writer.write(bytes(header) + payload)
+        await self.writer.drain()
+
+    def backlog(self):
+        return self.writer.transport.get_write_buffer_size()
+
+    async def receive(self):
+        """Next text message as str, or None when the connection closes"""
+        message = b''
+        while True:
+            b0, b1 = await self.reader.readexactly(2)
+            opcode = b0 & 0x0F
+            n = b1 & 0x7F
+            if n == 126:
+                n, = struct.unpack('>H', await self.reader.readexactly(2))
+            elif n == 127:
+                n, = struct.unpack('>Q', await self.reader.readexactly(8))
+            if n > 65536:
+                return None
+            mask = await self.reader.readexactly(4) if b1 & 0x80 else b'\0\0\0\0'
+            data = bytes(b ^ mask[i % 4] for i, b in enumerate(await self.reader.readexactly(n)))
+
+            if opcode == 0x8:                                   # Close: echo the status code
+                self.closed = True
+                self.writer.write(bytes([0x88, min(len(data), 2)]) + data[:2])
+                await self.writer.drain()
+                return None
+            if opcode == 0x9:                                   # Ping
+                self.writer.write(bytes([0x8A, len(data)]) + data)
+                continue
+            if opcode in (0x0, 0x1, 0x2):
+                message += data
+                if b0 & 0x80:
+                    return message.decode('utf-8', errors='replace')
+
+
+async def read_http_request(reader):
+    head = await reader.readuntil(b'\r\n\r\n')
+    lines = head.decode('latin-1').split('\r\n')
+    method, path, _ = (lines[0].split(' ') + ['', '', ''])[:3]
+    headers = {}
+    for line in lines[1:]:
+        if ':' in line:
+            key, value = line.split(':', 1)
+            headers[key.strip().lower()] = value.strip()
+    return method, path, headers
+
+
+def origin_allowed(headers, listen_host):
+    """WebSocket upgrade from the page itself, or from a non-browser client"""
+    host = headers.get('host', '').lower()
+    if listen_host in LOOPBACK_HOSTS and urllib.parse.urlsplit('//' + host).hostname not in LOOPBACK_HOSTS:
+        return False                                            # DNS rebinding
+    origin = headers.get('origin')
+    if origin is None:
+        return True                                             # Browsers always send one
+    return urllib.parse.urlsplit(origin.lower()).netloc == host
+
+
+# --- server ------------------------------------------------------------------
+
+class Dashboard:
+    def __init__(self, acquisition, status, listen_host='127.0.0.1'):
+        self.acquisition = acquisition
+        self.cache = FrameCache(acquisition)
+        self.status = status
+        self.listen_host = listen_host
+        self.viewers = 0
+
+    async def handle(self, reader, writer):
+        try:
+            method, path, headers = await read_http_request(reader)
+            if path == '/ws' and headers.get('upgrade', '').lower() == 'websocket':
+                if origin_allowed(headers, self.listen_host):
+                    await self.websocket(reader, writer, headers)
+                else:
+                    writer.write(b'HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n')
+            elif method == 'GET' and path in ('/', '/index.html'):
+                body = PAGE.encode('utf-8')
+                writer.write(b'HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=utf-8\r\n'
+                             b'Cache-Control: no-store\r\nContent-Length: %d\r\n'
+                             b'Connection: close\r\n\r\n' % len(body) + body)
+            else:
+                writer.write(b'HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n')
+            await writer.drain()
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError, ConnectionError):
+            pass
+        finally:
+            writer.close()
+
+    async def websocket(self, reader, writer, headers):
+        key = headers.get('sec-websocket-key', '').encode('ascii')
+        accept = base64.b64encode(hashlib.sha1(key + WS_GUID).digest())
+        writer.write(b'HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n'
+                     b'Connection: Upgrade\r\nSec-WebSocket-Accept: ' + accept + b'\r\n\r\n')
+        await writer.drain()
+
+        ws = WebSocket(reader, writer)
+        config = {'rate': DEFAULT_RATE, 'bins': DEFAULT_BINS}
+        self.viewers += 1
+        print(f"👀 viewer connected ({self.viewers})")
+        pusher = asyncio.ensure_future(self.push(ws, config))
+        try:
+            await self.send_config(ws, config)
+            while True:
+                text = await ws.receive()
+                if text is None:
+                    break
+                try:
+                    request = json.loads(text)
+                except ValueError:
+                    continue
+                config['rate'] = min(MAX_RATE, max(MIN_RATE, float(request.get('rate', config['rate']))))
+                config['bins'] = min(CCD_PIXEL_COUNT, max(MIN_BINS, int(request.get('bins', config['bins']))))
+                await self.send_config(ws, config)
+        except (asyncio.IncompleteReadError, ConnectionError, ValueError):
+            pass
+        finally:
+            pusher.cancel()
+            self.viewers -= 1
+            print(f"👋 viewer left ({self.viewers})")
+
+    async def send_config(self, ws, config):
+        await ws.send(json.dumps({'type': 'config', 'rate': config['rate'], 'bins': config['bins'],
+                                  'max_rate': MAX_RATE, 'pixels': CCD_PIXEL_COUNT,
+                                  'status': self.status}).encode('utf-8'), binary=False)
+
+    async def push(self, ws, config):
+        sent_id = None
+        try:
+            while not ws.closed:
+                await asyncio.sleep(1.0 / config['rate'])
+                if ws.backlog() > SEND_BUFFER_LIMIT:
+                    continue                                    # Slow viewer: skip
+                frame_id, message = self.cache.message(config['bins'])
+                if message is None or frame_id == sent_id:
+                    continue
+                sent_id = frame_id
+                await ws.send(message)
+        except (ConnectionError, asyncio.CancelledError):
+            pass
+
+
+def read_status(ser):
+    ser.reset_input_buffer()
+    ser.write(b'STATUS\n')
+    deadline = time.time() + 1.0
+    while time.time() < deadline:
+        line = ser.readline().decode('ascii', errors='ignore').strip()
+        if line.startswith('STATUS:'):
+            return line
+    return ''
+
+
+async def serve(dashboard, host, port):
+    server = await asyncio.start_server(dashboard.handle, host, port)
+    print(f"🌐 http://{host}:{port}/")
+    async with server:
+        await server.serve_forever()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 live web dashboard')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--listen', default='127.0.0.1:8304', help='HOST:PORT to serve on')
+    parser.add_argument('--no-start', action='store_true', help='Do not send START (already streaming)')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+    host, port = args.listen.rsplit(':', 1)
+    if host not in LOOPBACK_HOSTS:
+        print(f"⚠️  Listening on {host}: the dashboard has no authentication")
+
+    ser = serial.Serial(port_name, 115200, timeout=0.05)
+    time.sleep(0.3)
+    status = ''
+    if not args.no_start:
+        ser.write(b'STOP\n')
+        time.sleep(0.2)
+        status = read_status(ser)
+        ser.reset_input_buffer()
+        ser.write(b'START\n')
+
+    acquisition = Acquisition(ser)
+    acquisition.start()
+    try:
+        asyncio.run(serve(Dashboard(acquisition, status, host), host, int(port)))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        acquisition.stop()
+        if not args.no_start:
+            ser.write(b'STOP\n')
+        ser.close()
+
+
+PAGE = r"""<!DOCTYPE html>
+<html><head><meta charset="utf-8"><title>TCD1304</title>
+<style>
+  body { margin: 0; font: 13px monospace; background: #111; color: #ccc; }
+  #bar { padding: 6px 10px; display: flex; gap: 16px; align-items: center; flex-wrap: wrap; }
+  #bar b { color: #fff; }
+  canvas { display: block; width: 100vw; height: calc(100vh - 40px); }
+  select, input { background: #222; color: #ccc; border: 1px solid #444; }
+</style></head>
+<body>
+<div id="bar">
+  <b>TCD1304</b>
+  <label>rate <select id="rate"><option>2</option><option>5</option><option selected>10</option>
+    <option>20</option><option>30</option></select> Hz</label>
+  <label>bins <select id="bins"><option>256</option><option>512</option><option selected>1024</option>
+    <option>2048</option><option>3694</option></select></label>
+  <label><input type="checkbox" id="invert" checked> invert</label>
+  <span id="stats">connecting…</span>
+  <span id="status"></span>
+</div>
+<canvas id="plot"></canvas>
+<script>
+const ADC_MAX = 4095;
+const canvas = document.getElementById('plot');
+const ctx = canvas.getContext('2d');
+const stats = document.getElementById('stats');
+let ws, last = null;
+
+function connect() {
+  ws = new WebSocket(`ws://${location.host}/ws`);
+  ws.binaryType = 'arraybuffer';
+  ws.onopen = sendConfig;
+  ws.onclose = () => { stats.textContent = 'disconnected, retrying…'; setTimeout(connect, 1000); };
+  ws.onmessage = (event) => {
+    if (typeof event.data === 'string') {
+      const msg = JSON.parse(event.data);
+      if (msg.type === 'config') document.getElementById('status').textContent = msg.status || '';
+      return;
+    }
+    last = parse(event.data);
+    requestAnimationFrame(draw);
+  };
+}
+
+function sendConfig() {
+  if (ws && ws.readyState === 1) {
+    ws.send(JSON.stringify({ rate: +document.getElementById('rate').value,
+                             bins: +document.getElementById('bins').value }));
+  }
+}
+
+function parse(buffer) {
+  const v = new DataView(buffer);
+  const bins = v.getUint16(4, true);
+  const off = 28;
+  return {
+    settling: v.getUint8(1) & 1, seq: v.getUint16(2, true), bins, bits: v.getUint8(6),
+    fps: v.getFloat32(8, true), mbps: v.getFloat32(12, true), frames: v.getUint32(16, true),
+    gaps: v.getUint32(20, true), crc: v.getUint32(24, true),
+    min: new Uint16Array(buffer.slice(off, off + 2 * bins)),
+    max: new Uint16Array(buffer.slice(off + 2 * bins, off + 4 * bins)),
+  };
+}
+
+function draw() {
+  if (!last) return;
+  const f = last;
+  const w = canvas.width = canvas.clientWidth * devicePixelRatio;
+  const h = canvas.height = canvas.clientHeight * devicePixelRatio;
+  const invert = document.getElementById('invert').checked;
+  const y = (value) => { const s = invert ? ADC_MAX - value : value; return h - 4 - (s / ADC_MAX) * (h - 8); };
+  ctx.fillStyle = '#111'; ctx.fillRect(0, 0, w, h);
+  ctx.strokeStyle = '#333'; ctx.beginPath();
+  for (let g = 0; g <= 4; g++) { const gy = 4 + g * (h - 8) / 4; ctx.moveTo(0, gy); ctx.lineTo(w, gy); }
+  ctx.stroke();
+  // Envelope: one vertical span per bin
+  ctx.strokeStyle = f.settling ? '#c84' : '#4c8';
+  ctx.lineWidth = Math.max(1, w / f.bins);
+  ctx.beginPath();
+  for (let i = 0; i < f.bins; i++) {
+    const x = (i + 0.5) * w / f.bins;
+    const a = y(f.min[i]), b = y(f.max[i]);
+    ctx.moveTo(x, a); ctx.lineTo(x, b === a ? a - 1 : b);
+  }
+  ctx.stroke();
+  stats.textContent = `seq ${f.seq}  ${f.bits}-bit  ${f.fps.toFixed(1)} fps  ${f.mbps.toFixed(2)} MB/s  ` +
+                      `frames ${f.frames}  gaps ${f.gaps}  crc ${f.crc}` + (f.settling ? '  SETTLING' : '');
+}
+
+document.getElementById('rate').onchange = sendConfig;
+document.getElementById('bins').onchange = sendConfig;
+document.getElementById('invert').onchange = () => requestAnimationFrame(draw);
+window.onresize = () => requestAnimationFrame(draw);
+connect();
+</script>
+</body></html>
+"""
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""
+TCD1304 Serial Ingest
+Low-overhead frame reader for Linux hosts. The usual loop,
+ser.read(max(1, ser.in_waiting)) with timeout=0.1, costs a select, an
+ioctl and a read per chunk, allocates a new bytes object each time and
+copies it into the parse buffer again.
+
+SerialIngest instead
+  - puts the tty in raw mode with VMIN=0 / VTIME=1: a read returns as soon
+    as any data is there, or after 100 ms with nothing (no busy loop),
+  - sets ASYNC_LOW_LATENCY where the driver supports it (USB serial
+    adapters; cdc-acm pushes data at once anyway),
+  - reads with one readv() straight into a preallocated buffer, asking
+    for the rest of the current frame,
+  - optionally paces reads (--mode paced): with part of a frame in, it
+    sleeps for the time the rest needs at the measured link rate, so most
+    frames arrive in one or two reads,
+and counts read syscalls per frame plus the ingest timing of every frame:
+span (first to last read of the frame) and lag (frame complete at the tty
+to delivered; bytes read past the frame end count as time it waited in the
+kernel, at the measured link rate).
+
+Only FRME/FRMX frames are delivered; other packets are skipped. A frame is
+a memoryview into the read buffer, valid until the next iteration: parse
+it in the loop, or copy it (bytes(frame)) to keep it. On non-Linux hosts
+the pyserial loop is used and counted the same way.
+
+Usage:
+    python tcd1304_ingest.py [port] --seconds 10 --mode raw
+    python tcd1304_ingest.py [port] --seconds 10 --mode paced
+    python tcd1304_ingest.py [port] --seconds 10 --mode pyserial   # baseline
+"""
+
+import argparse
+import fcntl
+import os
+import statistics
+import struct
+import sys
+import time
+
+import serial
+
+from tcd1304_protocol import (find_stm32_port, FRAME_START_MARKER, FRAMEX_START_MARKER,
+                              FRAME_END_MARKER, FRAME_TOTAL_SIZE, FRAMEX_HEADER_SIZE, FRAME_FOOTER_SIZE)
+
+try:
+    import termios
+except ImportError:
+    termios = None
+
+# Linux serial ioctls (asm-generic/ioctls.h) and serial_struct.flags
+TIOCGSERIAL = 0x541E
+TIOCSSERIAL = 0x541F
+SERIAL_FLAGS_OFFSET = 16
+ASYNC_LOW_LATENCY = 1 << 13
+
+RING_FRAMES = 4
+
+
+def configure_low_latency(fd):
+    """Raw tty, VMIN=0/VTIME=1, blocking reads, ASYNC_LOW_LATENCY if possible"""
+    applied = []
+    attrs = termios.tcgetattr(fd)
+    iflag, oflag, cflag, lflag, ispeed, ospeed, cc = attrs
+    # cfmakeraw()
+    iflag &= ~(termios.IGNBRK | termios.BRKINT | termios.PARMRK | termios.ISTRIP |
+               termios.INLCR | termios.IGNCR | termios.ICRNL | termios.IXON)
+    oflag &= ~termios.OPOST
+    lflag &= ~(termios.ECHO | termios.ECHONL | termios.ICANON | termios.ISIG | termios.IEXTEN)
+    cflag = (cflag & ~(termios.CSIZE | termios.PARENB)) | termios.CS8
+    cc[termios.VMIN] = 0
+    cc[termios.VTIME] = 1
+    termios.tcsetattr(fd, termios.TCSANOW, [iflag, oflag, cflag, lflag, ispeed, ospeed, cc])
+    applied.append('raw VMIN=0 VTIME=1')
+
+    # pyserial opens non-blocking, which would turn VTIME off
+    fcntl.fcntl(fd, fcntl.F_SETFL, fcntl.fcntl(fd, fcntl.F_GETFL) & ~os.O_NONBLOCK)
+    applied.append('blocking')
+
+    try:
+        info = bytearray(128)
+        fcntl.ioctl(fd, TIOCGSERIAL, info)
+        flags, = struct.unpack_from('i', info, SERIAL_FLAGS_OFFSET)
+        struct.pack_into('i', info, SERIAL_FLAGS_OFFSET, flags | ASYNC_LOW_LATENCY)
+        fcntl.ioctl(fd, TIOCSSERIAL, info)
+        applied.append('ASYNC_LOW_LATENCY')
+    except OSError:
+        pass
+    return applied
+
+
+class SerialIngest:
+    """Frame reader over an open pyserial port (see module docstring)"""
+
+    def __init__(self, ser, paced=False, use_pyserial=False):
+        self.ser = ser
+        self.paced = paced
+        self.native = (not use_pyserial and termios is not None and sys.platform.startswith('linux'))
+        self.applied = configure_low_latency(ser.fileno()) if self.native else ['pyserial']
+
+        self.buf = bytearray(RING_FRAMES * FRAME_TOTAL_SIZE)
+        self.view = memoryview(self.buf)
+        self.start = 0
+        self.end = 0
+
+        self.reads = 0
+        self.bytes = 0
+        self.frame_count = 0
+        self.spans = []
+        self.lags = []
+        self.rate = 0.0                 # Link bytes/s, EWMA over full frames
+        self.first_read = None          # Time of the read that brought the current frame's start
+        self.last_read = None
+
+    # --- reading -----------------------------------------------------------
+
+    def _compact(self, room):
+        if len(self.buf) - self.end >= room:
+            return
+        held = self.end - self.start
+        self.buf[:held] = self.view[self.start:self.end]
+        self.start, self.end = 0, held
+
+    def _read(self, want):
+        """One read of up to want bytes into the buffer; returns the byte count"""
+        want = max(64, min(want, len(self.buf) // 2))
+        self._compact(want)
+        if self.native:
+            n = os.readv(self.ser.fileno(), [self.view[self.end:self.end + want]])
+        else:
+            chunk = self.ser.read(max(1, min(self.ser.in_waiting, want)))
+            n = len(chunk)
+            self.buf[self.end:self.end + n] = chunk
+        self.reads += 1
+        self.bytes += n
+        self.end += n
+        return n
+
+    # --- framing -----------------------------------------------------------
+
+    def _find_frame(self):
+        hits = [i for i in (self.buf.find(FRAME_START_MARKER, self.start, self.end),
+                            self.buf.find(FRAMEX_START_MARKER, self.start, self.end)) if i >= 0]
+        return min(hits) if hits else -1
+
+    def _frame_size(self, at):
+        """Size of the frame at buf[at], or None until its header is in"""
+        if self.buf[at:at + 4] == FRAME_START_MARKER:
+            return FRAME_TOTAL_SIZE
+        if self.end - at < FRAMEX_HEADER_SIZE:
+            return None
+        payload_size, = struct.unpack_from('<H', self.buf, at + 10)
+        return FRAMEX_HEADER_SIZE + payload_size + FRAME_FOOTER_SIZE
+
+    def frames(self, seconds=None):
+        """Yield complete frames as memoryviews, valid until the next iteration"""
+        deadline = None if seconds is None else time.perf_counter() + seconds
+        while deadline is None or time.perf_counter() < deadline:
+            at = self._find_frame()
+            if at < 0:
+                # Keep a possible partial marker
+                self.start = max(self.start, self.end - 3)
+                need = FRAME_TOTAL_SIZE
+            else:
+                self.start = at
+                size = self._frame_size(at)
+                if size is not None and size > FRAME_TOTAL_SIZE:
+                    # Marker bytes inside other data
+                    self.start = at + 1
+                    continue
+                need = (size if size is not None else FRAMEX_HEADER_SIZE) - (self.end - at)
+                if size is not None and need <= 0:
+                    if self.buf[at + size - 6:at + size - 2] != FRAME_END_MARKER:
+                        self.start = at + 1
+                        continue
+                    frame = self.view[at:at + size]
+                    self.start = at + size
+                    self._account(size, self.end - self.start)
+                    yield frame
+                    continue
+
+            if self.paced and self.first_read is not None and self.rate > 0 and need > 512:
+                time.sleep(need / self.rate)
+
+            if self._read(need) and self.first_read is None and self._find_frame() >= 0:
+                self.first_read = time.perf_counter()
+            self.last_read = time.perf_counter()
+
+    def _account(self, size, excess):
+        """Frame timing; excess bytes read past the frame mean it was complete earlier"""
+        self.frame_count += 1
+        if self.first_read is not None:
+            span = self.last_read - self.first_read
+            self.spans.append(span)
+            if span > 0:
+                rate = size / span
+                self.rate = rate if self.rate == 0 else 0.8 * self.rate + 0.2 * rate
+        waited = excess / self.rate if self.rate > 0 else 0.0
+        self.lags.append(time.perf_counter() - self.last_read + waited)
+        # The next frame's start may already be in the buffer
+        self.first_read = self.last_read if self._find_frame() >= 0 else None
+
+    # --- report ------------------------------------------------------------
+
+    def stats(self):
+        def pct(values, q):
+            values = sorted(values)
+            return values[min(len(values) - 1, int(round(q * (len(values) - 1))))] if values else 0.0
+        return {
+            'frames': self.frame_count,
+            'reads': self.reads,
+            'reads_per_frame': self.reads / self.frame_count if self.frame_count else 0.0,
+            'bytes_per_read': self.bytes / self.reads if self.reads else 0.0,
+            'span_ms_median': statistics.median(self.spans) * 1e3 if self.spans else 0.0,
+            'span_ms_p95': pct(self.spans, 0.95) * 1e3,
+            'lag_us_median': statistics.median(self.lags) * 1e6 if self.lags else 0.0,
+            'lag_us_p95': pct(self.lags, 0.95) * 1e6,
+            'tty': ', '.join(self.applied),
+        }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 serial ingest benchmark')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--seconds', type=float, default=10.0, help='Streaming time')
+    parser.add_argument('--mode', choices=('raw', 'paced', 'pyserial'), default='raw',
+                        help='raw: read on arrival, paced: frame-sized batches, pyserial: baseline')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    ser = serial.Serial(port_name, 115200, timeout=0.1)
+    time.sleep(0.3)
+    ser.write(b'STOP\n')
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+
+    ingest = SerialIngest(ser, paced=(args.mode == 'paced'), use_pyserial=(args.mode == 'pyserial'))
+    ser.write(b'START\n')
+    try:
+        for _ in ingest.frames(args.seconds):
+            pass
+    finally:
+        ser.write(b'STOP\n')
+        ser.close()
+
+    s = ingest.stats()
+    print(f"📊 {args.mode}: {s['frames']} frames, {s['reads']} reads "
+          f"({s['reads_per_frame']:.2f} per frame, {s['bytes_per_read']:.0f} B per read)")
+    print(f"   frame span  median {s['span_ms_median']:.2f} ms  p95 {s['span_ms_p95']:.2f} ms")
+    print(f"   ingest lag  median {s['lag_us_median']:.1f} us  p95 {s['lag_us_p95']:.1f} us")
+    print(f"   tty: {s['tty']}")
+
+
+if __name__ == "__main__":
+    main()
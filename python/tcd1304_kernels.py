@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+TCD1304 Host Pixel Kernels
+Frame bytes to float32 pixels in one pass: unpack (raw16 FRME pixels or
+packed12), invert (ADC_MAX_VALUE - pixel, see the README), subtract a dark
+frame and convert, with AVX2 / SSE4.1 / scalar paths in
+native/tcd1304_kernels.c. The C file is built with the system compiler on
+first use (cached next to it, rebuilt when the source changes) and loaded
+with ctypes; without a compiler the numpy chain is used.
+
+    kernels = PixelKernels(dark=dark_frame)          # dark optional
+    values = kernels.frame_to_float(frame_bytes[8:8 + 2 * 3694])
+    values = kernels.frame_to_float(payload, packed12=True)
+
+Run as a script to check all paths against the numpy chain and time them.
+
+Usage:
+    python tcd1304_kernels.py [--runs 2000]
+"""
+
+import argparse
+import ctypes
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import time
+
+import numpy as np
+
+from tcd1304_protocol import CCD_PIXEL_COUNT, packed12_size
+
+ADC_MAX_VALUE = 4095
+
+LEVELS = {0: 'scalar', 1: 'sse4.1', 2: 'avx2'}
+
+NATIVE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'native')
+SOURCE = os.path.join(NATIVE_DIR, 'tcd1304_kernels.c')
+LIBRARY = os.path.join(NATIVE_DIR, 'libtcd1304_kernels.so')
+
+_lib = None
+
+
+def _load():
+    """Build (if stale) and load the native kernels; None if not possible"""
+    global _lib
+    if _lib is not None:
+        return _lib or None
+
+    compiler = shutil.which(os.environ.get('CC', 'cc')) or shutil.which('gcc')
+    stale = (not os.path.exists(LIBRARY) or
+             os.path.getmtime(LIBRARY) < os.path.getmtime(SOURCE))
+    try:
+        if stale:
+            if compiler is None:
+                raise OSError('no C compiler')
+            subprocess.run([compiler, '-O2', '-ffp-contract=off', '-shared', '-fPIC',
+                            '-o', LIBRARY, SOURCE], check=True, capture_output=True)
+        lib = ctypes.CDLL(LIBRARY)
+    except (OSError, subprocess.CalledProcessError) as error:
+        print(f"⚠️  Native kernels unavailable ({error}); using numpy", file=sys.stderr)
+        _lib = False
+        return None
+
+    args = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_float, ctypes.c_float, ctypes.c_void_p,
+            ctypes.c_uint32, ctypes.c_int]
+    lib.tk_raw16_to_f32.argtypes = args
+    lib.tk_raw16_to_f32.restype = None
+    lib.tk_packed12_to_f32.argtypes = args
+    lib.tk_packed12_to_f32.restype = None
+    lib.tk_simd_level.restype = ctypes.c_int
+    _lib = lib
+    return lib
+
+
+def numpy_chain(data, dark=None, invert=True, packed12=False, count=CCD_PIXEL_COUNT):
+    """The separate passes the host tools use: unpack, invert, dark, float"""
+    if packed12:
+        b = np.frombuffer(data, dtype=np.uint8, count=packed12_size(count)).reshape(-1, 3)
+        b = b.astype(np.uint16)
+        pixels = np.empty(len(b) * 2, dtype=np.uint16)
+        pixels[0::2] = b[:, 0] | ((b[:, 1] & 0x0F) << 8)
+        pixels[1::2] = (b[:, 1] >> 4) | (b[:, 2] << 4)
+        pixels = pixels[:count]
+    else:
+        pixels = np.array(struct.unpack_from(f'<{count}H', data), dtype=np.uint16)
+    values = pixels.astype(np.int32)
+    if invert:
+        values = ADC_MAX_VALUE - values
+    values = values.astype(np.float32)
+    if dark is not None:
+        values = values - dark
+    return values
+
+
+class PixelKernels:
+    """Fused frame-to-float conversion with a fixed dark frame and polarity"""
+
+    def __init__(self, dark=None, invert=True, count=CCD_PIXEL_COUNT, level=None):
+        self.count = count
+        self.dark = None if dark is None else np.ascontiguousarray(dark, dtype=np.float32)
+        self.invert = invert
+        self.lib = _load()
+        best = self.lib.tk_simd_level() if self.lib else None
+        self.level = best if level is None or best is None else min(level, best)
+
+        # out = (base + sign * pixel) - dark
+        self.dark_or_zero = self.dark if self.dark is not None else np.zeros(count, dtype=np.float32)
+        self.base, self.sign = (float(ADC_MAX_VALUE), -1.0) if invert else (0.0, 1.0)
+        self.out = np.empty(count, dtype=np.float32)
+
+    @property
+    def name(self):
+        return LEVELS[self.level] if self.lib else 'numpy'
+
+    def frame_to_float(self, data, packed12=False, out=None):
+        """Pixels from raw16 or packed12 bytes as float32 (reuses one buffer if out is None)"""
+        if not self.lib:
+            return numpy_chain(data, self.dark, self.invert, packed12, self.count)
+
+        need = packed12_size(self.count) if packed12 else 2 * self.count
+        if len(data) < need:
+            raise ValueError(f'{need} bytes of pixel data expected, got {len(data)}')
+        src = np.frombuffer(data, dtype=np.uint8, count=need)
+        out = self.out if out is None else out
+        kernel = self.lib.tk_packed12_to_f32 if packed12 else self.lib.tk_raw16_to_f32
+        kernel(src.ctypes.data, self.dark_or_zero.ctypes.data, self.base, self.sign,
+               out.ctypes.data, self.count, self.level)
+        return out
+
+
+def _time(fn, runs):
+    fn()
+    start = time.perf_counter()
+    for _ in range(runs):
+        fn()
+    return (time.perf_counter() - start) / runs * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Fused host pixel kernels vs the numpy chain')
+    parser.add_argument('--runs', type=int, default=2000, help='Calls per measurement')
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(1304)
+    pixels = rng.integers(0, ADC_MAX_VALUE + 1, CCD_PIXEL_COUNT, dtype=np.uint16)
+    dark = rng.normal(200.0, 5.0, CCD_PIXEL_COUNT).astype(np.float32)
+    raw16 = pixels.astype('<u2').tobytes()
+    p = np.append(pixels, 0) if len(pixels) % 2 else pixels
+    packed = np.empty((len(p) // 2, 3), dtype=np.uint8)
+    packed[:, 0] = p[0::2] & 0xFF
+    packed[:, 1] = (p[0::2] >> 8) | ((p[1::2] & 0x0F) << 4)
+    packed[:, 2] = p[1::2] >> 4
+    packed12 = packed.tobytes()
+
+    best = PixelKernels().level if _load() else None
+    levels = [lvl for lvl in LEVELS if best is not None and lvl <= best]
+
+    print(f"{CCD_PIXEL_COUNT} pixels, invert + dark, {args.runs} runs, µs per frame")
+    print(f"{'source':<10} {'numpy':>9} " + ''.join(f"{LEVELS[lvl]:>9}" for lvl in levels) +
+          f" {'speedup':>8}")
+    for name, data, is_packed in (('raw16', raw16, False), ('packed12', packed12, True)):
+        reference = numpy_chain(data, dark, True, is_packed)
+        base = _time(lambda: numpy_chain(data, dark, True, is_packed), args.runs)
+        row = f"{name:<10} {base:>9.1f} "
+        fastest = base
+        for lvl in levels:
+            kernels = PixelKernels(dark=dark, level=lvl)
+            result = kernels.frame_to_float(data, packed12=is_packed)
+            if not np.array_equal(result, reference):
+                raise SystemExit(f"❌ {name} {LEVELS[lvl]} differs from the numpy chain")
+            t = _time(lambda: kernels.frame_to_float(data, packed12=is_packed), args.runs)
+            fastest = min(fastest, t)
+            row += f"{t:>9.1f}"
+        print(row + f" {base / fastest:>7.1f}x")
+    if not levels:
+        print("   (native kernels unavailable: numpy only)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,314 @@
+#!/usr/bin/env python3
+"""
+TCD1304 Wire Protocol Helpers
+Constants and parsers shared by the host tools: port discovery, CRC16,
+12-bit unpacking, legacy FRME frames, reduced-resolution FRMX frames, PTRG
+pre-trigger packets, BAND telemetry packets and TRCE latency trace packets.
+"""
+
+import binascii
+import struct
+
+import serial.tools.list_ports
+
+# Frame structure constants (legacy FRME frame)
+CCD_PIXEL_COUNT = 3694
+FRAME_START_MARKER = b'FRME'
+FRAME_END_MARKER = b'ENDF'
+FRAME_HEADER_SIZE = 8
+FRAME_PIXEL_SIZE = CCD_PIXEL_COUNT * 2
+FRAME_FOOTER_SIZE = 6
+FRAME_TOTAL_SIZE = FRAME_HEADER_SIZE + FRAME_PIXEL_SIZE + FRAME_FOOTER_SIZE
+
+# Reduced-resolution frame ("FRMX" | seq | pixel_count | bits u8 | flags u8 |
+# payload_size u16 | 8-bit or packed10 pixels | "ENDF" | crc16)
+FRAMEX_START_MARKER = b'FRMX'
+FRAMEX_HEADER_SIZE = 12
+FRAME_FLAG_SETTLING = 0x01
+ADC_FULL_SCALE_BITS = 12
+
+# Pre-trigger packet ("PTRG" | seq | roi_start | pixel_count | flags | packed12 | crc16)
+PRETRIG_MARKER = b'PTRG'
+PRETRIG_HEADER_SIZE = 12
+PRETRIG_FLAG_POST = 0x0001
+PRETRIG_FLAG_TRIGGER = 0x0002
+PRETRIG_FLAG_SETTLING = 0x0004
+PRETRIG_FLAG_BITS_SHIFT = 8
+PRETRIG_FLAG_BITS_MASK = 0x0F00
+
+# Band packet ("BAND" | seq | band_count u8 | reserved u8 | {sum u32, centroid u32} | crc16)
+BAND_MARKER = b'BAND'
+BAND_HEADER_SIZE = 8
+BAND_ENTRY_SIZE = 8
+BAND_CENTROID_NONE = 0xFFFFFFFF
+
+# Trace packet ("TRCE" | seq | flags u8 | cycles_per_us u8 | tick_ms u32 |
+# icg u32 | dma u32 | ready u32 | submit u32 | crc16)
+TRACE_MARKER = b'TRCE'
+TRACE_PACKET_SIZE = 30
+TRACE_FLAG_SENT = 0x01
+
+# Marker packet ("MARK" | id u32 | seq | tick_ms u32 | crc16), sent before
+# the data of readout seq
+MARK_MARKER = b'MARK'
+MARK_PACKET_SIZE = 16
+
+
+def find_stm32_port():
+    """Find the STM32 USB CDC port"""
+    for port in serial.tools.list_ports.comports():
+        if any(keyword in port.description.lower()
+               for keyword in ['stm32', 'stmicroelectronics', 'usb serial']):
+            return port.device
+    return None
+
+
+def crc16(data):
+    """CRC16-CCITT (init 0xFFFF), as computed by the firmware"""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def packed12_size(count):
+    """Bytes used by count 12-bit pixels (odd counts padded)"""
+    return (count + 1) // 2 * 3
+
+
+def unpack12(data, count):
+    """
+    Unpack 12-bit pixels (two per three bytes) into a list of ints.
+    byte0 = p0[7:0], byte1 = p0[11:8] | p1[3:0] << 4, byte2 = p1[11:4]
+    """
+    pixels = []
+    for i in range(0, packed12_size(count), 3):
+        b0, b1, b2 = data[i], data[i + 1], data[i + 2]
+        pixels.append(b0 | (b1 & 0x0F) << 8)
+        pixels.append(b1 >> 4 | b2 << 4)
+    return pixels[:count]
+
+
+def packed10_size(count):
+    """Bytes used by count 10-bit pixels (padded to a multiple of 4)"""
+    return (count + 3) // 4 * 5
+
+
+def unpack10(data, count):
+    """
+    Unpack 10-bit pixels (four per five bytes, LSB-first bit stream)
+    into a list of ints.
+    """
+    pixels = []
+    for i in range(0, packed10_size(count), 5):
+        group = int.from_bytes(data[i:i + 5], 'little')
+        for k in range(4):
+            pixels.append((group >> (10 * k)) & 0x3FF)
+    return pixels[:count]
+
+
+def scale_to_12bit(pixels, bits):
+    """Scale ADC counts of a bits-wide conversion to the 12-bit range"""
+    shift = ADC_FULL_SCALE_BITS - bits
+    if shift <= 0:
+        return tuple(pixels)
+    return tuple(p << shift for p in pixels)
+
+
+def frame_size(data, offset=0):
+    """
+    Total size of the FRME or FRMX frame starting at data[offset], from its
+    header. Returns None if the header is incomplete or not a frame.
+    """
+    marker = bytes(data[offset:offset + 4])
+    if marker == FRAME_START_MARKER:
+        return FRAME_TOTAL_SIZE
+    if marker == FRAMEX_START_MARKER:
+        if len(data) - offset < FRAMEX_HEADER_SIZE:
+            return None
+        payload_size, = struct.unpack_from('<H', data, offset + 10)
+        return FRAMEX_HEADER_SIZE + payload_size + FRAME_FOOTER_SIZE
+    return None
+
+
+def find_frame_start(data, start=0):
+    """Index of the first FRME or FRMX marker at or after start, or -1"""
+    hits = [i for i in (data.find(FRAME_START_MARKER, start),
+                        data.find(FRAMEX_START_MARKER, start)) if i >= 0]
+    return min(hits) if hits else -1
+
+
+def parse_frame_info(frame_bytes):
+    """
+    Parse an FRME or FRMX frame.
+    Returns a dict (seq, bits, raw pixels in ADC counts, pixels scaled to
+    12 bits, settling, crc_ok) or None if malformed. settling is only ever
+    set on FRMX frames (SETTLE FLAG mode).
+    """
+    size = frame_size(frame_bytes)
+    if size is None or len(frame_bytes) != size:
+        return None
+    if frame_bytes[size - 6:size - 2] != FRAME_END_MARKER:
+        return None
+
+    frame_counter, pixel_count = struct.unpack_from('<HH', frame_bytes, 4)
+    checksum, = struct.unpack_from('<H', frame_bytes, size - 2)
+
+    settling = False
+    if frame_bytes[:4] == FRAME_START_MARKER:
+        bits = ADC_FULL_SCALE_BITS
+        raw = struct.unpack_from(f'<{CCD_PIXEL_COUNT}H', frame_bytes, FRAME_HEADER_SIZE)
+    else:
+        bits = frame_bytes[8]
+        settling = bool(frame_bytes[9] & FRAME_FLAG_SETTLING)
+        payload = frame_bytes[FRAMEX_HEADER_SIZE:size - FRAME_FOOTER_SIZE]
+        if bits == 8 and len(payload) == pixel_count:
+            raw = tuple(payload)
+        elif bits == 10 and len(payload) == packed10_size(pixel_count):
+            raw = tuple(unpack10(payload, pixel_count))
+        else:
+            return None
+
+    return {
+        'seq': frame_counter,
+        'bits': bits,
+        'raw': raw,
+        'pixels': scale_to_12bit(raw, bits),
+        'settling': settling,
+        'crc_ok': crc16(frame_bytes[:-2]) == checksum,
+    }
+
+
+def parse_frame(frame_bytes):
+    """
+    Parse an FRME frame, or an FRMX frame with pixels scaled to 12 bits.
+    Returns (frame_counter, pixels tuple, crc_ok) or None if malformed.
+    """
+    info = parse_frame_info(frame_bytes)
+    if info is None:
+        return None
+    return info['seq'], info['pixels'], info['crc_ok']
+
+
+def pretrig_packet_size(pixel_count):
+    return PRETRIG_HEADER_SIZE + packed12_size(pixel_count) + 2
+
+
+def parse_pretrig_packet(data, offset=0):
+    """
+    Parse one PTRG packet starting at data[offset].
+    Returns (packet dict, bytes consumed), or (None, 0) if more data is needed.
+    """
+    if len(data) - offset < PRETRIG_HEADER_SIZE:
+        return None, 0
+    if data[offset:offset + 4] != PRETRIG_MARKER:
+        raise ValueError('PTRG marker expected')
+
+    seq, roi_start, pixel_count, flags = struct.unpack_from('<HHHH', data, offset + 4)
+    size = pretrig_packet_size(pixel_count)
+    if len(data) - offset < size:
+        return None, 0
+
+    packet = bytes(data[offset:offset + size])
+    checksum, = struct.unpack_from('<H', packet, size - 2)
+    bits = (flags & PRETRIG_FLAG_BITS_MASK) >> PRETRIG_FLAG_BITS_SHIFT or ADC_FULL_SCALE_BITS
+    return {
+        'seq': seq,
+        'roi_start': roi_start,
+        'pixel_count': pixel_count,
+        'flags': flags,
+        'bits': bits,
+        'pixels': list(scale_to_12bit(unpack12(packet[PRETRIG_HEADER_SIZE:], pixel_count), bits)),
+        'crc_ok': crc16(packet[:-2]) == checksum,
+    }, size
+
+
+def band_packet_size(band_count):
+    return BAND_HEADER_SIZE + band_count * BAND_ENTRY_SIZE + 2
+
+
+def parse_band_packet(data, offset=0):
+    """
+    Parse one BAND packet starting at data[offset].
+    Returns (packet dict, bytes consumed), or (None, 0) if more data is needed.
+    Sums are light (full_scale - ADC count, summed by the firmware), scaled
+    to 12 bits for reduced-resolution readouts; centroids are the
+    light-weighted position in pixels (None for a band with no light).
+    """
+    if len(data) - offset < BAND_HEADER_SIZE:
+        return None, 0
+    if data[offset:offset + 4] != BAND_MARKER:
+        raise ValueError('BAND marker expected')
+
+    seq, band_count, bits = struct.unpack_from('<HBB', data, offset + 4)
+    size = band_packet_size(band_count)
+    if len(data) - offset < size:
+        return None, 0
+
+    packet = bytes(data[offset:offset + size])
+    checksum, = struct.unpack_from('<H', packet, size - 2)
+    sums, centroids = [], []
+    for i in range(band_count):
+        total, centroid = struct.unpack_from('<II', packet, BAND_HEADER_SIZE + i * BAND_ENTRY_SIZE)
+        sums.append(total << (ADC_FULL_SCALE_BITS - bits) if bits else total)
+        centroids.append(None if centroid == BAND_CENTROID_NONE else centroid / 256.0)
+    return {
+        'seq': seq,
+        'bits': bits or ADC_FULL_SCALE_BITS,
+        'sums': sums,
+        'centroids': centroids,
+        'crc_ok': crc16(packet[:-2]) == checksum,
+    }, size
+
+
+def parse_trace_packet(data, offset=0):
+    """
+    Parse one TRCE packet starting at data[offset].
+    Returns (packet dict, bytes consumed), or (None, 0) if more data is needed.
+    Stamps are DWT cycle counts, unwrapped with the packet's HAL tick so they
+    increase across the 32-bit wrap; 'us' holds them converted to
+    microseconds since device start (submit is None if the frame was not sent).
+    """
+    if len(data) - offset < TRACE_PACKET_SIZE:
+        return None, 0
+    if data[offset:offset + 4] != TRACE_MARKER:
+        raise ValueError('TRCE marker expected')
+
+    packet = bytes(data[offset:offset + TRACE_PACKET_SIZE])
+    seq, flags, cycles_per_us, tick, icg, dma, ready, submit, checksum = \
+        struct.unpack_from('<HBBIIIIIH', packet, 4)
+    cycles_per_us = cycles_per_us or 84
+    tick_cycles = tick * 1000 * cycles_per_us
+
+    def unwrap(stamp):
+        return stamp + round((tick_cycles - stamp) / 2 ** 32) * 2 ** 32
+
+    sent = bool(flags & TRACE_FLAG_SENT)
+    stamps = {'icg': unwrap(icg), 'dma': unwrap(dma), 'ready': unwrap(ready),
+              'submit': unwrap(submit) if sent else None}
+    return {
+        'seq': seq,
+        'sent': sent,
+        'tick_ms': tick,
+        'cycles': stamps,
+        'us': {k: (v / cycles_per_us if v is not None else None) for k, v in stamps.items()},
+        'crc_ok': crc16(packet[:-2]) == checksum,
+    }, TRACE_PACKET_SIZE
+
+
+def parse_mark_packet(data, offset=0):
+    """
+    Parse one MARK packet starting at data[offset].
+    Returns (packet dict, bytes consumed), or (None, 0) if more data is needed.
+    'seq' is the first readout recorded after the mark.
+    """
+    if len(data) - offset < MARK_PACKET_SIZE:
+        return None, 0
+    if data[offset:offset + 4] != MARK_MARKER:
+        raise ValueError('MARK marker expected')
+
+    packet = bytes(data[offset:offset + MARK_PACKET_SIZE])
+    mark_id, seq, tick, checksum = struct.unpack_from('<IHIH', packet, 4)
+    return {
+        'id': mark_id,
+        'seq': seq,
+        'tick_ms': tick,
+        'crc_ok': crc16(packet[:-2]) == checksum,
+    }, MARK_PACKET_SIZE
@@ -13,6 +13,8 @@ from matplotlib.animation import FuncAnimation
 from collections import deque
 import sys
 
+from tcd1304_protocol import find_frame_start, frame_size, parse_frame_info
+
 # Frame structure constants
 CCD_PIXEL_COUNT = 3694
 FRAME_START_MARKER = b'FRME'
@@ -100,27 +102,12 @@ class CCDRealtimePlotter:
         plt.tight_layout()
         
     def parse_frame(self, frame_bytes):
-        """Parse a complete frame"""
-        if len(frame_bytes) != FRAME_TOTAL_SIZE:
-            return None
-            
-        # Check markers
-        if frame_bytes[0:4] != FRAME_START_MARKER:
-            return None
-        if frame_bytes[FRAME_TOTAL_SIZE-6:FRAME_TOTAL_SIZE-2] != FRAME_END_MARKER:
+        """Parse a complete FRME or FRMX frame (pixels scaled to 12 bits)"""
+        info = parse_frame_info(bytes(frame_bytes))
+        if info is None or len(info['pixels']) != CCD_PIXEL_COUNT:
             return None
         
-        # Parse header
-        frame_counter, pixel_count = struct.unpack('<HH', frame_bytes[4:8])
-        
-        if pixel_count != CCD_PIXEL_COUNT:
-            return None
-        
-        # Parse pixel data
-        pixel_data_bytes = frame_bytes[8:8+FRAME_PIXEL_SIZE]
-        pixel_data = np.array(struct.unpack(f'<{CCD_PIXEL_COUNT}H', pixel_data_bytes))
-        
-        return pixel_data
+        return np.array(info['pixels'])
     
     def read_frame(self):
         """Read and parse a frame from serial"""
@@ -130,12 +117,13 @@ class CCDRealtimePlotter:
             self.buffer += data
         
         # Look for frame
-        while FRAME_START_MARKER in self.buffer:
-            start_idx = self.buffer.find(FRAME_START_MARKER)
+        while find_frame_start(self.buffer) >= 0:
+            start_idx = find_frame_start(self.buffer)
+            size = frame_size(self.buffer, start_idx)
             
-            # Check if we have enough data
-            if len(self.buffer) >= start_idx + FRAME_TOTAL_SIZE:
-                frame_bytes = self.buffer[start_idx:start_idx + FRAME_TOTAL_SIZE]
+            # Check if we have enough data (FRMX: size comes from the header)
+            if size is not None and len(self.buffer) >= start_idx + size:
+                frame_bytes = self.buffer[start_idx:start_idx + size]
                 
                 # Parse frame
                 pixel_data = self.parse_frame(frame_bytes)
@@ -157,7 +145,7 @@ class CCDRealtimePlotter:
                     self.stats_avg.append(np.mean(pixel_data))
                     
                     # Remove processed frame
-                    self.buffer = self.buffer[start_idx + FRAME_TOTAL_SIZE:]
+                    self.buffer = self.buffer[start_idx + size:]
                     return True
                 else:
                     self.dropped_frames += 1
@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+"""
+TCD1304 Host SDK (Python)
+ctypes binding for the C++ Tcd1304Device in host/ (include/tcd1304_device.h,
+src/tcd1304_device.cpp). The library is built with the system C++ compiler
+on first use (cached in host/, rebuilt when a source changes).
+
+The reader thread, frame parsing and the frame pool live in C++. A Frame
+returned by next_frame() holds one pool slot; .pixels and .raw are views of
+the pool memory (buffer protocol, no copy). The slot goes back to the pool
+once the Frame is released (close(), a with-block or dropping it) and no
+view or array made from one (np.frombuffer) is left, so an array never sees
+its memory reused. Device.close() refuses while frames are in use.
+
+    with Device() as dev:                    # first matching port
+        dev.set_integration_time(20)
+        dev.start()
+        with dev.next_frame(timeout_ms=500) as frame:
+            pixels = np.frombuffer(frame.pixels, dtype=np.uint16)
+        dev.stop()
+        print(dev.stats())
+
+Usage:
+    python tcd1304_sdk.py [port] --seconds 10 [--pool 16]
+"""
+
+import argparse
+import ctypes
+import os
+import shutil
+import subprocess
+import sys
+import time
+
+HOST_DIR = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), 'host')
+SOURCES = [os.path.join(HOST_DIR, 'src', 'tcd1304_device.cpp'),
+           os.path.join(HOST_DIR, 'include', 'tcd1304_device.h')]
+LIBRARY = os.path.join(HOST_DIR, 'libtcd1304_device.so')
+
+STAT_NAMES = ('bytes', 'reads', 'frames', 'pool_drops', 'queue_drops', 'seq_gaps',
+              'crc_errors', 'packets_skipped')
+
+FRAME_FLAG_SETTLING = 0x01
+
+
+class FrameInfo(ctypes.Structure):
+    _fields_ = [('slot', ctypes.c_uint32),
+                ('seq', ctypes.c_uint16),
+                ('bits', ctypes.c_uint8),
+                ('flags', ctypes.c_uint8),
+                ('crc_ok', ctypes.c_uint8),
+                ('host_time_ns', ctypes.c_uint64),
+                ('size', ctypes.c_uint32),
+                ('raw', ctypes.c_void_p),
+                ('pixels', ctypes.c_void_p),
+                ('pixel_count', ctypes.c_uint32)]
+
+
+_lib = None
+
+
+def _load():
+    """Build (if stale) and load the SDK library"""
+    global _lib
+    if _lib is not None:
+        return _lib
+
+    stale = (not os.path.exists(LIBRARY) or
+             any(os.path.getmtime(LIBRARY) < os.path.getmtime(src) for src in SOURCES))
+    if stale:
+        compiler = shutil.which(os.environ.get('CXX', 'c++')) or shutil.which('g++')
+        if compiler is None:
+            raise OSError('no C++ compiler to build the SDK library')
+        result = subprocess.run([compiler, '-std=c++17', '-O2', '-shared', '-fPIC', '-pthread',
+                                 '-I', os.path.join(HOST_DIR, 'include'),
+                                 '-o', LIBRARY, SOURCES[0]], capture_output=True, text=True)
+        if result.returncode != 0:
+            raise OSError(f'SDK build failed:\n{result.stderr}')
+    lib = ctypes.CDLL(LIBRARY)
+
+    lib.tcd_open.argtypes = [ctypes.c_char_p, ctypes.c_uint32]
+    lib.tcd_open.restype = ctypes.c_void_p
+    lib.tcd_is_open.argtypes = [ctypes.c_void_p]
+    lib.tcd_close.argtypes = [ctypes.c_void_p]
+    lib.tcd_close.restype = None
+    lib.tcd_last_error.argtypes = [ctypes.c_void_p]
+    lib.tcd_last_error.restype = ctypes.c_char_p
+    lib.tcd_find_ports.argtypes = [ctypes.c_char_p, ctypes.c_uint32]
+    lib.tcd_command.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p,
+                                ctypes.c_char_p, ctypes.c_uint32]
+    lib.tcd_next_frame.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.POINTER(FrameInfo)]
+    lib.tcd_release.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+    lib.tcd_release.restype = None
+    lib.tcd_get_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint64),
+                                  ctypes.c_uint32]
+    lib.tcd_get_stats.restype = None
+    _lib = lib
+    return lib
+
+
+def find_ports():
+    """Ports that look like the board"""
+    buffer = ctypes.create_string_buffer(4096)
+    _load().tcd_find_ports(buffer, len(buffer))
+    return [p for p in buffer.value.decode().split('\n') if p]
+
+
+class _Slot:
+    """A pool slot, returned to the pool when the last reference is gone"""
+
+    def __init__(self, device, slot):
+        self._device = device
+        self._slot = slot
+        device._outstanding += 1
+
+    def __del__(self):
+        self._device._release(self._slot)
+
+
+def _view(ctype, count, address, owner):
+    """Zero-copy view of pool memory that keeps the slot while it is in use"""
+    array = (ctype * count).from_address(address)
+    array._owner = owner            # Exports (memoryview, numpy) reference the array
+    return memoryview(array)
+
+
+class Frame:
+    """One pool frame; .pixels / .raw are zero-copy views of the pool slot"""
+
+    def __init__(self, device, info):
+        self._owner = _Slot(device, info.slot)
+        self.seq = info.seq
+        self.bits = info.bits
+        self.flags = info.flags
+        self.crc_ok = bool(info.crc_ok)
+        self.host_time_ns = info.host_time_ns
+        self.settling = bool(info.flags & FRAME_FLAG_SETTLING)
+        # Pixels are scaled to 12 bits whatever the wire format was
+        self.pixels = _view(ctypes.c_uint16, info.pixel_count, info.pixels, self._owner)
+        self.raw = _view(ctypes.c_uint8, info.size, info.raw, self._owner)
+
+    def release(self):
+        """Drop this frame's hold on the slot; arrays made from its views keep theirs"""
+        self.pixels = self.raw = None
+        self._owner = None
+
+    close = release
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.release()
+
+
+class Device:
+    """Tcd1304Device from Python: commands, frame queue and counters"""
+
+    def __init__(self, port=None, pool_frames=16):
+        self._lib = _load()
+        handle = self._lib.tcd_open(port.encode() if port else None, pool_frames)
+        if not self._lib.tcd_is_open(handle):
+            error = self._lib.tcd_last_error(handle).decode()
+            self._lib.tcd_close(handle)
+            raise OSError(error)
+        self._handle = handle
+        self._info = FrameInfo()
+        self._outstanding = 0       # Slots held by frames and their views
+
+    def close(self):
+        """Close the port and free the pool; refused while frames are in use"""
+        if self._handle and self._outstanding > 0:
+            raise RuntimeError(f'{self._outstanding} frame(s) still in use: release them '
+                               f'and drop arrays made from their views before close()')
+        if self._handle:
+            self._lib.tcd_close(self._handle)
+            self._handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def command(self, text, expect):
+        """Send a command, return (ok, reply line)"""
+        reply = ctypes.create_string_buffer(512)
+        ok = self._lib.tcd_command(self._handle, text.encode('ascii'), expect.encode('ascii'),
+                                   reply, len(reply))
+        return ok == 1, reply.value.decode('ascii', errors='replace')
+
+    def _ok(self, text, expect):
+        ok, reply = self.command(text, expect)
+        if not ok:
+            raise RuntimeError(f'{text}: {reply or "no reply"}')
+        return reply
+
+    # Typed commands
+    def start(self):
+        self._ok('START', 'OK:STARTED')
+
+    def stop(self):
+        self._ok('STOP', 'OK:STOPPED')
+
+    def status(self):
+        return _key_values(self._ok('STATUS', 'STATUS:'))
+
+    def device_stats(self):
+        return _key_values(self._ok('STATS', 'STATS:'))
+
+    def set_integration_time(self, microseconds):
+        self._ok(f'SET_INT_TIME:{int(microseconds)}', 'OK:INT_TIME_SET')
+
+    def set_adc_bits(self, bits):
+        self._ok(f'ADC_BITS:{int(bits)}', 'OK:ADC_BITS:')
+
+    def set_clock(self, profile):
+        self._ok(f'CLOCK:{profile}', 'OK:CLOCK:')
+
+    def set_settle(self, frames, flag=False):
+        self._ok(f'SETTLE:{int(frames)},{"FLAG" if flag else "DROP"}', 'OK:SETTLE:')
+
+    def set_adapt(self, on):
+        self._ok('ADAPT:ON' if on else 'ADAPT:OFF', 'OK:ADAPT:')
+
+    def mark(self, mark_id):
+        self._ok(f'MARK:{int(mark_id)}', 'OK:MARK:')
+
+    def next_frame(self, timeout_ms=1000):
+        """Next queued frame or None"""
+        if not self._lib.tcd_next_frame(self._handle, timeout_ms, ctypes.byref(self._info)):
+            return None
+        return Frame(self, self._info)
+
+    def _release(self, slot):
+        self._outstanding -= 1
+        if self._handle:
+            self._lib.tcd_release(self._handle, slot)
+
+    def stats(self):
+        """Host-side stream counters"""
+        values = (ctypes.c_uint64 * len(STAT_NAMES))()
+        self._lib.tcd_get_stats(self._handle, values, len(STAT_NAMES))
+        return dict(zip(STAT_NAMES, values))
+
+
+def _key_values(line):
+    body = line.split(':', 1)[1] if ':' in line else line
+    return dict(item.split(':', 1) for item in body.split(',') if ':' in item)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Stream through the C++ host SDK')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--seconds', type=float, default=10.0, help='Streaming time')
+    parser.add_argument('--pool', type=int, default=16, help='Frames in the pool')
+    args = parser.parse_args()
+
+    try:
+        dev = Device(args.port, args.pool)
+    except OSError as error:
+        print(f"❌ {error}")
+        sys.exit(1)
+
+    with dev:
+        dev.start()
+        count = total = 0
+        start = time.time()
+        while time.time() - start < args.seconds:
+            frame = dev.next_frame(500)
+            if frame is None:
+                continue
+            with frame:
+                count += 1
+                total += sum(frame.pixels[::64])     # Touch the pixels without copying them
+        dev.stop()
+        stats = dev.stats()
+
+    elapsed = time.time() - start
+    print(f"📊 {count} frames in {elapsed:.1f} s ({count / elapsed:.1f} fps)")
+    print("   " + ', '.join(f"{name} {stats[name]}" for name in STAT_NAMES))
+
+
+if __name__ == "__main__":
+    main()
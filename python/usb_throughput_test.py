@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+USB Bulk IN Throughput Test
+Runs the firmware's device-side throughput test (USB_TPUT) for each OTG FIFO
+profile and several transfer sizes, verifies the streamed pattern, and prints
+a table so the fastest FIFO/endpoint configuration can be picked.
+
+Usage:
+    python usb_throughput_test.py [port] [--profiles 0,1,2] [--bytes 1048576]
+"""
+
+import argparse
+import sys
+import time
+
+import serial
+import serial.tools.list_ports
+
+PROFILE_NAMES = {0: 'DEFAULT', 1: 'BULK_IN', 2: 'BALANCED'}
+CHUNK_SIZES = [64, 512, 2048]
+REENUMERATE_WAIT_S = 2.0
+
+
+def find_stm32_port():
+    """Find the STM32 USB CDC port"""
+    for port in serial.tools.list_ports.comports():
+        if any(keyword in port.description.lower()
+               for keyword in ['stm32', 'stmicroelectronics', 'usb serial']):
+            return port.device
+    return None
+
+
+def open_port(port_name):
+    ser = serial.Serial(port_name, 115200, timeout=2)
+    time.sleep(0.3)
+    ser.reset_input_buffer()
+    return ser
+
+
+def send_command(ser, command):
+    """Send a command and return the first response line"""
+    ser.write(command.encode('ascii') + b'\n')
+    return ser.readline().decode('ascii', errors='ignore').strip()
+
+
+def parse_kv(line):
+    """'USB_TPUT:PROFILE:1,BYTES:...' -> {'PROFILE': 1, 'BYTES': ...}"""
+    body = line.split(':', 1)[1]
+    result = {}
+    for field in body.split(','):
+        key, value = field.split(':', 1)
+        result[key] = int(value)
+    return result
+
+
+def run_throughput(ser, total_bytes, chunk):
+    """Run one USB_TPUT test; returns (device_result, host_bps, errors)"""
+    ser.reset_input_buffer()
+    response = send_command(ser, f'USB_TPUT:{total_bytes},{chunk}')
+    if not response.startswith('OK:USB_TPUT'):
+        raise RuntimeError(f'USB_TPUT rejected: {response}')
+
+    data = bytearray()
+    start = time.perf_counter()
+    while len(data) < total_bytes:
+        block = ser.read(min(65536, total_bytes - len(data)))
+        if not block:
+            raise RuntimeError(f'Timeout after {len(data)} of {total_bytes} bytes')
+        data.extend(block)
+    host_elapsed = time.perf_counter() - start
+
+    # Stream byte n carries (n & 0xFF)
+    errors = sum(1 for i, b in enumerate(data) if b != (i & 0xFF))
+
+    result_line = ser.readline().decode('ascii', errors='ignore').strip()
+    if not result_line.startswith('USB_TPUT:'):
+        raise RuntimeError(f'Missing result line, got: {result_line!r}')
+
+    return parse_kv(result_line), total_bytes / host_elapsed, errors
+
+
+def select_profile(ser, port_name, profile):
+    """Switch FIFO profile; the device re-enumerates so the port is reopened"""
+    response = send_command(ser, f'USB_PROFILE:{profile}')
+    if not response.startswith('OK:USB_PROFILE'):
+        raise RuntimeError(f'USB_PROFILE rejected: {response}')
+    ser.close()
+    time.sleep(REENUMERATE_WAIT_S)
+    return open_port(find_stm32_port() or port_name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TCD1304 USB bulk IN throughput test')
+    parser.add_argument('port', nargs='?', help='Serial port (auto-detect if omitted)')
+    parser.add_argument('--profiles', default='0,1,2', help='FIFO profiles to test')
+    parser.add_argument('--bytes', type=int, default=1 << 20, help='Bytes per test')
+    args = parser.parse_args()
+
+    port_name = args.port or find_stm32_port()
+    if not port_name:
+        print("❌ No STM32 device found")
+        sys.exit(1)
+
+    print("=" * 78)
+    print("TCD1304 USB BULK IN THROUGHPUT TEST")
+    print("=" * 78)
+
+    ser = open_port(port_name)
+    send_command(ser, 'STOP')
+
+    rows = []
+    for profile in [int(p) for p in args.profiles.split(',')]:
+        print(f"\n🔧 Selecting FIFO profile {profile} ({PROFILE_NAMES.get(profile, '?')})...")
+        ser = select_profile(ser, port_name, profile)
+        send_command(ser, 'STOP')
+
+        for chunk in CHUNK_SIZES:
+            dev, host_bps, errors = run_throughput(ser, args.bytes, chunk)
+            rows.append((profile, chunk, dev, host_bps, errors))
+            status = "✅" if errors == 0 else f"❌ {errors} bad bytes"
+            print(f"  chunk {chunk:5d}: device {dev['BPS'] / 1e3:8.1f} kB/s, "
+                  f"host {host_bps / 1e3:8.1f} kB/s, "
+                  f"gap avg/max {dev['GAP_AVG_US']}/{dev['GAP_MAX_US']} us  {status}")
+
+    ser.close()
+
+    print("\n" + "=" * 78)
+    print(f"{'profile':<10}{'chunk':>7}{'dev kB/s':>11}{'host kB/s':>11}"
+          f"{'xfer us':>13}{'gap us':>15}{'errors':>8}")
+    print("-" * 78)
+    for profile, chunk, dev, host_bps, errors in rows:
+        print(f"{PROFILE_NAMES.get(profile, str(profile)):<10}{chunk:>7}"
+              f"{dev['BPS'] / 1e3:>11.1f}{host_bps / 1e3:>11.1f}"
+              f"{dev['XFER_MIN_US']:>6}-{dev['XFER_MAX_US']:<6}"
+              f"{dev['GAP_AVG_US']:>7}/{dev['GAP_MAX_US']:<7}{errors:>8}")
+
+    best = max((r for r in rows if r[4] == 0), key=lambda r: r[2]['BPS'], default=None)
+    if best:
+        print(f"\n🏆 Fastest: profile {best[0]} ({PROFILE_NAMES.get(best[0], '?')}), "
+              f"chunk {best[1]} -> {best[2]['BPS'] / 1e3:.1f} kB/s")
+
+
+if __name__ == "__main__":
+    main()